@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.cpp
+    Created: 26 Oct 2026 10:04:12am
+    Author:  Louis Deng
+
+    global operator new replaced by one that counts, for the allocs/frame figures
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <new>
+#include "BenchmarkUtil.h"
+
+static std::atomic<juce::int64> allocationCount { 0 };
+
+juce::int64 getAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new (std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete (void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[] (void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
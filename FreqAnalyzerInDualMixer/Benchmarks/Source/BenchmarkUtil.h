@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    BenchmarkUtil.h
+    Created: 25 Oct 2026 2:11:30pm
+    Author:  Louis Deng
+
+    timing helpers shared by the benchmarks
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/// ms per call of function: the median of rounds, each averaging iterations calls after one warm-up call
+template <typename Function>
+double measureMs(int iterations, Function&& function, int rounds = 5)
+{
+    function();
+    std::vector<double> perCall;
+    for (int round = 0; round < rounds; round++)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int i = 0; i < iterations; i++)
+            function();
+        perCall.push_back(1000.0*juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()-start)/iterations);
+    }
+    std::sort(perCall.begin(), perCall.end());
+    return perCall[perCall.size()/2];
+}
+
+/// keeps the optimiser from dropping a result nobody reads
+template <typename T>
+void keepResult(const T& value)
+{
+    static volatile T sink;
+    sink = value;
+}
+
+/// operator new calls so far in this process, from AllocationCounter.cpp
+juce::int64 getAllocationCount();
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    FFTBenchmark.cpp
+    Created: 25 Oct 2026 2:20:14pm
+    Author:  Louis Deng
+
+    BatchFFT against the four juce::dsp::FFT calls it replaces, orders 10 to 15
+
+    both transform the same four noise frames into magnitude spectra, and are
+    checked to agree before they are timed. the copy of the input each call
+    needs (both transform in place) is in both timings
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchFFT.h"
+#include "BenchmarkUtil.h"
+
+class FFTBenchmark : public juce::UnitTest
+{
+public:
+    FFTBenchmark(): juce::UnitTest("BatchFFT vs juce::dsp::FFT", "FreqAnalyzerBenchmarks")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("four frames per call, magnitude spectra");
+        logMessage("BatchFFT lanes: " + juce::String(BatchFFT::LANES));
+        auto random = getRandom();
+
+        for (int order = 10; order <= 15; order++)
+        {
+            const int size = 1 << order;
+            std::vector<std::vector<float>> input(NUMFRAMES, std::vector<float>((size_t)size));
+            for (auto& frame : input)
+                for (auto& sample : frame)
+                    sample = random.nextFloat()*2.0f-1.0f;
+
+            BatchFFT batchFFT((uint32_t)order);
+            std::vector<std::vector<float>> batchFrames(NUMFRAMES, std::vector<float>((size_t)size));
+            std::vector<float*> batchPtrs;
+            for (auto& frame : batchFrames)
+                batchPtrs.push_back(frame.data());
+            auto runBatch = [&]
+            {
+                for (int l = 0; l < NUMFRAMES; l++)
+                    std::copy(input[(size_t)l].begin(), input[(size_t)l].end(), batchFrames[(size_t)l].begin());
+                batchFFT.performFrequencyOnlyForwardTransform(batchPtrs.data(), NUMFRAMES);
+                keepResult(batchFrames[0][1]);
+            };
+
+            juce::dsp::FFT fft(order);
+            std::vector<std::vector<float>> juceFrames(NUMFRAMES, std::vector<float>((size_t)size*2));
+            auto runJuce = [&]
+            {
+                for (int l = 0; l < NUMFRAMES; l++)
+                {
+                    auto& frame = juceFrames[(size_t)l];
+                    std::copy(input[(size_t)l].begin(), input[(size_t)l].end(), frame.begin());
+                    std::fill(frame.begin()+size, frame.end(), 0.0f);
+                    fft.performFrequencyOnlyForwardTransform(frame.data());
+                }
+                keepResult(juceFrames[0][1]);
+            };
+
+            // same spectra, to single precision rounding over log2(size) stages
+            runBatch();
+            runJuce();
+            float worst = 0.0f;
+            for (int l = 0; l < NUMFRAMES; l++)
+                for (int i = 0; i <= size/2; i++)
+                    worst = juce::jmax(worst, std::abs(batchFrames[(size_t)l][(size_t)i]-juceFrames[(size_t)l][(size_t)i]));
+            expectLessThan(worst, 1.0e-5f*(float)size, "BatchFFT disagrees with juce::dsp::FFT");
+
+            const int iterations = juce::jmax(8, (1 << 21) >> order);
+            const double batchMs = measureMs(iterations, runBatch);
+            const double juceMs = measureMs(iterations, runJuce);
+            logMessage("order " + juce::String(order) + ": BatchFFT " + juce::String(batchMs*1000.0, 1)
+                       + " us, 4x juce FFT " + juce::String(juceMs*1000.0, 1) + " us, "
+                       + juce::String(juceMs/batchMs, 2) + "x");
+        }
+    }
+
+private:
+    static constexpr int NUMFRAMES = 4;   // dry/wet x L/R, one hop
+};
+
+static FFTBenchmark fftBenchmark;
@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 25 Oct 2026 2:05:51pm
+    Author:  Louis Deng
+
+    runs the FreqAnalyzer benchmarks, each a juce::UnitTest logging its timings,
+    build Release: Debug timings say nothing. exit code 1 if a sanity check failed
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+int main (int argc, char* argv[])
+{
+    juce::ignoreUnused(argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("FreqAnalyzerBenchmarks");
+    
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); i++)
+        failures += runner.getResult(i)->failures;
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    PrecisionBenchmark.cpp
+    Created: 25 Oct 2026 4:48:37pm
+    Author:  Louis Deng
+
+    DWmixer<float> against DWmixer<double>: a stereo 512 sample block through
+    both channels' mixers and the loudness meters, with the analyzer detached
+    and attached (the double mixer narrows what the analyzer sees to float)
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DWmixer.h"
+#include "BenchmarkUtil.h"
+
+class PrecisionBenchmark : public juce::UnitTest
+{
+public:
+    PrecisionBenchmark(): juce::UnitTest("DWmixer float vs double", "FreqAnalyzerBenchmarks")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("stereo block through the mixers");
+        SpectrumFramePool pool;
+        AnalysisEngine engine { pool };
+
+        for (auto* analyzer : { (AnalysisEngine*)nullptr, &engine })
+        {
+            const double floatNs = measureNsPerSample<float>(analyzer);
+            const double doubleNs = measureNsPerSample<double>(analyzer);
+            logMessage(juce::String(analyzer == nullptr ? "analyzer detached" : "analyzer attached")
+                       + ": float " + juce::String(floatNs, 2) + " ns/sample, double " + juce::String(doubleNs, 2)
+                       + " ns/sample, double/float " + juce::String(doubleNs/floatNs, 2) + "x");
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int BLOCKSIZE = 512;
+    static constexpr int NUMBLOCKS = 200;
+
+    /// per stereo sample, averaged over a stretch of blocks with mix changes
+    template <typename SampleType>
+    double measureNsPerSample(AnalysisEngine* analyzer)
+    {
+        std::unique_ptr<DWmixer<SampleType>> mixers[2];
+        for (int channel = 0; channel < 2; channel++)
+        {
+            mixers[channel].reset(new DWmixer<SampleType>());
+            mixers[channel]->setid((uint32_t)channel);
+            mixers[channel]->prepare(SAMPLERATE, (SampleType)0.5);
+        }
+        LoudnessMeter meters[2];
+        for (auto& meter : meters)
+            meter.prepare(SAMPLERATE, 2, BLOCKSIZE);
+
+        auto random = getRandom();
+        juce::AudioBuffer<SampleType> input(2, BLOCKSIZE), dry(2, BLOCKSIZE), wet(2, BLOCKSIZE);
+        for (int channel = 0; channel < 2; channel++)
+            for (int i = 0; i < BLOCKSIZE; i++)
+                input.getWritePointer(channel)[i] = (SampleType)(random.nextFloat()*2.0f-1.0f);
+
+        int block = 0;
+        auto runBlock = [&]
+        {
+            // a mix change every few blocks, so ramps are part of the timing
+            if (block++ % 8 == 0)
+                for (auto& mixer : mixers)
+                    mixer->setTargetProportion((SampleType)(block % 16 == 1 ? 0.25 : 0.75), (juce::int64)(block-1)*BLOCKSIZE);
+            for (int channel = 0; channel < 2; channel++)
+            {
+                dry.copyFrom(channel, 0, input, channel, 0, BLOCKSIZE);
+                wet.copyFrom(channel, 0, input, channel, 0, BLOCKSIZE);
+            }
+            // chunked on the analyzer's hops as processSamples does
+            for (int start = 0; start < BLOCKSIZE;)
+            {
+                int numChunk = BLOCKSIZE-start;
+                if (analyzer != nullptr)
+                    numChunk = juce::jmin(numChunk, analyzer->samplesToNextHop());
+                for (int channel = 0; channel < 2; channel++)
+                    mixers[channel]->processBuffer(dry.getReadPointer(channel, start), wet.getWritePointer(channel, start), numChunk, analyzer, meters);
+                for (auto& meter : meters)
+                    meter.advance();
+                if (analyzer != nullptr)
+                    analyzer->transformPending();
+                start += numChunk;
+            }
+            keepResult(wet.getReadPointer(0)[0]);
+        };
+
+        if (analyzer != nullptr)
+            analyzer->alignTo(0);
+        return measureMs(NUMBLOCKS, runBlock)*1.0e6/BLOCKSIZE;
+    }
+};
+
+static PrecisionBenchmark precisionBenchmark;
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    RenderBenchmark.cpp
+    Created: 26 Oct 2026 10:20:37am
+    Author:  Louis Deng
+
+    headless render of the analyzer display: the editor's 630x270, and 1920x600
+    and 3840x1200, each at scale 1 and 2, painted into an Image
+
+    every frame the engine analyses one more hop of a two-tone signal, the view
+    collects it the way its timer does, and is painted. only collecting and
+    painting are timed and have their allocations counted
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "FreqAnalyzer.h"
+#include "BenchmarkUtil.h"
+
+class RenderBenchmark : public juce::UnitTest
+{
+public:
+    RenderBenchmark(): juce::UnitTest("Analyzer display render", "FreqAnalyzerBenchmarks")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("collect and paint per frame");
+        SpectrumFramePool pool;
+        AnalysisEngine engine { pool };
+        engine.alignTo(0);
+
+        std::vector<float> left, right;
+        juce::int64 position = 0;
+        auto analyzeHop = [&]
+        {
+            const int hop = engine.samplesToNextHop();
+            left.resize((size_t)hop);
+            right.resize((size_t)hop);
+            for (int i = 0; i < hop; i++, position++)
+            {
+                left[(size_t)i] = (float)(0.5*std::sin(0.13*(double)position) + 0.01*std::sin(1.7*(double)position));
+                right[(size_t)i] = 0.5f*left[(size_t)i];
+            }
+            for (uint32_t drywet = 0; drywet < 2; drywet++)
+            {
+                engine.injectBlockToTo(left.data(), hop, 0, drywet);
+                engine.injectBlockToTo(right.data(), hop, 1, drywet);
+            }
+            engine.injectStereo(left.data(), right.data(), hop);
+            engine.transformPending();
+        };
+
+        for (const auto size : { juce::Point<int>(630, 270), juce::Point<int>(1920, 600), juce::Point<int>(3840, 1200) })
+        {
+            for (const int scale : { 1, 2 })
+            {
+                FreqAnalyzer view(engine);
+                view.setBounds(0, 0, size.x, size.y);
+                juce::Image image(juce::Image::ARGB, size.x*scale, size.y*scale, true);
+
+                double totalMs = 0.0;
+                juce::int64 totalAllocations = 0;
+                for (int frame = -WARMUPFRAMES; frame < NUMFRAMES; frame++)
+                {
+                    analyzeHop();
+                    const auto allocationsBefore = getAllocationCount();
+                    const auto start = juce::Time::getHighResolutionTicks();
+                    {
+                        // what the view's timer and the next repaint do
+                        view.collectFrames();
+                        juce::Graphics g(image);
+                        g.addTransform(juce::AffineTransform::scale((float)scale));
+                        view.paintEntireComponent(g, true);
+                    }
+                    if (frame >= 0)
+                    {
+                        totalMs += 1000.0*juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks()-start);
+                        totalAllocations += getAllocationCount()-allocationsBefore;
+                    }
+                }
+                logMessage(juce::String(size.x) + "x" + juce::String(size.y) + " @" + juce::String(scale) + "x: "
+                           + juce::String(totalMs/NUMFRAMES, 3) + " ms/frame, "
+                           + juce::String((double)totalAllocations/NUMFRAMES, 1) + " allocs/frame");
+            }
+        }
+        engine.clearHistory();
+    }
+
+private:
+    static constexpr int WARMUPFRAMES = 10;
+    static constexpr int NUMFRAMES = 100;
+};
+
+static RenderBenchmark renderBenchmark;
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    TraceBenchmark.cpp
+    Created: 26 Oct 2026 1:37:52pm
+    Author:  Louis Deng
+
+    TraceRasterizer against juce::Graphics for what the display draws: two
+    filled reference areas under four live traces (dry/wet x L/R), drawn as
+    line segments by Graphics, as spans composited in one pass by the
+    rasterizer, at the render benchmark's sizes and scales
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TraceRasterizer.h"
+#include "BenchmarkUtil.h"
+
+class TraceBenchmark : public juce::UnitTest
+{
+public:
+    TraceBenchmark(): juce::UnitTest("TraceRasterizer vs Graphics", "FreqAnalyzerBenchmarks")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("six traces per frame");
+        auto random = getRandom();
+        // display dB down from the top, a noisy falling spectrum per trace
+        for (int t = 0; t < NUMTRACES; t++)
+        {
+            levels[t].resize(NUMPOINTS);
+            for (int i = 0; i < NUMPOINTS; i++)
+                levels[t][(size_t)i] = 0.1f + 0.6f*(float)i/NUMPOINTS + 0.08f*random.nextFloat() + 0.05f*(float)t;
+        }
+
+        for (const auto size : { juce::Point<int>(630, 270), juce::Point<int>(1920, 600), juce::Point<int>(3840, 1200) })
+        {
+            for (const int scale : { 1, 2 })
+            {
+                const int width = size.x*scale;
+                const int height = size.y*scale;
+                juce::Image target(juce::Image::ARGB, width, height, true);
+                juce::Image traceImage(juce::Image::ARGB, width, height, true);
+                TraceRasterizer rasterizer;
+                TraceRasterizer::Trace traces[NUMTRACES];
+                juce::Path area;
+                area.preallocateSpace((NUMPOINTS+3)*3);
+
+                const double graphicsMs = measureMs(ITERATIONS, [&]
+                {
+                    juce::Graphics g(target);
+                    g.fillAll(juce::Colours::black);
+                    g.addTransform(juce::AffineTransform::scale((float)scale));
+                    for (int t = 0; t < NUMTRACES; t++)
+                    {
+                        const auto colour = getColour(t);
+                        if (t < NUMREFERENCES)
+                        {
+                            area.clear();
+                            area.startNewSubPath(0.0f, (float)size.y);
+                            for (int i = 0; i < NUMPOINTS; i++)
+                                area.lineTo(getX(i, size.x), levels[t][(size_t)i]*size.y);
+                            area.lineTo((float)size.x, (float)size.y);
+                            area.closeSubPath();
+                            g.setColour(colour.withAlpha(0.12f));
+                            g.fillPath(area);
+                        }
+                        g.setColour(colour);
+                        for (int i = 1; i < NUMPOINTS; i++)
+                            g.drawLine(getX(i-1, size.x), levels[t][(size_t)i-1]*size.y, getX(i, size.x), levels[t][(size_t)i]*size.y);
+                    }
+                });
+
+                const double rasterizerMs = measureMs(ITERATIONS, [&]
+                {
+                    const TraceRasterizer::Trace* order[NUMTRACES];
+                    for (int t = 0; t < NUMTRACES; t++)
+                    {
+                        const auto colour = getColour(t);
+                        traces[t].begin(width, colour, t < NUMREFERENCES ? colour.withAlpha(0.12f) : juce::Colours::transparentBlack);
+                        for (int i = 1; i < NUMPOINTS; i++)
+                            traces[t].addSegment(getX(i-1, size.x)*scale, levels[t][(size_t)i-1]*height,
+                                                 getX(i, size.x)*scale, levels[t][(size_t)i]*height);
+                        order[t] = &traces[t];
+                    }
+                    rasterizer.render(traceImage, order, NUMTRACES);
+                    juce::Graphics g(target);
+                    g.fillAll(juce::Colours::black);
+                    g.drawImageAt(traceImage, 0, 0);
+                });
+
+                logMessage(juce::String(size.x) + "x" + juce::String(size.y) + " @" + juce::String(scale) + "x: Graphics "
+                           + juce::String(graphicsMs, 3) + " ms, TraceRasterizer " + juce::String(rasterizerMs, 3) + " ms, "
+                           + juce::String(graphicsMs/rasterizerMs, 2) + "x");
+            }
+        }
+    }
+
+private:
+    static constexpr int NUMTRACES = 6;
+    static constexpr int NUMREFERENCES = 2;     // the first traces are filled
+    static constexpr int NUMPOINTS = 512;
+    static constexpr int ITERATIONS = 20;
+
+    std::vector<float> levels[NUMTRACES];
+
+    static float getX(int point, int width)
+    {
+        return (float)width*(float)point/(float)(NUMPOINTS-1);
+    }
+
+    static juce::Colour getColour(int trace)
+    {
+        static const juce::Colour colours[NUMTRACES] = { juce::Colours::lightblue, juce::Colours::lightgreen,
+            juce::Colours::yellow, juce::Colours::pink, juce::Colours::orange, juce::Colours::purple };
+        return colours[trace].withAlpha(trace < NUMREFERENCES ? 0.4f : 0.5f);
+    }
+};
+
+static TraceBenchmark traceBenchmark;
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    AnalyzerArena.h
+    Created: 24 Oct 2026 3:40:18pm
+    Author:  Louis Deng
+
+    one allocation for all the buffers of an analyzer configuration
+
+    an arena is laid out first (every buffer reserved by name, element type and
+    count, each starting on a 64 byte line so SIMD loads and the audio thread's
+    writes never share a cache line with a neighbour) and then allocated once,
+    zeroed. the buffers are handed out as ArenaArray views into it and live
+    exactly as long as the arena, so a whole configuration is built, reported
+    and thrown away as one block instead of dozens of separate vectors
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/// non-owning view of a buffer in an AnalyzerArena, indexed like the vector it replaces
+template <typename T>
+class ArenaArray
+{
+public:
+    ArenaArray()
+    {
+    }
+    ArenaArray(T* start, size_t count): elements(start), numElements(count)
+    {
+    }
+
+    T* data() const { return elements; }
+    size_t size() const { return numElements; }
+    bool empty() const { return numElements == 0; }
+    T& operator[](size_t i) const { return elements[i]; }
+    T* begin() const { return elements; }
+    T* end() const { return elements+numElements; }
+
+private:
+    T* elements = nullptr;
+    size_t numElements = 0;
+};
+
+class AnalyzerArena
+{
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    AnalyzerArena()
+    {
+    }
+
+    ~AnalyzerArena()
+    {
+        // only trivially destructible element types are placed, the block goes as a whole
+    }
+
+    /// layout: room for count Ts, named for the footprint report, returns where it will be
+    template <typename T>
+    size_t reserve(const char* name, size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value && alignof(T) <= ALIGNMENT, "arena buffers are never destroyed one by one");
+        jassert(block == nullptr);  // reserved after allocate()
+        const size_t offset = totalBytes;
+        const size_t bytes = count*sizeof(T);
+        regions.push_back({ name, bytes });
+        totalBytes += (bytes+ALIGNMENT-1) & ~(ALIGNMENT-1);
+        return offset;
+    }
+
+    /// the single allocation, zeroed, for everything reserved so far
+    void allocate()
+    {
+        storage.allocate(totalBytes+ALIGNMENT, true);
+        block = juce::snapPointerToAlignment(storage.get(), ALIGNMENT);
+    }
+
+    /// after allocate(): the count Ts reserved at offset, value initialized
+    template <typename T>
+    ArenaArray<T> place(size_t offset, size_t count)
+    {
+        jassert(block != nullptr && offset+count*sizeof(T) <= totalBytes);
+        T* start = reinterpret_cast<T*>(block+offset);
+        std::uninitialized_value_construct_n(start, count);
+        return { start, count };
+    }
+
+    /// bytes in use (the allocation itself is up to ALIGNMENT more)
+    size_t getTotalBytes() const { return totalBytes; }
+
+    /// "name: bytes" per buffer, one per line, and the total
+    juce::String getReport() const
+    {
+        juce::String report;
+        for (const auto& region : regions)
+            report << region.name << ": " << (juce::int64)region.bytes << " B\n";
+        return report << "arena total: " << (juce::int64)totalBytes << " B (" << (int)regions.size() << " buffers, one block)";
+    }
+
+private:
+    struct Region
+    {
+        const char* name;
+        size_t bytes;
+    };
+
+    std::vector<Region> regions;
+    size_t totalBytes = 0;
+    juce::HeapBlock<char> storage;
+    char* block = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE(AnalyzerArena)
+};
+
+/// bytes held by a buffer kept outside an arena, for the same memory reports
+template <typename T>
+inline size_t vectorBytes(const std::vector<T>& buffer) { return buffer.capacity()*sizeof(T); }
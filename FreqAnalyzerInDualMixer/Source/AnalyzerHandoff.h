@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    AnalyzerHandoff.h
+    Created: 19 Oct 2026 11:02:47am
+    Author:  Louis Deng
+
+    attach/detach protocol handing the processor's AnalysisEngine to the audio thread
+
+    the audio thread only ever sees a raw atomic pointer, read inside a ReadScope
+    that bumps an epoch counter (odd = inside, even = outside). detach() clears the
+    pointer and waits on the message thread until the audio thread has left any
+    scope that might still hold the old pointer, so the message thread can
+    reconfigure the engine (or a view can subscribe to it) while detached, and
+    the audio thread never sees it half rebuilt.
+    assumes a single reader thread (the one calling processBlock)
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class AnalysisEngine;
+
+class AnalyzerHandoff
+{
+public:
+    AnalyzerHandoff()
+    {
+    }
+
+    ~AnalyzerHandoff()
+    {
+        jassert(analyzerPtr.load() == nullptr);  // the processor detaches before its engine goes away
+    }
+
+    /// message thread: hand the engine (back) to the audio thread
+    void attach(AnalysisEngine* analyzer)
+    {
+        analyzerPtr.store(analyzer);
+    }
+
+    /// message thread: withdraw the engine, returns once the audio thread can no longer touch it
+    void detach()
+    {
+        analyzerPtr.store(nullptr);
+
+        // if the audio thread is inside a scope it may have loaded the old pointer, wait for it to leave
+        const uint32_t e = epoch.load();
+        if (e & 1u)
+        {
+            while (epoch.load() == e)
+                std::this_thread::yield();
+        }
+    }
+
+    /// audio thread: keeps the engine attached for the lifetime of this object, get() may return nullptr
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(AnalyzerHandoff& h): owner(h)
+        {
+            owner.epoch.fetch_add(1);
+            analyzer = owner.analyzerPtr.load();
+        }
+        ~ReadScope()
+        {
+            owner.epoch.fetch_add(1, std::memory_order_release);
+        }
+
+        AnalysisEngine* get() const { return analyzer; }
+
+    private:
+        AnalyzerHandoff& owner;
+        AnalysisEngine* analyzer;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+private:
+    std::atomic<AnalysisEngine*> analyzerPtr { nullptr };
+    std::atomic<uint32_t> epoch { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(AnalyzerHandoff)
+};
@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+
+    AnalyzerHub.h
+    Created: 23 Oct 2026 2:37:40pm
+    Author:  Louis Deng
+
+    process-wide registry of plugin instances and their output spectra, so one
+    editor can overlay the buses of other instances without opening their editors
+
+    every processor claims a slot when it is constructed (compare-and-swap on a
+    fixed array, no lock) and publishes into it from the audio thread through a
+    per-channel sequence lock: the writer never waits, readers retry a torn copy.
+    the spectra are of the output at a fixed resolution (HubFeed below), the same
+    for every instance whatever their own displays are set to, so they line up.
+    viewers count themselves on a slot, an instance nobody watches does no hub
+    analysis at all
+
+    shared between the instances through juce::SharedResourcePointer
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SpectrumUtil.h"
+#include "BatchFFT.h"
+#include "AnalyzerArena.h"
+
+class AnalyzerHub
+{
+public:
+    static constexpr int MAXINSTANCES = 64;
+    /// published spectra are 2^ORDER point transforms, NUMBINS magnitudes per channel
+    static constexpr uint32_t ORDER = 11;
+    static constexpr int NUMBINS = 1 << (ORDER-1);
+
+    /// an instance as a viewer remembers it, stale once its slot has been given to another instance
+    struct InstanceRef
+    {
+        int slot = -1;
+        uint32_t generation = 0;
+        bool operator==(const InstanceRef& other) const { return slot == other.slot && generation == other.generation; }
+    };
+
+    AnalyzerHub()
+    {
+    }
+
+    ~AnalyzerHub()
+    {
+    }
+
+    /// any thread, lock-free: claim a free slot, -1 when all MAXINSTANCES are taken
+    int registerInstance()
+    {
+        for (int i=0;i<MAXINSTANCES;i++)
+        {
+            auto& slot = slots[i];
+            bool expected = false;
+            if (slot.used.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            {
+                slot.generation.fetch_add(1, std::memory_order_acq_rel);
+                for (auto& sequence : slot.sequence)
+                    sequence.store(0, std::memory_order_release);
+                setName(i, "FreqAnalyzer " + juce::String(i+1));
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /// after the audio thread has stopped publishing into the slot
+    void unregisterInstance(int slot)
+    {
+        if (slot >= 0)
+            slots[slot].used.store(false, std::memory_order_release);
+    }
+
+    /// the slot's current occupant, for viewers to keep
+    InstanceRef getInstance(int slot) const { return { slot, slots[slot].generation.load(std::memory_order_acquire) }; }
+
+    bool isLive(int slot) const { return slots[slot].used.load(std::memory_order_acquire); }
+
+    /// still the same instance it was when the viewer picked it
+    bool isCurrent(const InstanceRef& ref) const
+    {
+        return ref.slot >= 0 && isLive(ref.slot) && slots[ref.slot].generation.load(std::memory_order_acquire) == ref.generation;
+    }
+
+    /// not on the audio thread: shown in other instances' overlay lists (track name when the host gives one)
+    void setName(int slot, const juce::String& newName)
+    {
+        const juce::SpinLock::ScopedLockType lock(slots[slot].nameLock);
+        slots[slot].name = newName;
+    }
+
+    juce::String getName(int slot) const
+    {
+        const juce::SpinLock::ScopedLockType lock(slots[slot].nameLock);
+        return slots[slot].name;
+    }
+
+    /// called from prepareToPlay, places the published bins on the frequency axis
+    void setFormat(int slot, double sampleRate, int numChannels)
+    {
+        slots[slot].sampleRate.store((float)sampleRate, std::memory_order_relaxed);
+        slots[slot].numChannels.store(juce::jlimit(1, 2, numChannels), std::memory_order_relaxed);
+    }
+
+    float getSampleRate(int slot) const { return slots[slot].sampleRate.load(std::memory_order_relaxed); }
+    int getNumChannels(int slot) const { return slots[slot].numChannels.load(std::memory_order_relaxed); }
+
+    /// message thread: a viewer starts or stops overlaying the slot, calls must pair up
+    void watch(int slot) { slots[slot].watchers.fetch_add(1, std::memory_order_relaxed); }
+    void unwatch(int slot) { slots[slot].watchers.fetch_sub(1, std::memory_order_relaxed); }
+
+    /// audio thread, once per block: is there anybody to publish for
+    bool isWatched(int slot) const { return slot >= 0 && slots[slot].watchers.load(std::memory_order_relaxed) > 0; }
+
+    /// audio thread, lock-free and wait-free: NUMBINS magnitudes of one channel
+    void publish(int slot, uint32_t channel, const float* magnitudes)
+    {
+        auto& s = slots[slot];
+        const uint32_t sequence = s.sequence[channel].load(std::memory_order_relaxed);
+        // odd while writing
+        s.sequence[channel].store(sequence+1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int bin=0;bin<NUMBINS;bin++)
+            s.levels[channel][bin].store(magnitudes[bin], std::memory_order_relaxed);
+        s.sequence[channel].store(sequence+2, std::memory_order_release);
+    }
+
+    /// any thread: copy the latest NUMBINS magnitudes of one channel, false when nothing was published yet,
+    /// the instance is gone, or the writer kept tearing the copy
+    bool read(const InstanceRef& ref, uint32_t channel, float* dest) const
+    {
+        const auto& s = slots[ref.slot];
+        for (int attempt=0;attempt<MAXREADATTEMPTS;attempt++)
+        {
+            const uint32_t before = s.sequence[channel].load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before & 1)
+                continue;
+            for (int bin=0;bin<NUMBINS;bin++)
+                dest[bin] = s.levels[channel][bin].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.sequence[channel].load(std::memory_order_relaxed) == before)
+                return isCurrent(ref);
+        }
+        return false;
+    }
+
+private:
+    static constexpr int MAXREADATTEMPTS = 4;
+
+    struct Slot
+    {
+        std::atomic<bool> used { false };
+        std::atomic<uint32_t> generation { 0 };
+        std::atomic<int> watchers { 0 };
+        std::atomic<float> sampleRate { 48000.0f };
+        std::atomic<int> numChannels { 2 };
+        juce::SpinLock nameLock;
+        juce::String name;
+        std::atomic<uint32_t> sequence[2] {};
+        std::atomic<float> levels[2][NUMBINS] {};
+    };
+
+    Slot slots[MAXINSTANCES];
+
+    JUCE_DECLARE_NON_COPYABLE(AnalyzerHub)
+};
+
+/// the output spectrum an instance publishes to the hub: Hann windowed 2^ORDER transforms zero padded
+/// like the display's fft units (so the levels read the same), 50 % overlap, both channels in one batch
+/// the input rings and frames are one arena block, sized once for the hub's fixed resolution
+class HubFeed
+{
+public:
+    HubFeed(): batchFFT(AnalyzerHub::ORDER)
+    {
+        const size_t inputAt[2] = { arena.reserve<float>("hub input left", NYQUIST), arena.reserve<float>("hub input right", NYQUIST) };
+        const size_t framesAt[2] = { arena.reserve<float>("hub frame left", SIZE), arena.reserve<float>("hub frame right", SIZE) };
+        arena.allocate();
+        for (int channel=0;channel<2;channel++)
+        {
+            input[channel] = arena.place<float>(inputAt[channel], NYQUIST);
+            frames[channel] = arena.place<float>(framesAt[channel], SIZE);
+        }
+    }
+
+    ~HubFeed()
+    {
+    }
+
+    /// called from prepareToPlay
+    void prepare()
+    {
+        for (auto& channel : input)
+            std::fill(channel.begin(), channel.end(), 0.0f);
+        writePosition = 0;
+        hopCounter = 0;
+    }
+
+    /// audio thread, only while the instance is watched: a block of the output
+    template <typename SampleType>
+    void process(AnalyzerHub& hub, int slot, const SampleType* const* channels, int numChannels, int numSamples)
+    {
+        numChannels = juce::jmin(numChannels, 2);
+        for (int start=0;start<numSamples;)
+        {
+            const int numRun = juce::jmin(numSamples-start, HOP-hopCounter, NYQUIST-writePosition);
+            for (int channel=0;channel<numChannels;channel++)
+                for (int i=0;i<numRun;i++)
+                    input[channel][writePosition+i] = (float)channels[channel][start+i];
+            writePosition = (writePosition+numRun) % NYQUIST;
+            hopCounter += numRun;
+            start += numRun;
+
+            if (hopCounter == HOP)
+            {
+                hopCounter = 0;
+                transform(hub, slot, numChannels);
+            }
+        }
+    }
+
+    /// bytes of the rings, frames and the batch transform's buffers
+    size_t getMemoryBytes() const { return arena.getTotalBytes()+batchFFT.getMemoryBytes(); }
+
+private:
+    static constexpr int SIZE = 1 << AnalyzerHub::ORDER;
+    static constexpr int NYQUIST = SIZE >> 1;
+    static constexpr int HOP = NYQUIST >> 1;
+
+    BatchFFT batchFFT;
+    AnalyzerArena arena;
+    ArenaArray<float> input[2];
+    ArenaArray<float> frames[2];
+    int writePosition = 0;
+    int hopCounter = 0;
+
+    void transform(AnalyzerHub& hub, int slot, int numChannels)
+    {
+        const auto& window = SpectrumUtil::hannWindow<NYQUIST>;
+        float* framePointers[2];
+        for (int channel=0;channel<numChannels;channel++)
+        {
+            // oldest sample first, the padding half stays zero
+            auto& frame = frames[channel];
+            const auto& samples = input[channel];
+            for (int i=0;i<NYQUIST;i++)
+                frame[i] = samples[(writePosition+i) % NYQUIST]*window[i];
+            std::fill(frame.begin()+NYQUIST, frame.end(), 0.0f);
+            framePointers[channel] = frame.data();
+        }
+        batchFFT.performFrequencyOnlyForwardTransform(framePointers, numChannels);
+        for (int channel=0;channel<numChannels;channel++)
+            hub.publish(slot, (uint32_t)channel, frames[channel].data());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(HubFeed)
+};
@@ -0,0 +1,243 @@
+/*
+  ==============================================================================
+
+    BatchFFT.h
+    Created: 19 Oct 2026 1:26:05pm
+    Author:  Louis Deng
+
+    radix-2 FFT transforming several same-size real frames at once, one frame
+    per SIMD lane (4 lanes SSE/NEON, 8 lanes AVX), lane-interleaved storage.
+    frames go in and out of the registers by 4x4 transposes on SSE and NEON,
+    through memory elsewhere, never one lane at a time
+
+    used by FreqAnalyzer to transform the dry/wet x L/R frames that all reach
+    their hop boundary on the same sample, instead of four separate FFT calls.
+    output is the magnitude spectrum, same as juce::dsp::FFT's
+    performFrequencyOnlyForwardTransform (unnormalized, all getSize() bins)
+
+    the registers, tables and spare rows are one AnalyzerArena block
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AnalyzerArena.h"
+
+class BatchFFT
+{
+public:
+#if JUCE_USE_SIMD
+    using Reg = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = (int)Reg::SIMDNumElements;
+#else
+    static constexpr int LANES = 1;
+#endif
+
+    BatchFFT(uint32_t order): size(1 << order)
+    {
+#if JUCE_USE_SIMD
+        const size_t reAt = arena.reserve<Reg>("batch fft re", (size_t)size);
+        const size_t imAt = arena.reserve<Reg>("batch fft im", (size_t)size);
+        const size_t bitrevAt = arena.reserve<int>("batch fft bit reversal", (size_t)size);
+        const size_t twiddleAt[2] = { arena.reserve<float>("batch fft twiddle re", (size_t)(size >> 1)),
+                                      arena.reserve<float>("batch fft twiddle im", (size_t)(size >> 1)) };
+        const size_t rowsAt[2] = { arena.reserve<float>("batch fft zero row", (size_t)size), arena.reserve<float>("batch fft spare row", (size_t)size) };
+        arena.allocate();
+        re = arena.place<Reg>(reAt, (size_t)size);
+        im = arena.place<Reg>(imAt, (size_t)size);
+        twiddleRe = arena.place<float>(twiddleAt[0], (size_t)(size >> 1));
+        twiddleIm = arena.place<float>(twiddleAt[1], (size_t)(size >> 1));
+        zeroRow = arena.place<float>(rowsAt[0], (size_t)size);
+        spareRow = arena.place<float>(rowsAt[1], (size_t)size);
+
+        // bit reversed load order
+        bitrev = arena.place<int>(bitrevAt, (size_t)size);
+        for (int i=0;i<size;i++)
+        {
+            int r = 0;
+            for (uint32_t b=0;b<order;b++)
+                r |= ((i >> b) & 1) << (order-1-b);
+            bitrev[i] = r;
+        }
+
+        // twiddles e^(-j*2*pi*k/N) for k < N/2
+        for (int k=0;k<(size >> 1);k++)
+        {
+            const double phase = juce::MathConstants<double>::twoPi*k/size;
+            twiddleRe[k] = (float)cos(phase);
+            twiddleIm[k] = (float)-sin(phase);
+        }
+#else
+        fftOp.reset(new juce::dsp::FFT((int)order));
+        const size_t scratchAt = arena.reserve<float>("batch fft scratch", (size_t)size*2);
+        arena.allocate();
+        scratch = arena.place<float>(scratchAt, (size_t)size*2);
+#endif
+    }
+
+    ~BatchFFT()
+    {
+    }
+
+    int getSize() const { return size; }
+
+    /// bytes of work buffers and tables, for memory reports
+    size_t getMemoryBytes() const { return arena.getTotalBytes(); }
+
+    /// in-place magnitude spectrum of numFrames real frames of getSize() samples each, numFrames can exceed LANES
+    void performFrequencyOnlyForwardTransform(float* const* frames, int numFrames)
+    {
+        for (int first=0;first<numFrames;first+=LANES)
+            performBatch(frames+first, juce::jmin(LANES,numFrames-first));
+    }
+
+private:
+    int size;
+    AnalyzerArena arena;
+
+#if JUCE_USE_SIMD
+    ArenaArray<Reg> re;
+    ArenaArray<Reg> im;
+    ArenaArray<int> bitrev;
+    ArenaArray<float> twiddleRe;
+    ArenaArray<float> twiddleIm;
+    ArenaArray<float> zeroRow;      // input of the lanes a short batch leaves unused
+    ArenaArray<float> spareRow;     // and where their output goes
+
+    void performBatch(float* const* frames, int numFrames)
+    {
+        // every batch is a full one, unused lanes transform zeros nobody reads
+        const float* input[LANES];
+        float* output[LANES];
+        for (int l=0;l<LANES;l++)
+        {
+            input[l] = l < numFrames ? frames[l] : zeroRow.data();
+            output[l] = l < numFrames ? frames[l] : spareRow.data();
+        }
+
+        // transpose the frames into lane-interleaved registers, staged in im, then put them
+        // in bit reversed order a whole register at a time
+        interleave(input, im.data());
+        const Reg zero = Reg::expand(0.0f);
+        for (int i=0;i<size;i++)
+            re[bitrev[i]] = im[i];
+        std::fill(im.begin(), im.end(), zero);
+
+        // iterative decimation in time, twiddle outer loop so each twiddle is broadcast once per stage
+        for (int half=1;half<size;half<<=1)
+        {
+            const int step = size/(half << 1);
+            for (int k=0;k<half;k++)
+            {
+                const Reg wr = Reg::expand(twiddleRe[k*step]);
+                const Reg wi = Reg::expand(twiddleIm[k*step]);
+                for (int a=k;a<size;a+=(half << 1))
+                {
+                    const int b = a+half;
+                    const Reg tr = re[b]*wr - im[b]*wi;
+                    const Reg ti = re[b]*wi + im[b]*wr;
+                    re[b] = re[a] - tr;
+                    im[b] = im[a] - ti;
+                    re[a] += tr;
+                    im[a] += ti;
+                }
+            }
+        }
+
+        // magnitudes in place of the real parts, then transposed back out to each frame
+        for (int i=0;i<size;i++)
+            re[i] = squareRoot(re[i]*re[i] + im[i]*im[i]);
+        deinterleave(re.data(), output);
+    }
+
+    static Reg squareRoot(Reg x)
+    {
+#if JUCE_USE_AVX_INTRINSICS
+        return Reg(_mm256_sqrt_ps(x.value));
+#elif JUCE_USE_SSE_INTRINSICS
+        return Reg(_mm_sqrt_ps(x.value));
+#elif JUCE_USE_ARM_NEON && defined(__aarch64__)
+        return Reg(vsqrtq_f32(x.value));
+#else
+        float* lanes = reinterpret_cast<float*>(&x);
+        for (int l=0;l<LANES;l++)
+            lanes[l] = std::sqrt(lanes[l]);
+        return x;
+#endif
+    }
+
+    /// sample i of lane l to lane l of register i, LANES samples of every frame per step
+    void interleave(const float* const* input, Reg* dest) const
+    {
+#if JUCE_USE_SSE_INTRINSICS && !JUCE_USE_AVX_INTRINSICS
+        for (int i=0;i<size;i+=4)
+        {
+            __m128 r0 = _mm_loadu_ps(input[0]+i), r1 = _mm_loadu_ps(input[1]+i);
+            __m128 r2 = _mm_loadu_ps(input[2]+i), r3 = _mm_loadu_ps(input[3]+i);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            dest[i] = Reg(r0);
+            dest[i+1] = Reg(r1);
+            dest[i+2] = Reg(r2);
+            dest[i+3] = Reg(r3);
+        }
+#elif JUCE_USE_ARM_NEON
+        for (int i=0;i<size;i+=4)
+        {
+            const float32x4x4_t rows = { { vld1q_f32(input[0]+i), vld1q_f32(input[1]+i), vld1q_f32(input[2]+i), vld1q_f32(input[3]+i) } };
+            vst4q_f32(reinterpret_cast<float*>(dest+i), rows);
+        }
+#else
+        // registers are LANES contiguous floats, written through memory
+        float* lanes = reinterpret_cast<float*>(dest);
+        for (int i=0;i<size;i++)
+            for (int l=0;l<LANES;l++)
+                lanes[i*LANES+l] = input[l][i];
+#endif
+    }
+
+    /// inverse of interleave()
+    void deinterleave(const Reg* source, float* const* output) const
+    {
+#if JUCE_USE_SSE_INTRINSICS && !JUCE_USE_AVX_INTRINSICS
+        for (int i=0;i<size;i+=4)
+        {
+            __m128 r0 = source[i].value, r1 = source[i+1].value, r2 = source[i+2].value, r3 = source[i+3].value;
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(output[0]+i, r0);
+            _mm_storeu_ps(output[1]+i, r1);
+            _mm_storeu_ps(output[2]+i, r2);
+            _mm_storeu_ps(output[3]+i, r3);
+        }
+#elif JUCE_USE_ARM_NEON
+        for (int i=0;i<size;i+=4)
+        {
+            const float32x4x4_t rows = vld4q_f32(reinterpret_cast<const float*>(source+i));
+            for (int l=0;l<4;l++)
+                vst1q_f32(output[l]+i, rows.val[l]);
+        }
+#else
+        const float* lanes = reinterpret_cast<const float*>(source);
+        for (int i=0;i<size;i++)
+            for (int l=0;l<LANES;l++)
+                output[l][i] = lanes[i*LANES+l];
+#endif
+    }
+#else
+    std::unique_ptr<juce::dsp::FFT> fftOp;
+    ArenaArray<float> scratch;
+
+    /// no SIMD, fall back to one juce FFT per frame (needs a 2*size work buffer)
+    void performBatch(float* const* frames, int numFrames)
+    {
+        for (int l=0;l<numFrames;l++)
+        {
+            std::copy(frames[l],frames[l]+size,scratch.begin());
+            std::fill(scratch.begin()+size,scratch.end(),0.0f);
+            fftOp->performFrequencyOnlyForwardTransform(scratch.data());
+            std::copy(scratch.begin(),scratch.begin()+size,frames[l]);
+        }
+    }
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE(BatchFFT)
+};
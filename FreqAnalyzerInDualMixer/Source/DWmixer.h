@@ -6,7 +6,7 @@
     Author:  Louis Deng
  
     Dry/Wet signal mixer, sends signal to frequency analyzer about its dry and wet samples
-    must be using the same signal type (double/float) with FreqAnalyzer class
+    mixes in SignalType (float or double), the analyzer is always handed float blocks
 
   ==============================================================================
 */
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "FreqAnalyzer.h"
+#include "LoudnessMeter.h"
 
 template <typename SignalType>
 class DWmixer
@@ -28,25 +29,91 @@ public:
     {
     }
     
-    void communicateFreqAnalyzerPtr(std::shared_ptr<FreqAnalyzer> freqAnalyzerPtr)
+    /// called from prepareToPlay, jumps straight to the given proportion without a ramp
+    void prepare(double sampleRate, SignalType initialProportion)
     {
-        faPtrW = freqAnalyzerPtr;
+        rampLength = juce::jmax(1, juce::roundToInt(sampleRate*RAMPSECONDS));
+        proportion = initialProportion;
+        rampStart = initialProportion;
+        rampPosition = rampLength;
+        pendingDelay = -1;
     }
     
-    /// process buffered input (R+W Permission for wet, R Permission for dry): apply sample-wise tick calculation, and replace buffer with output.
-    void processBuffer(const float *dryBufferRead, float *wetBufferWrite, int numSamps)
+    /// audio thread, once per block before processBuffer: ramp towards a new proportion over RAMPSECONDS
+    /// blockStart: stream position of the block's first sample. the ramp starts on the next MIXGRID sample
+    /// boundary of the stream, not at the block, so a value read at any block size in the same grid cell
+    /// renders the same samples
+    void setTargetProportion(SignalType target, juce::int64 blockStart)
     {
-        for (int i=0;i<numSamps;i++)
+        if (pendingDelay == 0)
+            startPendingRamp();
+        if (target == (pendingDelay >= 0 ? pendingProportion : proportion))
+            return;
+        pendingProportion = target;
+        pendingDelay = (int)((MIXGRID - blockStart%MIXGRID) % MIXGRID);
+    }
+    
+    /// process buffered input (R+W Permission for wet, R Permission for dry): mix into wet, replacing its content.
+    /// analyzer comes from an AnalyzerHandoff::ReadScope held by the caller, nullptr while detached or not analyzing
+    /// meters: input and output loudness meters, fed the unscaled dry input and the mixed result, the caller advances them
+    void processBuffer(const SignalType *dryBufferRead, SignalType *wetBufferWrite, int numSamps, AnalysisEngine* analyzer, LoudnessMeter* meters)
+    {
+        // in pieces of the scratch size, so the analyzer gets whole blocks instead of single samples,
+        // split where a pending ramp starts
+        for (int start=0;start<numSamps;)
         {
-            //overwrite wet with dry+wet
-            *(wetBufferWrite+i) = mix(*(dryBufferRead+i),*(wetBufferWrite+i));
+            if (pendingDelay == 0)
+                startPendingRamp();
+            int numPiece = juce::jmin(SCRATCHSIZE,numSamps-start);
+            if (pendingDelay > 0)
+            {
+                numPiece = juce::jmin(numPiece, pendingDelay);
+                pendingDelay -= numPiece;
+            }
+            const SignalType* dry = dryBufferRead+start;
+            SignalType* wet = wetBufferWrite+start;
+            
+            // ramping part, then the settled part at a constant proportion
+            const int numRamp = juce::jmin(numPiece, rampLength-rampPosition);
+            if (numRamp > 0)
+                mixRamp(dry, wet, numRamp);
+            if (numRamp < numPiece)
+                mixConstant(dry+numRamp, wet+numRamp, numPiece-numRamp, numRamp);
+            
+            // loudness of what comes in and what goes out, not of the two scaled halves of the mix
+            meters[0].processChannel(thisChanid,dry,numPiece);
+            meters[1].processChannel(thisChanid,wet,numPiece);
+            
+            //embed freq analyzer, inject dry and wet of this channel
+            if (analyzer != nullptr)
+            {
+                const auto startTicks = juce::Time::getHighResolutionTicks();
+                if constexpr (std::is_same<SignalType, float>::value)
+                {
+                    analyzer->injectBlockToTo(dryScratch.data(),numPiece,thisChanid,0);
+                    analyzer->injectBlockToTo(wetScratch.data(),numPiece,thisChanid,1);
+                }
+                else
+                {
+                    // the analyzer is float, narrow only what it sees
+                    toFloat(dryAnalysis.data(),dryScratch.data(),numPiece);
+                    toFloat(wetAnalysis.data(),wetScratch.data(),numPiece);
+                    analyzer->injectBlockToTo(dryAnalysis.data(),numPiece,thisChanid,0);
+                    analyzer->injectBlockToTo(wetAnalysis.data(),numPiece,thisChanid,1);
+                }
+                analysisTicks += juce::Time::getHighResolutionTicks()-startTicks;
+            }
+            start += numPiece;
         }
         //DBG("processed one buffer");
     }
     
-    void injectProportion(double input)
+    /// audio thread: ticks spent in the analyzer since the last call, the quality governor's share of processBuffer
+    juce::int64 takeAnalysisTicks()
     {
-        proportion = input;
+        const auto ticks = analysisTicks;
+        analysisTicks = 0;
+        return ticks;
     }
     
     void setid(uint32_t channelid)
@@ -55,29 +122,81 @@ public:
     }
     
 private:
-    // basics
-    SignalType outSamp_ = 0.0;
-    double proportion = 0.0;
+    // parameter changes are ramped linearly over a fixed time rather than over the next block
+    static constexpr double RAMPSECONDS = 0.02;
+    // ramps start on multiples of this many samples of the stream, whatever the host block size
+    static constexpr int MIXGRID = 32;
+    
+    // basics, audio thread only
+    SignalType proportion = 1;  // target
+    SignalType rampStart = 1;
+    int rampLength = 1;
+    int rampPosition = 1;       // == rampLength when settled
+    // target read from the parameter, and the samples left until the grid boundary it starts on, -1 for none
+    SignalType pendingProportion = 1;
+    int pendingDelay = -1;
     
     // channel id, distinguish left and right
     uint32_t thisChanid;
     
-    // shared ptr storage
-    std::weak_ptr<FreqAnalyzer> faPtrW;
-    std::shared_ptr<FreqAnalyzer> faPtr;
+    // time spent injecting into the analyzer, taken by the caller every block
+    juce::int64 analysisTicks = 0;
+    
+    // scaled dry and wet of the current piece, handed to the analyzer as blocks
+    static constexpr int SCRATCHSIZE = 512;
+    std::array<SignalType, SCRATCHSIZE> dryScratch;
+    std::array<SignalType, SCRATCHSIZE> wetScratch;
+    std::array<SignalType, SCRATCHSIZE> gainScratch;
+    // float copies for the analyzer, double precision only
+    std::array<float, SCRATCHSIZE> dryAnalysis;
+    std::array<float, SCRATCHSIZE> wetAnalysis;
+    
+    /// proportion at the current ramp position, computed from the position rather than accumulated,
+    /// so a ramp splits into chunks without drift
+    SignalType currentProportion() const
+    {
+        return rampStart + (proportion-rampStart)*(SignalType)rampPosition/(SignalType)rampLength;
+    }
+    
+    /// at the grid boundary: a change mid-ramp starts the new ramp from wherever the old one got to
+    void startPendingRamp()
+    {
+        pendingDelay = -1;
+        if (pendingProportion == proportion)
+            return;
+        rampStart = currentProportion();
+        proportion = pendingProportion;
+        rampPosition = 0;
+    }
+    
+    /// plain loop the compiler turns into packed double->float conversions
+    static void toFloat(float* dest, const SignalType* src, int numSamps)
+    {
+        for (int i=0;i<numSamps;i++)
+            dest[i] = (float)src[i];
+    }
     
-    SignalType mix(SignalType dryInput, SignalType wetInput)
+    void mixRamp(const SignalType* dry, SignalType* wet, int numSamps)
     {
-        SignalType dryPPT = (1.0-proportion)*(double)dryInput;
-        SignalType wetPPT = proportion*(double)wetInput;
-        //embed freq analyzer, inject dry and wet of this channel
-        if ((faPtr=faPtrW.lock()) != nullptr)   // here try to access the shared pointer
+        for (int i=0;i<numSamps;i++)
         {
-            faPtr->injectSampleToTo(dryPPT,thisChanid,0);
-            faPtr->injectSampleToTo(wetPPT,thisChanid,1);
-            //DBG("injectedToTo freqAnalyzer once");
+            rampPosition++;
+            gainScratch[i] = currentProportion();
         }
-        outSamp_ = dryPPT+wetPPT;
-        return outSamp_;
+        // wet gain, then dry gain as 1 - wet gain
+        juce::FloatVectorOperations::multiply(wetScratch.data(), wet, gainScratch.data(), numSamps);
+        juce::FloatVectorOperations::multiply(dryScratch.data(), dry, gainScratch.data(), numSamps);
+        juce::FloatVectorOperations::negate(dryScratch.data(), dryScratch.data(), numSamps);
+        juce::FloatVectorOperations::add(dryScratch.data(), dry, numSamps);
+        juce::FloatVectorOperations::add(wet, dryScratch.data(), wetScratch.data(), numSamps);
+    }
+    
+    void mixConstant(const SignalType* dry, SignalType* wet, int numSamps, int scratchOffset)
+    {
+        SignalType* dryOut = dryScratch.data()+scratchOffset;
+        SignalType* wetOut = wetScratch.data()+scratchOffset;
+        juce::FloatVectorOperations::multiply(dryOut, dry, (SignalType)1-proportion, numSamps);
+        juce::FloatVectorOperations::multiply(wetOut, wet, proportion, numSamps);
+        juce::FloatVectorOperations::add(wet, dryOut, wetOut, numSamps);
     }
 };
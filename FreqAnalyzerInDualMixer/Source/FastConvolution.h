@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    FastConvolution.h
+    Created: 24 Oct 2026 10:21:47am
+    Author:  Louis Deng
+
+    uniformly partitioned overlap-save convolution with a long filter, for the
+    background analysis of sweep measurements (not for the audio thread)
+
+    the filter is cut into blocks of B samples, each transformed once at 2B
+    points. the input goes through in blocks of B: every block is transformed
+    at 2B points (with the previous block in front) into a frequency-domain
+    delay line, the output block is the inverse transform of the sum of the
+    delay line times the filter partitions, last B samples. so a filter of
+    several seconds costs (filter length / B) complex multiply-adds per bin
+    and block instead of one huge transform of the whole signal
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class PartitionedConvolver
+{
+public:
+    /// blockOrder: B = 2^blockOrder samples per partition and per block
+    PartitionedConvolver(const float* filter, int filterLength, int blockOrder)
+        : blockSize(1 << blockOrder), numBins((1 << blockOrder)+1), fft(blockOrder+1)
+    {
+        const int fftSize = blockSize*2;
+        numPartitions = juce::jmax(1, (filterLength+blockSize-1)/blockSize);
+        partitions.resize((size_t)numPartitions*numBins);
+        delayLine.assign((size_t)numPartitions*numBins, {});
+        buffer.resize((size_t)fftSize*2);
+        input.assign((size_t)fftSize, 0.0f);
+        accumulator.resize((size_t)numBins);
+
+        for (int p=0;p<numPartitions;p++)
+        {
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            const int start = p*blockSize;
+            const int length = juce::jmin(blockSize, filterLength-start);
+            std::copy(filter+start, filter+start+length, buffer.begin());
+            fft.performRealOnlyForwardTransform(buffer.data(), true);
+            const auto* spectrum = reinterpret_cast<const std::complex<float>*>(buffer.data());
+            std::copy(spectrum, spectrum+numBins, partitions.begin()+(size_t)p*numBins);
+        }
+    }
+
+    ~PartitionedConvolver()
+    {
+    }
+
+    int getBlockSize() const { return blockSize; }
+
+    /// next getBlockSize() samples of input (nullptr for silence) to the next getBlockSize() samples of output,
+    /// output block k holds samples kB..kB+B-1 of the full convolution
+    void processBlock(const float* in, float* out)
+    {
+        // slide: previous block in front, the new one behind
+        std::copy(input.begin()+blockSize, input.end(), input.begin());
+        if (in != nullptr)
+            std::copy(in, in+blockSize, input.begin()+blockSize);
+        else
+            std::fill(input.begin()+blockSize, input.end(), 0.0f);
+
+        std::copy(input.begin(), input.end(), buffer.begin());
+        fft.performRealOnlyForwardTransform(buffer.data(), true);
+        const auto* spectrum = reinterpret_cast<const std::complex<float>*>(buffer.data());
+        // newest spectrum where the oldest was, delay line read backwards from it
+        position = position == 0 ? numPartitions-1 : position-1;
+        std::copy(spectrum, spectrum+numBins, delayLine.begin()+(size_t)position*numBins);
+
+        std::fill(accumulator.begin(), accumulator.end(), std::complex<float>());
+        for (int p=0;p<numPartitions;p++)
+        {
+            const std::complex<float>* x = delayLine.data()+(size_t)((position+p) % numPartitions)*numBins;
+            const std::complex<float>* h = partitions.data()+(size_t)p*numBins;
+            for (int bin=0;bin<numBins;bin++)
+                accumulator[bin] += x[bin]*h[bin];
+        }
+
+        auto* result = reinterpret_cast<std::complex<float>*>(buffer.data());
+        std::copy(accumulator.begin(), accumulator.end(), result);
+        fft.performRealOnlyInverseTransform(buffer.data());
+        // the first half is wrapped around, the second half is valid
+        std::copy(buffer.begin()+blockSize, buffer.begin()+blockSize*2, out);
+    }
+
+private:
+    int blockSize;
+    int numBins;
+    int numPartitions = 1;
+    int position = 0;
+    juce::dsp::FFT fft;
+    std::vector<std::complex<float>> partitions;    // numPartitions x numBins
+    std::vector<std::complex<float>> delayLine;     // numPartitions x numBins, ring
+    std::vector<std::complex<float>> accumulator;
+    std::vector<float> buffer;                      // transform in place, 2 x fft size
+    std::vector<float> input;                       // previous and current block
+
+    JUCE_DECLARE_NON_COPYABLE(PartitionedConvolver)
+};
@@ -0,0 +1,275 @@
+/*
+  ==============================================================================
+
+    FileAnalysis.h
+    Created: 20 Oct 2026 2:17:53pm
+    Author:  Louis Deng
+
+    whole-file analysis of a dropped audio file, as a reference for the live display
+
+    the file is cut into time segments analyzed in parallel on a thread pool,
+    each segment reads its own span (plus one window of overlap past its end)
+    in chunks, runs a Hann windowed 50% overlap STFT through BatchFFT (framed
+    like the live fftUnits: 2^(order-1) samples zero padded to 2^order) and
+    accumulates an averaged power spectrum per channel and a decimated
+    spectrogram. finished segments are merged into the shared result straight
+    away, so the editor can show partial results while the rest runs
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "BatchFFT.h"
+#include "SpectrumUtil.h"
+
+class FileAnalysis
+{
+public:
+    /// time rows of the decimated spectrogram
+    static constexpr int SPECTROGRAMROWS = 256;
+
+    /// snapshot of the merged results, levels on the display dB scale
+    struct Results
+    {
+        int numBins = 0;
+        std::vector<float> averageDB[2];    // per channel, numBins
+        std::vector<float> spectrogramDB;   // SPECTROGRAMROWS x numBins, both channels, row = time
+        float progress = 0.0f;              // 0..1
+    };
+
+    FileAnalysis()
+    {
+    }
+
+    ~FileAnalysis()
+    {
+        cancel();
+    }
+
+    static bool canAnalyze(const juce::String& path)
+    {
+        return juce::File(path).hasFileExtension("wav;aif;aiff;flac");
+    }
+
+    /// message thread: analyze a file at fft size 2^order, cancels a running analysis
+    bool start(const juce::File& file, uint32_t order)
+    {
+        cancel();
+
+        // nothing is set up until a file is dropped, most editor sessions never analyze one
+        if (pool == nullptr)
+        {
+            formatManager.registerBasicFormats();
+            pool.reset(new juce::ThreadPool(juce::SystemStats::getNumCpus()));
+        }
+
+        std::unique_ptr<juce::AudioFormatReader> probe (formatManager.createReaderFor(file));
+        if (probe == nullptr)
+            return false;
+
+        fftSize = 1 << order;
+        windowSize = fftSize >> 1;
+        hop = windowSize >> 1;
+        const juce::int64 numFrames = probe->lengthInSamples < windowSize ? 0 : 1 + (probe->lengthInSamples-windowSize)/hop;
+        if (numFrames == 0)
+            return false;
+
+        {
+            const juce::ScopedLock sl(resultLock);
+            merged.numBins = fftSize >> 1;
+            for (auto& ch : mergedPower) ch.assign(merged.numBins, 0.0);
+            mergedRows.assign((size_t)SPECTROGRAMROWS*merged.numBins, 0.0);
+            mergedRowCounts.assign(SPECTROGRAMROWS, 0);
+            totalFrames = numFrames;
+            framesDone = 0;
+        }
+
+        // same periodic Hann (x2) as SpectrumUtil::hannWindow, so levels line up with the live trace
+        window.resize(windowSize);
+        for (int i=0;i<windowSize;i++)
+            window[i] = (float)(1.0-cos(juce::MathConstants<double>::twoPi*i/windowSize));
+
+        // a few segments per thread so uneven decoding cost still balances out
+        const int numSegments = (int)juce::jmin(numFrames, (juce::int64)pool->getNumThreads()*4);
+        for (int s=0;s<numSegments;s++)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor(file));
+            if (reader == nullptr)
+                continue;
+            const juce::int64 first = numFrames*s/numSegments;
+            const juce::int64 last = numFrames*(s+1)/numSegments;
+            pool->addJob(new SegmentJob(*this, std::move(reader), order, first, last), true);
+        }
+
+        resultVersion++;
+        return true;
+    }
+
+    /// message thread: stop all segment jobs, blocks until they have returned
+    void cancel()
+    {
+        if (pool != nullptr)
+            pool->removeAllJobs(true, 10000);
+    }
+
+    /// message thread: copy the merged results if they changed since lastVersion
+    bool getResultsIfNew(uint32_t& lastVersion, Results& out)
+    {
+        const uint32_t v = resultVersion.load();
+        if (v == lastVersion)
+            return false;
+        lastVersion = v;
+
+        const juce::ScopedLock sl(resultLock);
+        out.numBins = merged.numBins;
+        out.progress = totalFrames > 0 ? (float)framesDone/(float)totalFrames : 0.0f;
+        for (int ch=0;ch<2;ch++)
+        {
+            out.averageDB[ch].resize(out.numBins);
+            for (int b=0;b<out.numBins;b++)
+                out.averageDB[ch][b] = powerToDB(framesDone > 0 ? mergedPower[ch][b]/(double)framesDone : 0.0);
+        }
+        out.spectrogramDB.resize(mergedRows.size());
+        for (int r=0;r<SPECTROGRAMROWS;r++)
+        {
+            const double count = juce::jmax(1, mergedRowCounts[r]);
+            for (int b=0;b<out.numBins;b++)
+                out.spectrogramDB[(size_t)r*out.numBins+b] = powerToDB(mergedRows[(size_t)r*out.numBins+b]/count);
+        }
+        return true;
+    }
+
+private:
+    juce::AudioFormatManager formatManager;
+    std::unique_ptr<juce::ThreadPool> pool;   // created on the first start()
+
+    // analysis setup, fixed while jobs run
+    int fftSize = 0;
+    int windowSize = 0;
+    int hop = 0;
+    std::vector<float> window;
+
+    // merged results
+    juce::CriticalSection resultLock;
+    Results merged;
+    std::vector<double> mergedPower[2];
+    std::vector<double> mergedRows;
+    std::vector<int> mergedRowCounts;
+    juce::int64 totalFrames = 0;
+    juce::int64 framesDone = 0;
+    std::atomic<uint32_t> resultVersion { 0 };
+
+    /// display dB scale (SpectrumUtil::amp2db squares the magnitude, so power goes in once)
+    static float powerToDB(double power)
+    {
+        if (power < 1e-16) return SpectrumUtil::FLOOR;
+        return juce::jmax(SpectrumUtil::FLOOR, (float)(20.0*log10(power)));
+    }
+
+    int rowOfFrame(juce::int64 frame) const
+    {
+        return (int)juce::jmin((juce::int64)SPECTROGRAMROWS-1, frame*SPECTROGRAMROWS/totalFrames);
+    }
+
+    /// one time segment, accumulates locally and merges once at the end
+    class SegmentJob : public juce::ThreadPoolJob
+    {
+    public:
+        SegmentJob(FileAnalysis& o, std::unique_ptr<juce::AudioFormatReader> r, uint32_t order, juce::int64 firstFrame, juce::int64 endFrame)
+            : juce::ThreadPoolJob("FreqAnalyzer file segment"), owner(o), reader(std::move(r)), fft(order), first(firstFrame), end(endFrame)
+        {
+            numBins = owner.fftSize >> 1;
+        }
+
+        JobStatus runJob() override
+        {
+            const int n = owner.windowSize;
+            const int hop = owner.hop;
+            const int numChannels = juce::jmin(2, (int)reader->numChannels);
+            // a chunk covers FRAMESPERREAD frames, overlapping the next chunk by one window minus a hop
+            const int chunkSamples = (FRAMESPERREAD-1)*hop+n;
+            juce::AudioBuffer<float> chunk(2, chunkSamples);
+
+            for (auto& ch : power) ch.assign(numBins, 0.0);
+            rows.assign((size_t)SPECTROGRAMROWS*numBins, 0.0);
+            rowCounts.assign(SPECTROGRAMROWS, 0);
+            frames.assign((size_t)BatchFFT::LANES, std::vector<float>(owner.fftSize));
+            std::vector<float*> framePtrs(BatchFFT::LANES);
+
+            for (juce::int64 frame=first;frame<end;frame+=FRAMESPERREAD)
+            {
+                if (shouldExit())
+                    return jobHasFinished;
+
+                const int numInChunk = (int)juce::jmin((juce::int64)FRAMESPERREAD, end-frame);
+                reader->read(&chunk, 0, (numInChunk-1)*hop+n, frame*hop, true, numChannels > 1);
+
+                for (int ch=0;ch<2;ch++)
+                {
+                    const float* src = chunk.getReadPointer(numChannels > 1 ? ch : 0);
+                    for (int f=0;f<numInChunk;f+=BatchFFT::LANES)
+                    {
+                        const int numLanes = juce::jmin(BatchFFT::LANES, numInChunk-f);
+                        for (int l=0;l<numLanes;l++)
+                        {
+                            const float* in = src+(size_t)(f+l)*hop;
+                            for (int i=0;i<n;i++)
+                                frames[l][i] = in[i]*owner.window[i];
+                            // the transform overwrites the padding with magnitudes
+                            std::fill(frames[l].begin()+n,frames[l].end(),0.0f);
+                            framePtrs[l] = frames[l].data();
+                        }
+                        fft.performFrequencyOnlyForwardTransform(framePtrs.data(), numLanes);
+
+                        for (int l=0;l<numLanes;l++)
+                        {
+                            const int row = owner.rowOfFrame(frame+f+l);
+                            double* rowPower = rows.data()+(size_t)row*numBins;
+                            for (int b=0;b<numBins;b++)
+                            {
+                                const double p = (double)frames[l][b]*frames[l][b];
+                                power[ch][b] += p;
+                                rowPower[b] += p;
+                            }
+                            rowCounts[row]++;
+                        }
+                    }
+                }
+            }
+
+            merge();
+            return jobHasFinished;
+        }
+
+    private:
+        static constexpr int FRAMESPERREAD = 64;
+
+        FileAnalysis& owner;
+        std::unique_ptr<juce::AudioFormatReader> reader;
+        BatchFFT fft;
+        juce::int64 first;
+        juce::int64 end;
+        int numBins;
+
+        std::vector<std::vector<float>> frames;
+        std::vector<double> power[2];
+        std::vector<double> rows;
+        std::vector<int> rowCounts;
+
+        void merge()
+        {
+            const juce::ScopedLock sl(owner.resultLock);
+            for (int ch=0;ch<2;ch++)
+                for (int b=0;b<numBins;b++)
+                    owner.mergedPower[ch][b] += power[ch][b];
+            for (size_t i=0;i<rows.size();i++)
+                owner.mergedRows[i] += rows[i];
+            for (int r=0;r<SPECTROGRAMROWS;r++)
+                owner.mergedRowCounts[r] += rowCounts[r];
+            owner.framesDone += end-first;
+            owner.resultVersion++;
+        }
+    };
+
+    JUCE_DECLARE_NON_COPYABLE(FileAnalysis)
+};
@@ -14,7 +14,23 @@
 
 #pragma once
 #include "SpectrumUtil.h"
-// all FFT-related objects in this header has fixed order: fftsize = 2048 (2e11)
+#include "TraceLog.h"
+#include "BatchFFT.h"
+#include "SpectrumFrames.h"
+#include "SpectrumCapture.h"
+#include "FileAnalysis.h"
+#include "TraceRasterizer.h"
+#include "OctaveBank.h"
+#include "ZoomFFT.h"
+#include "PinnedTones.h"
+#include "PercentileSpectrum.h"
+#include "StereoScope.h"
+#include "AnalyzerHub.h"
+#include "Weighting.h"
+#include "PeakFinder.h"
+#include "AnalyzerArena.h"
+// FFT order/overlap are compile-time parameters of fftUnit, selected at runtime through makeFftUnit()
+// the defaults below give fftsize = 2048 (2e11)
 // fft :: 2^N sized fft -- 2^11 = 2048, ~23.4fps
 // with 50% zero padding -- 2^10 = 1024, ~ 46.9fps
 // to maintain the same framerate (~23.4fps) i.e. update every 2048 samples
@@ -24,103 +40,858 @@
 // so far the FFTORDER_A is fixed at 11, may be subject to change later
 // code is written as such that sample injection is always capped at 2048, fft calculation is always per 1024 samples
 const uint32_t FFTORDER_A = 11;   // active FFT_ORDER (what is updated every frame) == 11
-static uint32_t FFTORDER_T = 11; // total length of FFT in 2^Order (11,12,13)
+static uint32_t FFTORDER_T = 11; // default total length of FFT in 2^Order (11,12,13)
 const float SR_DEFAULT = 48e3f; // default samplerate for generating display
 
+const uint32_t FFTORDER_MIN = 11;   // smallest selectable total order (2048)
+const uint32_t FFTORDER_MAX = 13;   // largest selectable total order (8192)
+static_assert((1u << FFTORDER_MIN) == CAPTURE_MIN_FFTSIZE && (1u << FFTORDER_MAX) == CAPTURE_MAX_FFTSIZE, "captures are read back at the analyzer's resolutions");
+const uint32_t OVERLAPSHIFT_MAX = 2; // hop = Nyquist size >> shift (0,50,75 % overlap)
+
+/// common interface of the compile-time specialized fft units, so a channel can swap resolution at runtime
+class fftUnitBase
+{
+public:
+    virtual ~fftUnitBase()
+    {
+    }
+    
+    /// inject a block of samples, turn 'pending' to true when a frame is waiting for its transform
+    /// the caller keeps numSamples <= samplesToNextHop() so no frame is overwritten before it is transformed
+    virtual void injectBlock (const float* input, int numSamples) = 0;
+    
+    /// frame to be transformed in place while 'pending'
+    virtual float* getFrame() = 0;
+    
+    /// get size of buffer
+    virtual uint32_t getSizeBuffer() const = 0;
+    
+    virtual uint32_t getSizeNyquist() const = 0;
+    
+    /// samples left until the next hop boundary
+    virtual uint32_t samplesToNextHop() const = 0;
+    
+    /// put the hop phase where it would be after streamPosition samples since prepareToPlay,
+    /// so hops land on the same stream samples however the host chunks its blocks
+    virtual void alignTo(juce::int64 streamPosition) = 0;
+    
+    /// time-domain frame in oBuffer waiting for the transform
+    bool pending = false;
+    /// oBuffer holds a complete spectrum
+    bool ready = false;
+    
+    /// debug identity
+#ifdef DEBUG
+    int iddbgDW = -1;
+    int iddbgLR = -1;
+#endif
+};
+
 /// single data stream fft Unit (one signal channel)
-class fftUnit
+/// collects samples and hands a windowed time-domain frame out every hop, the transform itself is batched by FreqAnalyzer
+/// Order: total fft length 2^Order, OverlapShift: hop is the Nyquist size >> OverlapShift
+template <uint32_t Order, uint32_t OverlapShift>
+class fftUnit : public fftUnitBase
 {
 public:
-    fftUnit()
-    {
-        // initialize juce fft object
-        fftOp.reset(new juce::dsp::FFT(FFTORDER_T));
-        sizeBuffer = (fftOp->getSize());
-        // make two buffers the size of fft buffersize
-        iBuffer.resize(sizeBuffer);
-        oBuffer.resize(sizeBuffer);
-        
-        // Nyquist size is half of total fftsize
-        sizeNyquist = sizeBuffer >> 1;
-        // active size is (1-overlap)% of sizeNyquist (100,50,25 %)
-        sizeStream = sizeNyquist >> MAGDIFF;
-        
+    static constexpr uint32_t sizeBuffer = 1u << Order;
+    // Nyquist size is half of total fftsize
+    static constexpr uint32_t sizeNyquist = sizeBuffer >> 1;
+    // active size is (1-overlap)% of sizeNyquist (100,50,25 %)
+    static constexpr uint32_t sizeStream = sizeNyquist >> OverlapShift;
+    static_assert(sizeStream > 0, "overlap shift too large for this order");
+    
+    /// inputStorage: sizeNyquist floats, frameStorage: sizeBuffer floats, zeroed, in the owner's arena
+    fftUnit(float* inputStorage, float* frameStorage): iBuffer(inputStorage), oBuffer(frameStorage)
+    {
 #ifdef DEBUG
         DBG("fftUnit buffer size is " + juce::String(sizeBuffer));
         DBG("fftUnit Nyquist size is " + juce::String(sizeNyquist));
-        DBG("fftUnit Overlap is " + juce::String((1.0f-1.0f/pow(2.0f,MAGDIFF))*100.0f) + "%");
+        DBG("fftUnit Overlap is " + juce::String((1.0f-1.0f/pow(2.0f,OverlapShift))*100.0f) + "%");
         DBG("fftUnit Active Stream size is " + juce::String(sizeStream));
 #endif
     }
     
-    ~fftUnit()
+    ~fftUnit() override
     {
     }
-        
-    /// inject a single sample to this fft unit, turn 'ready' to true if this unit is ready to show its complete spectrum
-    void injectSample (float input)
+    
+    void injectBlock (const float* input, int numSamples) override
     {
-        iBuffer[iterNyquistCounter] = input;
-        iterNyquistCounter++;
-        iterActiveCounter++;
-        
-        if ( !(iterActiveCounter<sizeStream) )
-        {
-            // reset active fft counter - overlap dependent
-            iterActiveCounter = 0;
-            // copy i to o ###NEED UPDATE TO REFLECT CORRECT TIME SERIES
-            std::copy(iBuffer.begin(),iBuffer.end(),oBuffer.begin());
-            // calculate o
-            // EVERY 1024
-            fftOp->performFrequencyOnlyForwardTransform(&(oBuffer[0]));
-            if (!ready) ready = true;
+        while (numSamples > 0)
+        {
+            // contiguous run up to whichever comes first: end of block, Nyquist wrap, hop boundary
+            const uint32_t numRun = std::min({ (uint32_t)numSamples, sizeNyquist-iterNyquistCounter, sizeStream-iterActiveCounter });
+            std::copy(input, input+numRun, iBuffer+iterNyquistCounter);
+            iterNyquistCounter += numRun;
+            iterActiveCounter += numRun;
+            input += numRun;
+            numSamples -= (int)numRun;
+            
+            if ( !(iterNyquistCounter<sizeNyquist) )
+            {
+                // reset Nyquist fft iterator - zero-padding dependent
+                iterNyquistCounter = 0;
+            }
+            
+            if ( !(iterActiveCounter<sizeStream) )
+            {
+                FA_TRACE_SCOPE("fftUnit hop");
+                // reset active fft counter - overlap dependent
+                iterActiveCounter = 0;
+                snapshot();
+                // o is transformed in place by the owner's BatchFFT
+                if (!pending) pending = true;
 #ifdef DEBUG
-            else DBG("queue stalled for fftUnit D/W: " + juce::String(iddbgDW) + " L/R: " + juce::String(iddbgLR));
+                else DBG("transform stalled for fftUnit D/W: " + juce::String(iddbgDW) + " L/R: " + juce::String(iddbgLR));
 #endif
+            }
         }
+    }
+    
+    float* getFrame() override { return oBuffer; }
+    
+    uint32_t getSizeBuffer() const override { return sizeBuffer; }
+    
+    uint32_t getSizeNyquist() const override { return sizeNyquist; }
+    
+    uint32_t samplesToNextHop() const override { return sizeStream-iterActiveCounter; }
+    
+    void alignTo(juce::int64 streamPosition) override
+    {
+        iterActiveCounter = (uint32_t)(streamPosition % sizeStream);
+        iterNyquistCounter = (uint32_t)(streamPosition % sizeNyquist);
+        pending = false;
+        ready = false;
+    }
+    
+private:
+    /// I/O Buffer, input is a circular buffer over the first (Nyquist) half, the rest is zero padding
+    /// both cache line aligned in the AnalysisStorage arena, not owned
+    float* iBuffer;
+    float* oBuffer;
+    
+    /// iteration related parameter
+    uint32_t iterNyquistCounter = 0;
+    uint32_t iterActiveCounter = 0;
+    
+    /// unroll the circular input into time order (oldest sample first) with the window applied, zero the padding
+    void snapshot()
+    {
+        const auto& window = SpectrumUtil::hannWindow<sizeNyquist>;
+        const uint32_t oldest = iterNyquistCounter;
+        const uint32_t numTail = sizeNyquist-oldest;
+        for (uint32_t i=0;i<numTail;i++)
+            oBuffer[i] = iBuffer[oldest+i]*window[i];
+        for (uint32_t i=0;i<oldest;i++)
+            oBuffer[numTail+i] = iBuffer[i]*window[numTail+i];
+        std::fill(oBuffer+sizeNyquist,oBuffer+sizeBuffer,0.0f);
+    }
+    
+};  // fftUnit class brackets
+
+template <uint32_t Order, uint32_t OverlapShift>
+std::unique_ptr<fftUnitBase> createFftUnit(float* inputStorage, float* frameStorage)
+{
+    return std::make_unique<fftUnit<Order,OverlapShift>>(inputStorage, frameStorage);
+}
+
+/// runtime dispatch to the fftUnit specialization for an order/overlap combination
+/// order FFTORDER_MIN..FFTORDER_MAX, overlapShift 0..OVERLAPSHIFT_MAX,
+/// the unit's buffers (2^(order-1) and 2^order floats) are the caller's
+inline std::unique_ptr<fftUnitBase> makeFftUnit(uint32_t order, uint32_t overlapShift, float* inputStorage, float* frameStorage)
+{
+    using Factory = std::unique_ptr<fftUnitBase> (*)(float*, float*);
+    
+    static constexpr Factory table[FFTORDER_MAX-FFTORDER_MIN+1][OVERLAPSHIFT_MAX+1] =
+    {
+        { &createFftUnit<11,0>, &createFftUnit<11,1>, &createFftUnit<11,2> },
+        { &createFftUnit<12,0>, &createFftUnit<12,1>, &createFftUnit<12,2> },
+        { &createFftUnit<13,0>, &createFftUnit<13,1>, &createFftUnit<13,2> },
+    };
+    
+    order = juce::jlimit(FFTORDER_MIN, FFTORDER_MAX, order);
+    overlapShift = juce::jmin(overlapShift, OVERLAPSHIFT_MAX);
+    return table[order-FFTORDER_MIN][overlapShift](inputStorage, frameStorage);
+}
+
+/// everything the engine allocates for one resolution: the input rings and frames of the four fft units and
+/// the RTA per-bin buffers in one AnalyzerArena, the units themselves and the batch transform.
+/// built away from the audio thread, then swapped into the engine whole while it is detached
+class AnalysisStorage
+{
+public:
+    /// frames the engine's history keeps at FFTORDER_T, ~2 s at 50% overlap
+    static constexpr uint32_t HISTORYFRAMES = 192;
+    /// frames queued for the views and the capture, or being filled
+    static constexpr uint32_t FRAMESINFLIGHT = 64;
+    
+    /// history frames at an fft order, as many more at smaller sizes as their frames are smaller
+    static uint32_t getHistoryFrames(uint32_t order) { return (HISTORYFRAMES << FFTORDER_T) >> order; }
+    
+    AnalysisStorage(uint32_t newOrder, uint32_t newOverlapShift)
+        : order(juce::jlimit(FFTORDER_MIN, FFTORDER_MAX, newOrder)), overlapShift(juce::jmin(newOverlapShift, OVERLAPSHIFT_MAX)),
+          batchFFT(order), frames(std::make_unique<SpectrumFrameSet>(FRAMESINFLIGHT+getHistoryFrames(order), 1u << (order-1)))
+    {
+        static const char* const inputNames[2][2] = { { "fft input L dry", "fft input L wet" }, { "fft input R dry", "fft input R wet" } };
+        static const char* const frameNames[2][2] = { { "fft frame L dry", "fft frame L wet" }, { "fft frame R dry", "fft frame R wet" } };
+        const size_t sizeBuffer = (size_t)1 << order;
+        const size_t sizeNyquist = sizeBuffer >> 1;
         
-        if ( !(iterNyquistCounter<sizeNyquist) )
+        size_t inputAt[2][2], frameAt[2][2];
+        for (int leftright=0;leftright<2;leftright++)
         {
-            // reset Nyquist fft iterator - zero-padding dependent
-            // EVERY 2048
-            iterNyquistCounter = 0;
+            for (int drywet=0;drywet<2;drywet++)
+            {
+                inputAt[leftright][drywet] = arena.reserve<float>(inputNames[leftright][drywet], sizeNyquist);
+                frameAt[leftright][drywet] = arena.reserve<float>(frameNames[leftright][drywet], sizeBuffer);
+            }
         }
+        const size_t rtaLevelsAt[2] = { arena.reserve<float>("rta levels dry", sizeNyquist), arena.reserve<float>("rta levels wet", sizeNyquist) };
+        const size_t rtaBandOfBinAt = arena.reserve<int>("rta band of bin", sizeNyquist);
+        arena.allocate();
+        
+        for (int leftright=0;leftright<2;leftright++)
+            for (int drywet=0;drywet<2;drywet++)
+                units[leftright][drywet] = makeFftUnit(order, overlapShift,
+                                                       arena.place<float>(inputAt[leftright][drywet], sizeNyquist).data(),
+                                                       arena.place<float>(frameAt[leftright][drywet], sizeBuffer).data());
+        for (int drywet=0;drywet<2;drywet++)
+            rtaLevels[drywet] = arena.place<float>(rtaLevelsAt[drywet], sizeNyquist);
+        rtaBandOfBin = arena.place<int>(rtaBandOfBinAt, sizeNyquist);
+    }
+    ~AnalysisStorage()
+    {
     }
     
-    std::vector<float> getBuffer() const { return oBuffer; }
+    uint32_t getOrder() const { return order; }
+    uint32_t getOverlapShift() const { return overlapShift; }
+    fftUnitBase* getUnit(uint32_t leftright, uint32_t drywet) const { return units[leftright][drywet].get(); }
+    BatchFFT& getBatchFFT() { return batchFFT; }
+    /// per-bin RTA levels of the channel being published, and the band each bin is drawn from (-1 for none)
+    const ArenaArray<float>& getRTALevels(uint32_t drywet) const { return rtaLevels[drywet]; }
+    const ArenaArray<int>& getRTABandOfBin() const { return rtaBandOfBin; }
+    /// published frames sized for this resolution, handed to the engine's frame pool when it is swapped in
+    std::unique_ptr<SpectrumFrameSet> takeFrames()
+    {
+        jassert(frames != nullptr);
+        return std::move(frames);
+    }
     
-    /// get size of buffer
-    uint32_t getSizeBuffer() const { return sizeBuffer; }
+    size_t getMemoryBytes() const { return arena.getTotalBytes()+batchFFT.getMemoryBytes(); }
+    juce::String getMemoryReport() const
+    {
+        return arena.getReport() + "\nbatch fft tables: " + juce::String((juce::int64)batchFFT.getMemoryBytes()) + " B";
+    }
     
-    uint32_t getSizeNyquist() const { return sizeNyquist; }
+private:
+    uint32_t order;
+    uint32_t overlapShift;
+    AnalyzerArena arena;
+    std::unique_ptr<fftUnitBase> units[2][2];
+    BatchFFT batchFFT;
+    ArenaArray<float> rtaLevels[2];
+    ArenaArray<int> rtaBandOfBin;
+    std::unique_ptr<SpectrumFrameSet> frames;
     
-    bool ready = false;
+    JUCE_DECLARE_NON_COPYABLE(AnalysisStorage)
+};
+
+/// analysis side of one channel, dry and wet fft units, owned by the AnalysisEngine
+class ChannelAnalysis
+{
+public:
+    ChannelAnalysis(uint32_t chan): chanid(chan)
+    {
+    }
+    ~ChannelAnalysis()
+    {
+    }
     
-    /// debug identity
+    /// use the fft units of a new AnalysisStorage, message thread only while detached from the audio thread
+    void setUnits(fftUnitBase* newDryUnit, fftUnitBase* newWetUnit)
+    {
+        dryUnit = newDryUnit;
+        wetUnit = newWetUnit;
 #ifdef DEBUG
-    int iddbgDW = -1;
-    int iddbgLR = -1;
+        dryUnit->iddbgDW = 0;
+        wetUnit->iddbgDW = 1;
+        dryUnit->iddbgLR = (int)chanid;
+        wetUnit->iddbgLR = (int)chanid;
 #endif
+    }
+    
+    void injectBlockTo (const float* input, int numSamples, uint32_t drywet)
+    {
+        switch(drywet){
+            case 0:
+                dryUnit->injectBlock( input, numSamples );
+                break;
+            case 1:
+                wetUnit->injectBlock( input, numSamples );
+                break;
+        }
+    
+    }
+    
+    /// audio thread: add the frames waiting for a transform to the batch, returns the new batch size
+    int collectPending(float** frames, fftUnitBase** units, int numCollected)
+    {
+        for (auto* unit : { dryUnit, wetUnit })
+        {
+            if (unit->pending)
+            {
+                frames[numCollected] = unit->getFrame();
+                units[numCollected] = unit;
+                numCollected++;
+            }
+        }
+        return numCollected;
+    }
+    
+    /// audio thread: publish once both dry and wet spectra are complete
+    void publishIfReady(SpectrumPublisher& publisher, uint32_t frameIndex)
+    {
+        if (dryUnit->ready && wetUnit->ready)
+        {
+            publishFrame(publisher, dryUnit->getFrame(), wetUnit->getFrame(), frameIndex, false);
+            // un-ready the units
+            dryUnit->ready = false;
+            wetUnit->ready = false;
+        }
+    }
+    
+    /// audio or zoom thread: publish magnitudes computed elsewhere (RTA band levels spread over the bins,
+    /// zoom band bins), at least getSizeNyquist() floats each, as a frame like an fft frame
+    void publishLevels(const float* dryMag, const float* wetMag, SpectrumPublisher& publisher, uint32_t frameIndex, bool zoomed)
+    {
+        publishFrame(publisher, dryMag, wetMag, frameIndex, zoomed);
+    }
+    
+    uint32_t samplesToNextHop() const { return dryUnit->samplesToNextHop(); }
+    
+    void alignTo(juce::int64 streamPosition)
+    {
+        dryUnit->alignTo(streamPosition);
+        wetUnit->alignTo(streamPosition);
+    }
     
 private:
-    /// Overlap related
-    uint32_t MAGDIFF = FFTORDER_T-FFTORDER_A;
-    /// I/O Buffer
-    std::vector<float> iBuffer;
-    std::vector<float> oBuffer;
+    // chan-id
+    uint32_t chanid;
     
-    /// iteration related parameter
-    uint32_t iterNyquistCounter = 0;
-    uint32_t iterActiveCounter = 0;
+    // dry and wet fft units, owned by the engine's AnalysisStorage
+    fftUnitBase* dryUnit = nullptr;
+    fftUnitBase* wetUnit = nullptr;
     
-    uint32_t sizeBuffer;
-    uint32_t sizeNyquist;
-    uint32_t sizeStream;
+    /// producer thread: copy the Nyquist bins into a pooled frame and hand it to every consumer,
+    /// never blocks or allocates - skipped if the pool has run dry
+    void publishFrame(SpectrumPublisher& publisher, const float* dryMag, const float* wetMag, uint32_t frameIndex, bool zoomed)
+    {
+        FA_TRACE_SCOPE("spectrum publish");
+        const SpectrumFrameRef ref = publisher.getPool().acquire();
+        auto* frame = ref.getForWriting();
+        if (frame == nullptr)
+            return;
+        frame->frameIndex = frameIndex;
+        frame->channel = chanid;
+        frame->fftSize = dryUnit->getSizeBuffer();
+        frame->numBins = juce::jmin(dryUnit->getSizeNyquist(), frame->getCapacity());
+        frame->zoomed = zoomed;
+        std::copy(dryMag, dryMag+frame->numBins, frame->getWritePointer(0));
+        std::copy(wetMag, wetMag+frame->numBins, frame->getWritePointer(1));
+        publisher.publish(ref);
+    }
     
-    /// base unit
-    std::unique_ptr<juce::dsp::FFT> fftOp;
+    JUCE_DECLARE_NON_COPYABLE(ChannelAnalysis)
+};
+
+/// everything that turns the audio into published frames, owned by the processor so it outlives editors:
+/// fft units, the RTA, zoom and pinned tone banks, the stereo scope, a short history of recent frames
+/// and the long-term percentiles. views (FreqAnalyzer) subscribe to its publisher and read its settings,
+/// they never own analysis state
+class AnalysisEngine
+{
+public:
+    /// framePool: where published frames come from, declared before the engine by its owner,
+    /// given frames sized for every resolution the engine switches to
+    AnalysisEngine(SpectrumFramePool& framePool): publisher(framePool), history(AnalysisStorage::getHistoryFrames(FFTORDER_MIN))
+    {
+        publisher.addConsumer(&history);
+        publisher.addConsumer(&percentiles);
+        setResolution(FFTORDER_T, FFTORDER_T-FFTORDER_A);
+    }
+    ~AnalysisEngine()
+    {
+        // the zoom thread publishes through the channels, stop it first
+        zoomEngine.reset();
+    }
     
-};  // fftUnit class brackets
+    /// samples the caller may inject before the fft units hit their next hop
+    int samplesToNextHop() const
+    {
+        // the zoom thread frames on its own, any chunk length will do
+        if (zoomEngine != nullptr)
+            return std::numeric_limits<int>::max();
+        if (rtaBandsPerOctave > 0)
+            return (int)(getHopSize()-rtaCounter);
+        if (!analyzeRight)
+            return (int)channels[0].samplesToNextHop();
+        return (int)juce::jmin(channels[0].samplesToNextHop(),channels[1].samplesToNextHop());
+    }
+    
+    /// true after a rebuild, until the audio thread has called alignTo()
+    bool needsAlignment() const { return !aligned; }
+    
+    /// audio thread, before the first injection after a rebuild: align hops, frame indices and
+    /// the reduced-rate hop selection to the stream position, so they do not depend on block sizes
+    /// or on when the engine was attached
+    void alignTo(juce::int64 streamPosition)
+    {
+        for (auto& channel : channels)
+            channel.alignTo(streamPosition);
+        const juce::int64 hop = (juce::int64)getHopSize();
+        rtaCounter = (uint32_t)(streamPosition % hop);
+        hopCount = (uint32_t)(streamPosition/hop);
+        frameCount = (uint32_t)(streamPosition/hop);
+        aligned = true;
+    }
+    
+    /// transform every frame that reached its hop in one batch, then publish complete channels
+    /// called by the audio thread at the end of each chunk ending on a hop boundary
+    void transformPending()
+    {
+        if (zoomEngine != nullptr)
+            return;
+        if (rtaBandsPerOctave > 0)
+        {
+            if (rtaCounter >= getHopSize())
+            {
+                rtaCounter = 0;
+                publishBands();
+            }
+            return;
+        }
+    
+        int numFrames = channels[0].collectPending(pendingFrames, pendingUnits, 0);
+        numFrames = channels[1].collectPending(pendingFrames, pendingUnits, numFrames);
+        if (numFrames == 0)
+            return;
+    
+        // reduced frame rate: drop the frames of the hops in between
+        if (frameDivider > 1 && (++hopCount % frameDivider) != 0)
+        {
+            for (int i=0;i<numFrames;i++)
+                pendingUnits[i]->pending = false;
+            return;
+        }
+    
+        {
+            FA_TRACE_SCOPE("batch fft");
+            storage->getBatchFFT().performFrequencyOnlyForwardTransform(pendingFrames, numFrames);
+        }
+        for (int i=0;i<numFrames;i++)
+        {
+            pendingUnits[i]->pending = false;
+            pendingUnits[i]->ready = true;
+        }
+    
+        channels[0].publishIfReady(publisher, frameCount);
+        channels[1].publishIfReady(publisher, frameCount);
+        frameCount++;
+    }
+    
+    /// input a block of samples to specified channel and dry/wet configuration
+    void injectBlockToTo(const float* input, int numSamples, uint32_t leftright, uint32_t drywet)
+    {
+        // pinned tones follow every sample whatever the analysis mode
+        if (pinnedFrequencies.size() > 0 && (leftright == 0 || analyzeRight))
+            pinnedBanks[leftright][drywet].processBlock(input,numSamples);
+    
+        if (zoomEngine != nullptr)
+        {
+            if (leftright == 0 || analyzeRight)
+                zoomEngine->push(leftright,drywet,input,numSamples);
+            return;
+        }
+        if (rtaBandsPerOctave > 0)
+        {
+            if (leftright == 0 || analyzeRight)
+                rtaBanks[leftright][drywet]->processBlock(input,numSamples);
+            // every stream sees the same chunks, count them once
+            if (leftright == 0 && drywet == 0)
+                rtaCounter += (uint32_t)numSamples;
+            return;
+        }
+    
+        if (leftright == 0 || analyzeRight)
+            channels[leftright].injectBlockTo(input,numSamples,drywet);
+    }
+    
+    /// input a block of the stereo output for correlation, balance and the goniometer
+    template <typename SampleType>
+    void injectStereo(const SampleType* left, const SampleType* right, int numSamples)
+    {
+        if (stereoScopeOn)
+            stereoScope.processBlock(left,right,numSamples);
+    }
+    
+    /// the following setters are message thread only, the caller must have detached the engine from the audio thread
+    
+    /// a consumer of every published frame (a view's channels, a capture), see SpectrumPublisher
+    /// the zoom thread publishes on its own, it is paused while the consumers change
+    void addConsumer(SpectrumFrameConsumer* consumer)
+    {
+        whileZoomPaused([&] { publisher.addConsumer(consumer); });
+    }
+    void removeConsumer(SpectrumFrameConsumer* consumer)
+    {
+        whileZoomPaused([&] { publisher.removeConsumer(consumer); });
+    }
+    
+    /// frames are also published to this capture, nullptr for none
+    void setCapture(SpectrumCapture* newCapture)
+    {
+        if (capture != nullptr)
+            removeConsumer(capture);
+        capture = newCapture;
+        if (capture != nullptr)
+            addConsumer(capture);
+    }
+    
+    /// switch to storage built for another fft order and overlap shift, only the pointers change hands here
+    /// returns the storage it replaces, for the caller to free once the engine is attached again
+    std::unique_ptr<AnalysisStorage> setResolution(std::unique_ptr<AnalysisStorage> newStorage)
+    {
+        // the zoom thread publishes through the channels being rebuilt
+        zoomEngine.reset();
+        std::swap(storage, newStorage);
+        for (uint32_t leftright=0;leftright<2;leftright++)
+            channels[leftright].setUnits(storage->getUnit(leftright,0), storage->getUnit(leftright,1));
+        currentOrder = storage->getOrder();
+        currentOverlapShift = storage->getOverlapShift();
+        // frames sized for this resolution, the old ones are freed once the views and the capture are done with them
+        publisher.getPool().setFrames(storage->takeFrames());
+        // frames of the old resolution are of no use to a view any more, nor are statistics of other bins
+        history.setCapacity(AnalysisStorage::getHistoryFrames(currentOrder));
+        percentiles.setNumBins(1 << (currentOrder-1));
+        rebuildBands();
+        startZoom();
+        aligned = false;
+        DBG("analysis storage " + juce::String((juce::int64)storage->getMemoryBytes()) + " B");
+        return newStorage;
+    }
+    
+    /// switch fft order (FFTORDER_MIN..FFTORDER_MAX) and overlap shift (0..OVERLAPSHIFT_MAX), allocating here
+    void setResolution(uint32_t order, uint32_t overlapShift)
+    {
+        setResolution(std::make_unique<AnalysisStorage>(order, overlapShift));
+    }
+    
+    /// zoom into fLow..fHigh Hz (at least ZOOMMINSPAN wide), fHigh <= fLow for the normal display
+    /// analysis moves to a background thread, the audio thread only queues samples
+    void setZoom(float fLow, float fHigh, double sampleRateHz)
+    {
+        zoomEngine.reset();
+        // the recent frames are on the old axis
+        history.clear();
+        zoomLow = fLow;
+        zoomHigh = fHigh > fLow ? juce::jmax(fHigh, fLow+ZOOMMINSPAN) : fHigh;
+        zoomSampleRate = sampleRateHz;
+        startZoom();
+    }
+    
+    /// stereo correlation, balance and goniometer of the output
+    void setStereoScope(bool shouldRun, double sampleRateHz)
+    {
+        stereoScopeOn = shouldRun;
+        stereoScopeSampleRate = sampleRateHz;
+        stereoScope.prepare(sampleRateHz);
+    }
+    
+    /// track up to PinnedToneBank::MAXPINNED frequencies (Hz) sample by sample
+    void setPinned(const std::vector<float>& frequencies, double sampleRateHz)
+    {
+        // kept as asked for, a later rate may track what this one cannot
+        pinnedRequested = frequencies;
+        pinnedSampleRate = sampleRateHz;
+        for (auto& channel : pinnedBanks)
+            for (auto& bank : channel)
+                bank.configure(frequencies, pinnedSampleRate, PINNEDWINDOW_S);
+        // the banks drop what they cannot track, keep the same list here
+        const auto& bank = pinnedBanks[0][0];
+        pinnedFrequencies.resize(bank.getNumPinned());
+        for (int pin=0;pin<bank.getNumPinned();pin++)
+            pinnedFrequencies[pin] = bank.getFrequency(pin);
+    }
+    
+    /// fractional-octave RTA instead of the fft units: bandsPerOctave 3 or 6, 0 back to fft
+    /// band levels are published once per hop of the current resolution and drawn over the bins they cover
+    void setRTA(int bandsPerOctave, double sampleRateHz)
+    {
+        rtaBandsPerOctave = bandsPerOctave;
+        rtaSampleRate = sampleRateHz;
+        rebuildBands();
+        percentiles.restart();
+        aligned = false;
+    }
+    
+    /// the processor was prepared at another rate: rebuild the pinned tones, RTA bands, zoom and stereo scope
+    /// that are running for it, the others take the rate when they are next set
+    void setSampleRate(double sampleRateHz)
+    {
+        if (!pinnedRequested.empty() && pinnedSampleRate != sampleRateHz)
+            setPinned(pinnedRequested, sampleRateHz);
+        if (rtaBandsPerOctave > 0 && rtaSampleRate != sampleRateHz)
+            setRTA(rtaBandsPerOctave, sampleRateHz);
+        if (isZoomed() && zoomSampleRate != sampleRateHz)
+            setZoom(zoomLow, zoomHigh, sampleRateHz);
+        if (stereoScopeOn && stereoScopeSampleRate != sampleRateHz)
+            setStereoScope(true, sampleRateHz);
+        sampleRate = sampleRateHz;
+    }
+    
+    /// long-term percentiles of the dry spectrum over the last windowSeconds, 0 for off
+    /// the statistics start from the history, and run on whether or not a view is open
+    void setPercentileWindow(double windowSeconds)
+    {
+        whileZoomPaused([&]
+        {
+            percentiles.setWindow(windowSeconds);
+            if (windowSeconds > 0.0)
+                history.replayTo(percentiles);
+        });
+    }
+    
+    /// lighter analysis under CPU pressure: transform every frameDivider-th hop, optionally skip the right channel
+    /// newStorage, built beforehand, is switched to as setResolution() does, nullptr to keep the current storage;
+    /// it is needed when analyzeRight changes, both channels restart on it so left and right hit their hops together again
+    /// returns the storage it replaces, for the caller to free once the engine is attached again
+    std::unique_ptr<AnalysisStorage> setReducedLoad(int newFrameDivider, bool newAnalyzeRight, std::unique_ptr<AnalysisStorage> newStorage)
+    {
+        jassert(newStorage != nullptr || newAnalyzeRight == analyzeRight);
+        frameDivider = juce::jmax(1, newFrameDivider);
+        analyzeRight = newAnalyzeRight;
+        aligned = false;
+        if (newStorage == nullptr)
+            return {};
+        return setResolution(std::move(newStorage));
+    }
+    
+    /// while detached: offer the recent frames, oldest first, to a view that has just subscribed
+    void replayHistory(SpectrumFrameConsumer& consumer) const { whileZoomPaused([&] { history.replayTo(consumer); }); }
+    /// while detached: drop the recent frames, when they are older than the view opening on them would suggest
+    void clearHistory() { whileZoomPaused([&] { history.clear(); }); }
+    
+    /// settings, read by views to lay out their display
+    double getSampleRate() const { return sampleRate; }
+    uint32_t getOrder() const { return currentOrder; }
+    uint32_t getOverlapShift() const { return currentOverlapShift; }
+    int getFrameDivider() const { return frameDivider; }
+    bool isAnalyzingRight() const { return analyzeRight; }
+    int getRTABandsPerOctave() const { return rtaBandsPerOctave; }
+    bool isZoomed() const { return zoomHigh > zoomLow; }
+    float getZoomLow() const { return zoomLow; }
+    float getZoomHigh() const { return zoomHigh; }
+    bool isStereoScopeOn() const { return stereoScopeOn; }
+    double getPercentileWindow() const { return percentiles.getWindow(); }
+    const std::vector<float>& getPinnedFrequencies() const { return pinnedFrequencies; }
+    double getPinnedSampleRate() const { return pinnedSampleRate; }
+    
+    /// any thread: latest amplitude of a pinned tone, on the sliding dft's scale
+    float getPinnedAmplitude(uint32_t leftright, uint32_t drywet, int pin) const { return pinnedBanks[leftright][drywet].getAmplitude(pin); }
+    
+    /// correlation and balance are read from any thread, the goniometer image rendered on the message thread
+    StereoScope& getStereoScope() { return stereoScope; }
+    
+    /// message thread: the statistics are collected and read by whoever is showing them, or by the owner
+    PercentileSpectrum& getPercentiles() { return percentiles; }
+    
+    /// bytes of everything the engine holds: the current resolution's storage, percentile statistics, history,
+    /// RTA, zoom, pinned tone banks and stereo scope, and the buffer by buffer breakdown
+    size_t getMemoryBytes() const
+    {
+        return storage->getMemoryBytes()+percentiles.getMemoryBytes()+history.getMemoryBytes()
+            +getRtaBytes()+getZoomBytes()+getPinnedBytes()+stereoScope.getMemoryBytes();
+    }
+    juce::String getMemoryReport() const
+    {
+        const auto line = [](const char* name, size_t bytes) { return "\n" + juce::String(name) + ": " + juce::String((juce::int64)bytes) + " B"; };
+        return storage->getMemoryReport()
+            + line("percentile statistics", percentiles.getMemoryBytes())
+            + line("frame history", history.getMemoryBytes())
+            + line("rta banks", getRtaBytes())
+            + line("zoom", getZoomBytes())
+            + line("pinned tone banks", getPinnedBytes())
+            + line("stereo scope", stereoScope.getMemoryBytes())
+            + line("engine total", getMemoryBytes());
+    }
+    
+private:
+    /// narrowest zoom band, keeps the decimating low-pass within its tap limit
+    static constexpr float ZOOMMINSPAN = 5.0f;
+    /// sliding window of the pinned tones, ~20 Hz resolution for ~50 ms of latency
+    static constexpr double PINNEDWINDOW_S = 0.05;
+    
+    /// (re)start the zoom thread for the current band and resolution, if zoomed
+    void startZoom()
+    {
+        if (zoomHigh <= zoomLow)
+            return;
+        const int numBins = 1 << (currentOrder-1);
+        // frames are published like fft frames, marked as zoomed (the capture format has no zoom axis and skips them)
+        // their indices carry on from the previous zoom session, so the frames of a view's history stay in order
+        const uint32_t firstFrame = zoomFrameEnd;
+        zoomEngine.reset(new ZoomEngine(zoomSampleRate, zoomLow, zoomHigh, numBins, numBins*2,
+                                        [this, firstFrame] (uint32_t leftright, uint32_t frameNumber, const float* dry, const float* wet)
+        {
+            const uint32_t frameIndex = firstFrame+frameNumber;
+            if (leftright == 0 || analyzeRight)
+                channels[leftright].publishLevels(dry, wet, publisher, frameIndex, true);
+            zoomFrameEnd = juce::jmax(zoomFrameEnd, frameIndex+1);
+        }));
+    }
+    
+    /// run change with the zoom thread held between drains, for what its frames reach (consumers, history)
+    template <typename Change>
+    void whileZoomPaused(Change&& change) const
+    {
+        if (zoomEngine != nullptr)
+            zoomEngine->pause();
+        change();
+        if (zoomEngine != nullptr)
+            zoomEngine->resume();
+    }
+    
+    uint32_t getHopSize() const { return (1u << (currentOrder-1)) >> currentOverlapShift; }
+    
+    /// (re)build the RTA banks and the bin -> band map for the current resolution
+    void rebuildBands()
+    {
+        if (rtaBandsPerOctave <= 0)
+        {
+            for (auto& channel : rtaBanks)
+                for (auto& bank : channel)
+                    bank.reset();
+            return;
+        }
+    
+        for (auto& channel : rtaBanks)
+            for (auto& bank : channel)
+                bank.reset(new OctaveBank(rtaBandsPerOctave, rtaSampleRate));
+    
+        const int sizeBuffer = 1 << currentOrder;
+        const auto& bank = *rtaBanks[0][0];
+        const auto& rtaBandOfBin = storage->getRTABandOfBin();
+        std::fill(rtaBandOfBin.begin(), rtaBandOfBin.end(), -1);
+        for (int bin=0, band=0;bin<(int)rtaBandOfBin.size();bin++)
+        {
+            const float f = (float)(bin*rtaSampleRate/sizeBuffer);
+            while (band < bank.getNumBands() && f >= bank.getUpperEdge(band))
+                band++;
+            if (band < bank.getNumBands() && f >= bank.getLowerEdge(band))
+                rtaBandOfBin[bin] = band;
+        }
+        for (uint32_t drywet=0;drywet<2;drywet++)
+            std::fill(storage->getRTALevels(drywet).begin(), storage->getRTALevels(drywet).end(), 0.0f);
+        rtaCounter = 0;
+    }
+    
+    /// audio thread: spread band levels over their bins and publish them like an fft frame
+    void publishBands()
+    {
+        FA_TRACE_SCOPE("rta publish");
+        // a full scale sine reads the same as its fft peak bin (Hann x2 over the Nyquist size)
+        const float scale = (float)(getHopSize() << currentOverlapShift)/juce::MathConstants<float>::sqrt2;
+        const auto& rtaBandOfBin = storage->getRTABandOfBin();
+        for (uint32_t leftright=0;leftright<(analyzeRight ? 2u : 1u);leftright++)
+        {
+            for (uint32_t drywet=0;drywet<2;drywet++)
+            {
+                const auto& bank = *rtaBanks[leftright][drywet];
+                const auto& levels = storage->getRTALevels(drywet);
+                for (size_t bin=0;bin<rtaBandOfBin.size();bin++)
+                    levels[bin] = rtaBandOfBin[bin] < 0 ? 0.0f : bank.getRMS(rtaBandOfBin[bin])*scale;
+            }
+            channels[leftright].publishLevels(storage->getRTALevels(0).data(), storage->getRTALevels(1).data(), publisher, frameCount, false);
+        }
+        frameCount++;
+    }
+    
+    /// fan-out of the channels' frames to the history, the percentiles, views and the capture
+    SpectrumPublisher publisher;
+    SpectrumFrameHistory history;
+    PercentileSpectrum percentiles;
+    
+    /// left and right dry/wet fft units
+    ChannelAnalysis channels[2] = { ChannelAnalysis(0), ChannelAnalysis(1) };
+    
+    /// the fft units, their one batch transform and the RTA buffers of the current resolution, replaced whole
+    std::unique_ptr<AnalysisStorage> storage;
+    float* pendingFrames[4];
+    fftUnitBase* pendingUnits[4];
+    
+    /// current resolution and load reductions
+    uint32_t currentOrder = FFTORDER_T;
+    uint32_t currentOverlapShift = FFTORDER_T-FFTORDER_A;
+    int frameDivider = 1;
+    uint32_t hopCount = 0;
+    bool analyzeRight = true;
+    bool aligned = false;
+    
+    /// disk capture of published frames, subscribed to the publisher
+    SpectrumCapture* capture = nullptr;
+    uint32_t frameCount = 0;
+    
+    /// RTA mode, [left/right][dry/wet] banks, their per-bin buffers are in the storage
+    int rtaBandsPerOctave = 0;
+    double rtaSampleRate = SR_DEFAULT;
+    std::unique_ptr<OctaveBank> rtaBanks[2][2];
+    uint32_t rtaCounter = 0;
+    
+    /// zoom band and its background analysis, declared after the channels so it is destroyed before them
+    float zoomLow = 0.0f;
+    float zoomHigh = 0.0f;
+    double zoomSampleRate = SR_DEFAULT;
+    /// one past the last zoom frame index, written by the zoom thread, read when it is stopped
+    uint32_t zoomFrameEnd = 0;
+    std::unique_ptr<ZoomEngine> zoomEngine;
+    
+    /// rate the processor was last prepared at, the settings below keep the rate they were built for
+    double sampleRate = SR_DEFAULT;
+    
+    /// pinned tones, [left/right][dry/wet] banks, and the frequencies asked for
+    std::vector<float> pinnedRequested;
+    std::vector<float> pinnedFrequencies;
+    double pinnedSampleRate = SR_DEFAULT;
+    PinnedToneBank pinnedBanks[2][2];
+    
+    /// stereo diagnostics of the output
+    bool stereoScopeOn = false;
+    double stereoScopeSampleRate = SR_DEFAULT;
+    StereoScope stereoScope;
+    
+    size_t getRtaBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& banks : rtaBanks)
+            for (const auto& bank : banks)
+                if (bank != nullptr)
+                    bytes += bank->getMemoryBytes();
+        return bytes;
+    }
+    size_t getZoomBytes() const { return zoomEngine != nullptr ? zoomEngine->getMemoryBytes() : 0; }
+    size_t getPinnedBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& banks : pinnedBanks)
+            for (const auto& bank : banks)
+                bytes += bank.getMemoryBytes();
+        return bytes;
+    }
+    
+    JUCE_DECLARE_NON_COPYABLE(AnalysisEngine)
+};
 
 /// Aux class for making a log2 x-axis of frequency
 class FreqScale4Display
@@ -128,9 +899,7 @@ class FreqScale4Display
 public:
     FreqScale4Display()
     {
-        fSize = pow(2,FFTORDER_T-1);
-        freqAxis.resize(fSize);
-        remapFreq();
+        setNumBins(pow(2,FFTORDER_T-1));
     }
     ~FreqScale4Display()
     {
@@ -138,11 +907,28 @@ public:
     
     void changeSR(float sr)
     {
-        DBG("change of SR detected within the FreqScale static Object, remap freq now...");
+        DBG("change of SR detected within the FreqScale, remap freq now...");
         sampleRate = sr;
         remapFreq();
     }
     
+    /// linear axis over the bins instead of log2, for the zoom sub-range
+    void setLinear(bool shouldBeLinear)
+    {
+        linear = shouldBeLinear;
+        remapFreq();
+    }
+    
+    bool isLinear() const { return linear; }
+    
+    /// resize the axis to a new Nyquist bin count, when the fft order changes
+    void setNumBins(int numBins)
+    {
+        fSize = numBins;
+        freqAxis.resize(fSize);
+        remapFreq();
+    }
+    
     // return the max value
     float maxFreq() const   {return freqAxis[fSize-1];}
     
@@ -152,9 +938,18 @@ public:
 private:
     float sampleRate = SR_DEFAULT;
     int fSize;
+    bool linear = false;
     
     void remapFreq()
     {
+        if (linear)
+        {
+            // zoom bins are already spread evenly over the selected band
+            for (int bin=0;bin<fSize;bin++)
+                freqAxis[bin] = (float)bin/(float)(fSize-1);
+            return;
+        }
+        
         // ignore zero frequency
         freqAxis[0] = 0.0f;
         // create a raw axis and convert to log10
@@ -164,65 +959,211 @@ private:
         }
         // this gives a vector between 0~1 in freqAxis vector, we should multiply later by the width of the graph window
     }
+    
+    JUCE_DECLARE_NON_COPYABLE(FreqScale4Display)
 };
 
-static FreqScale4Display fScale;
-
-/// Channel component - includes dry and wet
-class FreqAnalChannel : public juce::Component
+/// Channel component - displays dry and wet of one channel
+/// subscribes to the engine's published frames and keeps the ones of its own channel until the display collects them
+class FreqAnalChannel : public juce::Component, public SpectrumFrameConsumer
 {
 public:
-    FreqAnalChannel(uint32_t chan): chanid(chan)
+    /// scale: the frequency axis of the parent view, which outlives its channels
+    FreqAnalChannel(uint32_t chan, const FreqScale4Display& scale): fScale(scale), chanid(chan), frameQueue(FRAMEQUEUESIZE)
     {
         // init
-        dryUnit.reset( new fftUnit );
-        wetUnit.reset( new fftUnit );
-        
-        graphXSize = dryUnit->getSizeNyquist();
-        initializeXGaps(graphXSize);
-        
-        // should be whole fftSize
-        dBDry.resize(dryUnit->getSizeBuffer());
-        dBWet.resize(wetUnit->getSizeBuffer());
-        
-        DBG("dry wet resized to " + juce::String(dBDry.size()) + " " + juce::String(dBWet.size()));
-        
-        // coordinate series size defined here
-        xCoords.resize(graphXSize);
-        
-        // should be gapped-bin-size - 1
-        dryLines.resize(xGaps.size()-1);
-        wetLines.resize(xGaps.size()-1);
+        setResolution(FFTORDER_T);
+    }
+    ~FreqAnalChannel()
+    {
+    }
+    
+    /// (re)build the display buffers for an fft order, message thread only while the engine is detached
+    void setResolution(uint32_t order)
+    {
+        graphXSize = 1 << (order-1);
+        rebuildBuffers();
+        hasPercentiles = false;
+        // frames of the old resolution are of no use any more
+        frameQueue.clear();
+        latestFrame.reset();
         
-#ifdef DEBUG
-        dryUnit->iddbgDW = 0;
-        wetUnit->iddbgDW = 1;
-        dryUnit->iddbgLR = (int)chan;
-        wetUnit->iddbgLR = (int)chan;
-#endif
+        if (getHeight()!=0 && getWidth()!=0)
+            recalculateXcoords();
+    }
+    
+    /// bytes of the display buffers at the current resolution and axis, and those sized by what is shown
+    /// (reference, percentiles, markers, peak labels) kept outside the arena, and the buffer by buffer breakdown
+    size_t getMemoryBytes() const { return buffers->getTotalBytes()+getShownBytes(); }
+    juce::String getMemoryReport() const
+    {
+        return buffers->getReport() + "\nreference, percentile, marker and peak buffers: " + juce::String((juce::int64)getShownBytes()) + " B";
+    }
+    
+    /// producer thread: keep frames of this channel for the display, dropped when it has fallen behind
+    void offer(const SpectrumFrameRef& frame) override
+    {
+        if (frame->channel == chanid)
+            frameQueue.push(frame);
+    }
+    
+    /// message thread: show levels read back from a capture instead of the live spectrum
+    /// captures are unweighted, the current weighting is added here as it is to live frames
+    void showFrame(uint32_t drywet, const float* dB, int numBins)
+    {
+        auto& dest = drywet == 0 ? dBDry : dBWet;
+        numBins = juce::jmin(numBins,(int)dest.size());
+        const float* offsets = getWeighting(numBins);
+        for (int bin=0;bin<numBins;bin++)
+            dest[bin] = offsets == nullptr ? dB[bin] : juce::jmax(SpectrumUtil::FLOOR, dB[bin]+offsets[bin]);
+        updatePeakLabels(numBins);
+        repaint();
+    }
+    
+    /// message thread: label the numPeaks strongest peaks of the dry and wet traces, 0 for none
+    void setPeaks(int numPeaks)
+    {
+        peakFinders[0].setNumPeaks(numPeaks);
+        peakFinders[1].setNumPeaks(numPeaks);
+        peakLabels.clear();
+        peakLabels.reserve((size_t)PeakFinder::MAXPEAKS*2);
+        repaint();
+    }
+    
+    /// message thread: frequency of the shown bins, bin i at firstBinHz + i*binSpacingHz, for the peak labels
+    void setBinAxis(double firstBinHz, double binSpacingHz)
+    {
+        binAxisFirstHz = firstBinHz;
+        binAxisSpacingHz = binSpacingHz;
+    }
+    
+    /// message thread: per-bin dB offsets (WeightingTable) added to every level shown, nullptr for none
+    /// the table is owned by the parent and only used while it matches the resolution
+    void setWeighting(const float* offsetsDB, int numBins)
+    {
+        weightingDB = offsetsDB;
+        weightingBins = numBins;
+        applyReferenceWeighting();
+        repaint();
+    }
+    
+    /// message thread: fScale switched between log and linear, rebuild the drawn points
+    void refreshAxis()
+    {
+        rebuildBuffers();
+        if (getHeight()!=0 && getWidth()!=0)
+            recalculateXcoords();
+        repaint();
+    }
+    
+    /// message thread: leave trace drawing to the parent's TraceRasterizer
+    void setDirectRendering(bool shouldRenderDirect)
+    {
+        directRendering = shouldRenderDirect;
+        repaint();
+    }
+    
+    /// message thread: the same polylines paint() draws, as rasterizer spans at the given pixel scale
+    /// reference is left empty when there is no reference at this resolution
+    void buildTraces(TraceRasterizer::Trace& dry, TraceRasterizer::Trace& wet, TraceRasterizer::Trace& reference, float scale)
+    {
+        const int width = juce::roundToInt(getWidth()*scale);
+        dry.begin(width, (chanid == 0 ? juce::Colours::yellow : juce::Colours::orange).withAlpha(0.5f));
+        wet.begin(width, (chanid == 0 ? juce::Colours::pink : juce::Colours::purple).withAlpha(0.5f));
+        const juce::Colour referenceColour = chanid == 0 ? juce::Colours::lightblue : juce::Colours::lightgreen;
+        reference.begin(width, referenceColour.withAlpha(0.4f), referenceColour.withAlpha(REFERENCEFILLALPHA));
+        const bool hasReference = dBReference.size() == (size_t)graphXSize && !fScale.isLinear();
         
+        for (int x=1;x<xGaps.size();x++)
+        {
+            const int iLast = xGaps[x-1];
+            const int iThis = xGaps[x];
+            const float x0 = xCoords[iLast]*scale;
+            const float x1 = xCoords[iThis]*scale;
+            const float dLast = dBDry[iLast]*yIncrement;
+            const float dThis = dBDry[iThis]*yIncrement;
+            dry.addSegment(x0, (dLast+1.0f)*scale, x1, (dThis+1.0f)*scale);
+            wet.addSegment(x0, (dLast+dBWet[iLast]*yIncrement+1.0f)*scale, x1, (dThis+dBWet[iThis]*yIncrement+1.0f)*scale);
+            if (hasReference)
+                reference.addSegment(x0, (dBReference[iLast]*yIncrement+1.0f)*scale, x1, (dBReference[iThis]*yIncrement+1.0f)*scale);
+        }
+    }
+    
+    /// message thread: averaged levels of an analyzed file, drawn behind the live traces
+    /// only shown while the resolution has the same number of bins, empty to clear
+    void setReference(const std::vector<float>& dB)
+    {
+        referenceLevels = dB;
+        applyReferenceWeighting();
+        repaint();
+    }
+    
+    /// message thread: p10/p50/p90 of this channel's dry levels from the engine's statistics, none while they are off
+    void updatePercentiles(const PercentileSpectrum& source)
+    {
+        const float fractions[3] = { 0.1f, 0.5f, 0.9f };
+        hasPercentiles = source.getNumBins() == graphXSize && source.getPercentiles(chanid, fractions, 3, percentiles);
+        if (hasPercentiles)
+            percentileBins = source.getBandBins();
+        repaint();
     }
-    ~FreqAnalChannel()
+    
+    /// message thread: pinned frequency markers at 0..1 across the axis, negative when off the axis
+    void setMarkerPositions(const std::vector<float>& positions)
     {
+        markerX = positions;
+        markerDry.assign(positions.size(), SpectrumUtil::FLOOR);
+        markerWet.assign(positions.size(), SpectrumUtil::FLOOR);
+        repaint();
     }
     
-    void injectSampleTo (float inputSample, uint32_t drywet)
+    /// message thread: latest dry/wet marker levels in display dB, repaints when they moved
+    void setMarkerLevels(const std::vector<float>& dryDB, const std::vector<float>& wetDB)
     {
-        switch(drywet){
-            case 0:
-                dryUnit->injectSample( inputSample );
-                break;
-            case 1:
-                wetUnit->injectSample( inputSample );
-                break;
-        }
-        
-        if (dryUnit->ready && wetUnit->ready)
-        {
-            const juce::MessageManagerLock mmLrepaint;
-            spectrumGen();
-            repaint();
-        }
+        if (dryDB == markerDry && wetDB == markerWet)
+            return;
+        markerDry = dryDB;
+        markerWet = wetDB;
+        repaint();
+    }
+    
+    /// message thread: take a frame as if it had been collected (the engine's history when the view opens),
+    /// it is the one shown by showLatestFrame() unless a newer one follows
+    void takeFrame(const SpectrumFrameRef& frame)
+    {
+        // a frame of an older resolution can still come out right after a rebuild
+        if (frame->channel != chanid || frame->numBins != (uint32_t)graphXSize)
+            return;
+        latestFrame = frame;
+    }
+    
+    /// message thread: convert the latest frame taken to dB and repaint, returns false if there was none
+    bool showLatestFrame()
+    {
+        if (!latestFrame)
+            return false;
+        const int numBins = (int)latestFrame->numBins;
+        const float* dry = latestFrame->getMagnitudes(0);
+        const float* wet = latestFrame->getMagnitudes(1);
+        std::copy(dry, dry+numBins, dBDry.begin());
+        std::copy(wet, wet+numBins, dBWet.begin());
+        // back to the pool, the levels are kept in dB
+        latestFrame.reset();
+        const float* offsets = getWeighting(numBins);
+        SpectrumUtil::amp2db(dBDry.data(), offsets, (size_t)numBins);
+        SpectrumUtil::amp2db(dBWet.data(), offsets, (size_t)numBins);
+        updatePeakLabels(numBins);
+        repaint();
+        return true;
+    }
+    
+    /// called on the message thread, takes the published frames, converts the latest and repaints if there was one
+    void collectFrame()
+    {
+        SpectrumFrameRef frame;
+        while (frameQueue.pop(frame))
+            takeFrame(frame);
+        showLatestFrame();
     }
     
     void resized() override
@@ -238,10 +1179,42 @@ public:
     /// inherited from juce::component
     void paint(juce::Graphics& g) override
     {
+        FA_TRACE_SCOPE("FreqAnalChannel::paint");
+        // the parent rasterizes all traces itself in direct mode
+        if (directRendering)
+        {
+            paintPercentiles(g);
+            paintMarkers(g);
+            paintPeaks(g);
+            return;
+        }
+        
         //const juce::MessageManagerLock mmLpaintnow;
         
         //DBG("mono channel paint called for channel: " + juce::String(chanid));
         
+        paintPercentiles(g);
+        
+        if (dBReference.size() == (size_t)graphXSize && !fScale.isLinear() && !xGaps.empty())
+        {
+            // the analyzed file is an area under its line, the live traces are drawn over it
+            const juce::Colour colour = chanid == 0 ? juce::Colours::lightblue : juce::Colours::lightgreen;
+            referenceArea.clear();
+            referenceArea.startNewSubPath(xCoords[xGaps[0]], (float)getHeight());
+            for (size_t x=0;x<xGaps.size();x++)
+                referenceArea.lineTo(xCoords[xGaps[x]], dBReference[xGaps[x]]*yIncrement+1.0f);
+            referenceArea.lineTo(xCoords[xGaps[xGaps.size()-1]], (float)getHeight());
+            referenceArea.closeSubPath();
+            g.setColour(colour.withAlpha(REFERENCEFILLALPHA));
+            g.fillPath(referenceArea);
+            
+            g.setColour(colour);
+            g.setOpacity(0.4f);
+            for (int x=1;x<xGaps.size();x++)
+                g.drawLine(xCoords[xGaps[x-1]], dBReference[xGaps[x-1]]*yIncrement+1.0f,
+                           xCoords[xGaps[x]], dBReference[xGaps[x]]*yIncrement+1.0f);
+        }
+        
         float dLast, wLast, dThis, wThis;
         // void drawLine(float startX, float startY, float endX, float endY) const
         // void drawLine(float startX, float startY, float endX, float endY, float lineThickness) const
@@ -293,59 +1266,282 @@ public:
                 
             }
         } // for loop brackets
+        
+        paintMarkers(g);
+        paintPeaks(g);
     }
     
 private:
     // iterB
     int graphXSize;
     
-    // dry and wet fft units
-    std::unique_ptr<fftUnit> dryUnit;
-    std::unique_ptr<fftUnit> wetUnit;
-        
-    // buffers storing SPL in dB
-    std::vector<float> dBDry;
-    std::vector<float> dBWet;
+    // every buffer sized by the resolution and the axis below is a view into this one block, see rebuildBuffers()
+    // an arena per channel and not part of the engine's AnalysisStorage: it lives with the editor, and is
+    // rebuilt on the message thread on resizes and axis changes while the engine keeps running
+    std::unique_ptr<AnalyzerArena> buffers;
+    
+    // buffers storing SPL in dB, Nyquist bins
+    ArenaArray<float> dBDry;
+    ArenaArray<float> dBWet;
+    
+    // averaged levels of a dropped file, Nyquist bins, as analyzed and with the weighting added
+    std::vector<float> referenceLevels;
+    std::vector<float> dBReference;
+    
+    // weighting and tilt offsets per bin, owned by the parent
+    const float* weightingDB = nullptr;
+    int weightingBins = 0;
+    
+    // traces are drawn by the parent
+    bool directRendering = false;
+    
+    // long-term statistics of the dry levels, kept by the engine at its band bins, unweighted
+    std::vector<int> percentileBins;
+    std::vector<float> percentiles[3];   // p10, p50, p90 in dB
+    bool hasPercentiles = false;
+    
+    // pinned frequency markers, x as 0..1 of the axis, levels in dB
+    std::vector<float> markerX;
+    std::vector<float> markerDry;
+    std::vector<float> markerWet;
+    
+    // strongest peaks of the dry and wet traces, found once per frame shown and drawn as labels
+    PeakFinder peakFinders[2];
+    struct PeakLabel
+    {
+        juce::Point<float> position;
+        juce::String text;
+        uint32_t drywet;
+    };
+    std::vector<PeakLabel> peakLabels;
+    double binAxisFirstHz = 0.0;
+    double binAxisSpacingHz = SR_DEFAULT/(1 << FFTORDER_T);
+    
+    // x axis, owned by the view
+    const FreqScale4Display& fScale;
     
     // chan-id
     uint32_t chanid;
     
+    // published frames of this channel waiting for the message thread, a few timer ticks worth
+    static constexpr uint32_t FRAMEQUEUESIZE = 8;
+    SpectrumFrameQueue frameQueue;
+    // newest frame taken and not yet shown
+    SpectrumFrameRef latestFrame;
+    
     // iteration scaling
-    std::vector<int> xGaps;
+    ArenaArray<int> xGaps;
     
     // dimension related floats
     float yIncrement;
-    std::vector<float> xCoords;
+    ArenaArray<float> xCoords;
     
-    // lines
-    std::vector<juce::Line<float>> dryLines;
-    std::vector<juce::Line<float>> wetLines;
+    // lines, one fewer than the drawn points
+    ArenaArray<juce::Line<float>> dryLines;
+    ArenaArray<juce::Line<float>> wetLines;
+    // outline of the filled reference, sized with the buffers so painting does not grow it
+    juce::Path referenceArea;
+    static constexpr float REFERENCEFILLALPHA = 0.12f;
     
-    void spectrumGen()
+    /// bytes of the buffers sized by what is shown rather than by the resolution
+    size_t getShownBytes() const
     {
-        const juce::MessageManagerLock mmLspectrumGennow;
-        
-        dBDry = dryUnit->getBuffer();
-        dBWet = wetUnit->getBuffer();
+        size_t bytes = vectorBytes(referenceLevels)+vectorBytes(dBReference)+vectorBytes(percentileBins)
+                     + vectorBytes(markerX)+vectorBytes(markerDry)+vectorBytes(markerWet)+vectorBytes(peakLabels);
+        for (const auto& levels : percentiles)
+            bytes += vectorBytes(levels);
+        return bytes;
+    }
+    
+    /// lay out the level, coordinate, line and statistics buffers for graphXSize bins and the current axis
+    /// in a new arena, levels are carried over while the number of bins stays the same
+    void rebuildBuffers()
+    {
+        const size_t numBins = (size_t)graphXSize;
+        const size_t numPoints = (size_t)layoutXGaps(graphXSize, nullptr);
+        auto arena = std::make_unique<AnalyzerArena>();
+        const size_t dryAt = arena->reserve<float>("levels dry", numBins);
+        const size_t wetAt = arena->reserve<float>("levels wet", numBins);
+        const size_t coordsAt = arena->reserve<float>("x coords", numBins);
+        const size_t gapsAt = arena->reserve<int>("x gaps", numPoints);
+        const size_t dryLinesAt = arena->reserve<juce::Line<float>>("dry lines", numPoints-1);
+        const size_t wetLinesAt = arena->reserve<juce::Line<float>>("wet lines", numPoints-1);
+        arena->allocate();
         
-        SpectrumUtil::amp2db(dBDry);
-        SpectrumUtil::amp2db(dBWet);
+        const auto newDry = arena->place<float>(dryAt, numBins);
+        const auto newWet = arena->place<float>(wetAt, numBins);
+        if (dBDry.size() == numBins)
+        {
+            std::copy(dBDry.begin(), dBDry.end(), newDry.begin());
+            std::copy(dBWet.begin(), dBWet.end(), newWet.begin());
+        }
+        else
+        {
+            std::fill(newDry.begin(), newDry.end(), SpectrumUtil::FLOOR);
+            std::fill(newWet.begin(), newWet.end(), SpectrumUtil::FLOOR);
+        }
+        dBDry = newDry;
+        dBWet = newWet;
+        xCoords = arena->place<float>(coordsAt, numBins);
+        xGaps = arena->place<int>(gapsAt, numPoints);
+        layoutXGaps(graphXSize, xGaps.data());
+        dryLines = arena->place<juce::Line<float>>(dryLinesAt, numPoints-1);
+        wetLines = arena->place<juce::Line<float>>(wetLinesAt, numPoints-1);
+        // a point per drawn x and the two corners at the bottom, 3 coordinates each
+        referenceArea.clear();
+        referenceArea.preallocateSpace((int)(numPoints+3)*3);
+        // the old block goes with the last views into it
+        buffers = std::move(arena);
+        DBG("FreqAnalChannel buffers " + juce::String((juce::int64)buffers->getTotalBytes()) + " B, xGap series size = " + juce::String((int)numPoints));
+    }
+    
+    /// the weighting table if it is for numBins bins, otherwise none
+    const float* getWeighting(int numBins) const { return weightingBins == numBins ? weightingDB : nullptr; }
+    
+    void applyReferenceWeighting()
+    {
+        dBReference = referenceLevels;
+        const float* offsets = getWeighting((int)dBReference.size());
+        if (offsets != nullptr)
+            for (size_t bin=0;bin<dBReference.size();bin++)
+                dBReference[bin] = juce::jmax(SpectrumUtil::FLOOR, dBReference[bin]+offsets[bin]);
+    }
+    
+    /// p10..p90 shaded behind the traces, p50 as a line
+    /// the bands are on the log axis, and the current weighting is added as it is to the traces
+    void paintPercentiles(juce::Graphics& g)
+    {
+        const size_t numBands = percentileBins.size();
+        if (!hasPercentiles || fScale.isLinear() || numBands < 2 || percentiles[0].size() != numBands
+            || xCoords.size() != (size_t)graphXSize)
+            return;
+        const float* offsets = getWeighting(graphXSize);
+        auto y = [&] (int p, size_t band)
+        {
+            const float dB = percentiles[p][band] + (offsets == nullptr ? 0.0f : offsets[percentileBins[band]]);
+            return juce::jmax(SpectrumUtil::FLOOR, dB)*yIncrement+1.0f;
+        };
+        juce::Path band;
+        band.startNewSubPath(xCoords[percentileBins[0]], y(2, 0));
+        for (size_t b=1;b<numBands;b++)
+            band.lineTo(xCoords[percentileBins[b]], y(2, b));
+        for (size_t b=numBands;b-->0;)
+            band.lineTo(xCoords[percentileBins[b]], y(0, b));
+        band.closeSubPath();
         
-        // un-ready the units
-        dryUnit->ready = false;
-        wetUnit->ready = false;
+        const auto colour = chanid == 0 ? juce::Colours::yellow : juce::Colours::orange;
+        g.setColour(colour.withAlpha(0.12f));
+        g.fillPath(band);
+        g.setColour(colour.withAlpha(0.35f));
+        for (size_t b=1;b<numBands;b++)
+            g.drawLine(xCoords[percentileBins[b-1]], y(1, b-1), xCoords[percentileBins[b]], y(1, b));
+    }
+    
+    /// find the peaks of the levels just shown (weighted dB, so the interpolation is on log levels) and label them
+    void updatePeakLabels(int numBins)
+    {
+        peakLabels.clear();
+        if (peakFinders[0].getMaxPeaks() == 0 || numBins != graphXSize || xCoords.size() != (size_t)graphXSize)
+            return;
+        const float* offsets = getWeighting(numBins);
+        for (uint32_t drywet=0;drywet<2;drywet++)
+        {
+            auto& finder = peakFinders[drywet];
+            const auto& levels = drywet == 0 ? dBDry : dBWet;
+            finder.find(levels.data(), numBins);
+            for (int i=0;i<finder.getNumPeaks();i++)
+            {
+                const auto& peak = finder.getPeak(i);
+                const int bin = juce::jlimit(0, numBins-2, (int)peak.bin);
+                const float fraction = peak.bin-(float)bin;
+                const float x = xCoords[bin]+fraction*(xCoords[bin+1]-xCoords[bin]);
+                // wet is drawn on top of the dry level, as its trace is
+                const float y = (drywet == 0 ? peak.level : dBDry[bin]+peak.level)*yIncrement+1.0f;
+                const double f = binAxisFirstHz+peak.bin*binAxisSpacingHz;
+                // labelled without the weighting and tilt the trace is drawn with, so the level is in dBFS
+                const float offset = offsets == nullptr ? 0.0f : offsets[bin]+fraction*(offsets[bin+1]-offsets[bin]);
+                // numBins is half the fft size, zoom and rta frames are scaled to the same units
+                peakLabels.push_back({ { x, y }, getPeakText(f, SpectrumUtil::display2dbfs(peak.level-offset, 2*numBins)), drywet });
+            }
+        }
+    }
+    
+    /// "1001.3 Hz  B5 +3c  -12.4 dBFS", notes against A4 = 440 Hz, level in dBFS of a sine
+    static juce::String getPeakText(double f, float levelDBFS)
+    {
+        juce::String text = juce::String(f, f < 1000.0 ? 1 : 0) + " Hz";
+        if (f > 8.0)
+        {
+            const double midi = 69.0+12.0*std::log2(f/440.0);
+            const int note = juce::roundToInt(midi);
+            const int cents = juce::roundToInt((midi-note)*100.0);
+            text << "  " << juce::MidiMessage::getMidiNoteName(note, true, true, 4)
+                 << (cents >= 0 ? " +" : " ") << cents << "c";
+        }
+        return text << "  " << juce::String(levelDBFS, 1) << " dBFS";
+    }
+    
+    void paintPeaks(juce::Graphics& g)
+    {
+        g.setFont(11.0f);
+        for (const auto& label : peakLabels)
+        {
+            const auto colour = label.drywet == 0 ? (chanid == 0 ? juce::Colours::yellow : juce::Colours::orange)
+                                                  : (chanid == 0 ? juce::Colours::pink : juce::Colours::purple);
+            g.setColour(colour);
+            g.fillEllipse(label.position.x-2.5f, label.position.y-2.5f, 5.0f, 5.0f);
+            g.setColour(colour.withAlpha(0.9f));
+            g.drawSingleLineText(label.text, juce::roundToInt(label.position.x)+4, juce::roundToInt(label.position.y)-4);
+        }
+    }
+    
+    /// a tick and a dot on the dry and wet level of every pinned frequency on the axis
+    void paintMarkers(juce::Graphics& g)
+    {
+        for (size_t m=0;m<markerX.size();m++)
+        {
+            if (markerX[m] < 0.0f)
+                continue;
+            const float x = markerX[m]*(getWidth()-2.0f) + 1.0f;
+            const float yDry = markerDry[m]*yIncrement+1.0f;
+            // wet sits on the dry level, as its trace does
+            const float yWet = (markerDry[m]+markerWet[m])*yIncrement+1.0f;
+            g.setColour(juce::Colours::white);
+            g.setOpacity(0.3f);
+            g.drawLine(x, 1.0f, x, (float)getHeight()-1.0f);
+            g.setColour(chanid == 0 ? juce::Colours::yellow : juce::Colours::orange);
+            g.fillEllipse(x-3.0f, yDry-3.0f, 6.0f, 6.0f);
+            g.setColour(chanid == 0 ? juce::Colours::pink : juce::Colours::purple);
+            g.fillEllipse(x-3.0f, yWet-3.0f, 6.0f, 6.0f);
+        }
     }
     
-    /// called when channel initialized, incrementally omit higher frequency bins
-    void initializeXGaps(int xTotal)
+    /// the bins drawn, incrementally omitting higher frequency bins, written to gaps unless nullptr
+    /// returns how many there are, so the buffers can be sized by a first pass without output
+    int layoutXGaps(int xTotal, int* gaps) const
     {
+        int numGaps = 0;
+        if (fScale.isLinear())
+        {
+            // even spacing on a linear axis, about one point per 1024th of the width
+            const int stride = juce::jmax(1, xTotal/1024);
+            for (int x=0;x<xTotal;x+=stride)
+            {
+                if (gaps != nullptr)
+                    gaps[numGaps] = x;
+                numGaps++;
+            }
+            return numGaps;
+        }
         int iterX = 1;  // ignore zero frequency =/=0
         int gap = 1;
         int indexGap = 0;
         while (iterX < xTotal)  // ignore Nyquist frequency </=
         {
             
-            xGaps.push_back(iterX);
+            if (gaps != nullptr)
+                gaps[numGaps] = iterX;
+            numGaps++;
             iterX += gap;
             
             indexGap+=1;
@@ -353,7 +1549,7 @@ private:
             if (!(indexGap%32))
                 gap*=2; // double the gap every 32 bin selections
         }
-        DBG("xGap series size = " + juce::String(xGaps.size()));
+        return numGaps;
     }
     
     /// called when channel component initialized or resized
@@ -365,7 +1561,10 @@ private:
     
     void recalculateXcoords()
     {
-        for (int bin=0;bin<fScale.freqAxis.size();bin++)
+        // the axis and the buffers are resized together by the view, while detached
+        jassert(fScale.freqAxis.size() == xCoords.size());
+        const size_t numBins = juce::jmin(fScale.freqAxis.size(), xCoords.size());
+        for (size_t bin=0;bin<numBins;bin++)
         {
             // should ignore bin=0
             // leave 1 pixel on L/R ends
@@ -377,19 +1576,36 @@ private:
 
 //#include <juce_FFT.h>
 /// Component Freq Analyzer, two channels, two graphs, each with both D/W
-class FreqAnalyzer : public juce::Component
+/// a view of the processor's AnalysisEngine: it subscribes to the engine's frames and mirrors its settings,
+/// all the analysis state stays with the engine so the view is cheap to open and shows the recent history at once
+class FreqAnalyzer : public juce::Component, private juce::Timer
 {
     
 public:
-    FreqAnalyzer()
+    /// analysisEngine: owned by the processor and outliving the view
+    /// message thread, while the engine is detached from the audio thread, as is destruction
+    FreqAnalyzer(AnalysisEngine& analysisEngine): engine(analysisEngine)
     {        
+        engine.addConsumer(&LFAC);
+        engine.addConsumer(&RFAC);
         addAndMakeVisible(&LFAC);
         addAndMakeVisible(&RFAC);
         LFAC.setOpaque(false);
         RFAC.setOpaque(false);
+        
+        // pick up wherever the engine is, and start from its last frames and statistics instead of an empty display
+        syncWithEngine();
+        takeHistory();
+        updatePercentiles();
+        
+        // frames are published by the audio thread and collected here, faster than the ~47fps hop rate
+        startTimerHz(60);
     }
     ~FreqAnalyzer()
     {
+        stopTimer();
+        engine.removeConsumer(&LFAC);
+        engine.removeConsumer(&RFAC);
     }
     
     void setSR(float sr)//don't suppose this will be used any time soon, unless we are displaying rulers
@@ -402,17 +1618,228 @@ public:
         }
     }
     
-    /// input a single sample to specified channel and dry/wet configuration
-    void injectSampleToTo(float inputSample, uint32_t leftright, uint32_t drywet)
+    AnalysisEngine& getEngine() { return engine; }
+    
+    /// message thread: take up everything published since the last call, done by the view's own timer,
+    /// called directly only to render the view off-screen
+    void collectFrames()
     {
-        switch(leftright){
-            case 0:
-                LFAC.injectSampleTo(inputSample,drywet);
-                break;
-            case 1:
-                RFAC.injectSampleTo(inputSample,drywet);
-                break;
+        LFAC.collectFrame();
+        RFAC.collectFrame();
+        // the curves change slowly, a few times a second is plenty
+        if (++percentileCounter % PERCENTILEDIVIDER == 0)
+            updatePercentiles();
+        collectMarkers();
+        collectOverlays();
+        if (stereoScopeOn && engine.getStereoScope().render(scopeImage))
+            repaint(getScopeBounds());
+    }
+    
+    /// message thread, while detached: show the hop containing a capture record, returns false if unreadable
+    /// switches the resolution to the capture's fft size when it differs
+    bool showCapturedFrame(const SpectrumCaptureReader& reader, juce::int64 recordIndex)
+    {
+        // the reader only accepts the analyzer's power of two sizes, log2 is exact
+        const auto& header = reader.getHeader();
+        if (!reader.isValid() || !juce::isPowerOfTwo(header.fftSize))
+            return false;
+        const uint32_t order = (uint32_t)std::log2(header.fftSize);
+        if (order < FFTORDER_MIN || order > FFTORDER_MAX)
+            return false;
+        
+        CaptureRecordHeader info;
+        captureScratch.resize(header.numBins);
+        if (!reader.readRecord(recordIndex, info, captureScratch.data()))
+            return false;
+        
+        if (order != engine.getOrder())
+            setResolution(order, engine.getOverlapShift());
+        
+        // the streams of one hop are written next to each other
+        const uint32_t frameIndex = info.frameIndex;
+        for (juce::int64 i=juce::jmax((juce::int64)0,recordIndex-3);i<=recordIndex+3;i++)
+        {
+            if (!reader.readRecord(i, info, captureScratch.data()) || info.frameIndex != frameIndex)
+                continue;
+            auto& channel = info.channel == 0 ? LFAC : RFAC;
+            channel.showFrame(info.drywet, captureScratch.data(), (int)header.numBins);
+        }
+        return true;
+    }
+
+    /// the setters below change the engine and follow it in the display
+    /// message thread only, the caller must have detached the engine from the audio thread
+    
+    /// switch fft order (FFTORDER_MIN..FFTORDER_MAX) and overlap shift (0..OVERLAPSHIFT_MAX)
+    void setResolution(uint32_t order, uint32_t overlapShift)
+    {
+        engine.setResolution(order, overlapShift);
+        syncWithEngine();
+    }
+    
+    /// switch to engine storage built beforehand (while still attached), returns the old storage to free after attaching
+    std::unique_ptr<AnalysisStorage> setResolution(std::unique_ptr<AnalysisStorage> storage)
+    {
+        auto previous = engine.setResolution(std::move(storage));
+        syncWithEngine();
+        return previous;
+    }
+    
+    /// bytes of the display buffers of both channels, and their breakdown
+    size_t getMemoryBytes() const { return LFAC.getMemoryBytes()+RFAC.getMemoryBytes()+getViewBytes(); }
+    juce::String getMemoryReport() const
+    {
+        return "left display\n" + LFAC.getMemoryReport() + "\nright display\n" + RFAC.getMemoryReport()
+            + "\naxis, weighting, marker, overlay and trace buffers: " + juce::String((juce::int64)getViewBytes()) + " B";
+    }
+    
+    /// zoom into fLow..fHigh Hz on a linear axis, fHigh <= fLow for the normal display
+    void setZoom(float fLow, float fHigh, double sampleRateHz)
+    {
+        engine.setZoom(fLow, fHigh, sampleRateHz);
+        syncWithEngine();
+        repaint();
+    }
+    
+    /// stereo correlation, balance and goniometer drawn in the top right corner
+    void setStereoScope(bool shouldShow, double sampleRateHz)
+    {
+        engine.setStereoScope(shouldShow, sampleRateHz);
+        syncWithEngine();
+        repaint();
+    }
+    
+    /// long-term p10/p50/p90 envelopes of the dry spectrum over the last windowSeconds, 0 for off
+    /// the engine keeps the statistics, starting from its history, whether or not the view is open
+    void setPercentileWindow(double windowSeconds)
+    {
+        engine.setPercentileWindow(windowSeconds);
+        updatePercentiles();
+    }
+    
+    /// track up to PinnedToneBank::MAXPINNED frequencies (Hz) sample by sample, shown as markers on the traces
+    void setPinned(const std::vector<float>& frequencies, double sampleRateHz)
+    {
+        engine.setPinned(frequencies, sampleRateHz);
+        updateMarkers();
+    }
+    
+    /// fractional-octave RTA instead of the fft units: bandsPerOctave 3 or 6, 0 back to fft
+    void setRTA(int bandsPerOctave, double sampleRateHz)
+    {
+        engine.setRTA(bandsPerOctave, sampleRateHz);
+    }
+    
+    /// the processor was prepared at another rate: the engine rebuilds what depends on it, the view follows
+    void setSampleRate(double sampleRateHz)
+    {
+        engine.setSampleRate(sampleRateHz);
+        syncWithEngine();
+        repaint();
+    }
+    
+    /// message thread: label the numPeaks (0..PeakFinder::MAXPEAKS) strongest peaks of every trace, 0 for none
+    void setPeaks(int numPeaks)
+    {
+        LFAC.setPeaks(numPeaks);
+        RFAC.setPeaks(numPeaks);
+    }
+    
+    /// message thread: weighting curve and dB/octave tilt (pivot 1 kHz) of everything displayed,
+    /// the analysis and captures stay unweighted, so this needs no detach
+    void setWeighting(WeightingTable::Curve curve, float tiltDbPerOctave, double sampleRateHz)
+    {
+        weightingCurve = curve;
+        weightingTilt = tiltDbPerOctave;
+        weightingSampleRate = sampleRateHz;
+        updateWeighting();
+        updateMarkers();
+        repaint();
+    }
+    
+    /// lighter analysis under CPU pressure, see AnalysisEngine::setReducedLoad(), returns the old storage to free after attaching
+    std::unique_ptr<AnalysisStorage> setReducedLoad(int newFrameDivider, bool newAnalyzeRight, std::unique_ptr<AnalysisStorage> storage)
+    {
+        const bool rebuilt = storage != nullptr;
+        auto previous = engine.setReducedLoad(newFrameDivider, newAnalyzeRight, std::move(storage));
+        if (rebuilt)
+            syncWithEngine();
+        return previous;
+    }
+    
+    /// output spectra of other instances drawn under the traces, read from the hub every frame
+    /// localSampleRate: this instance's rate, which the display bins are spaced by
+    /// message thread, the caller watches the instances on the hub for as long as they are shown
+    void setOverlays(AnalyzerHub* hub, const std::vector<AnalyzerHub::InstanceRef>& instances, double localSampleRate)
+    {
+        overlayHub = hub;
+        overlaySampleRate = localSampleRate;
+        overlays.resize(instances.size());
+        for (size_t i=0;i<instances.size();i++)
+        {
+            auto& overlay = overlays[i];
+            overlay.instance = instances[i];
+            overlay.name = hub->getName(instances[i].slot);
+            overlay.colour = juce::Colour::fromHSV(std::fmod(0.13f+0.29f*(float)i, 1.0f), 0.5f, 1.0f, 1.0f);
+            overlay.dB.assign(AnalyzerHub::NUMBINS, SpectrumUtil::FLOOR);
+            overlay.valid = false;
+        }
+        for (auto& scratch : overlayScratch)
+            scratch.resize(AnalyzerHub::NUMBINS);
+        repaint();
+    }
+    
+    bool isZoomed() const { return engine.isZoomed(); }
+    uint32_t getOrder() const { return engine.getOrder(); }
+    uint32_t getOverlapShift() const { return engine.getOverlapShift(); }
+    bool isAnalyzingRight() const { return engine.isAnalyzingRight(); }
+    
+    /// message thread: averaged levels of an analyzed file per channel, drawn behind the live traces
+    void setReference(const std::vector<float>& dBLeft, const std::vector<float>& dBRight)
+    {
+        LFAC.setReference(dBLeft);
+        RFAC.setReference(dBRight);
+    }
+    
+    /// message thread: draw the traces with the TraceRasterizer into one image instead of
+    /// Graphics lines in each channel, for large displays
+    void setDirectRendering(bool shouldRenderDirect)
+    {
+        directRendering = shouldRenderDirect;
+        LFAC.setDirectRendering(directRendering);
+        RFAC.setDirectRendering(directRendering);
+        if (!directRendering)
+            traceImage = juce::Image();
+        repaint();
+    }
+    
+    /// message thread: spectrogram of an analyzed file, numRows time rows of numBins levels (dB)
+    /// drawn faintly behind the traces on the same log frequency axis, time running downwards
+    void setReferenceSpectrogram(const std::vector<float>& dB, int numRows, int numBins)
+    {
+        spectrogramImage = juce::Image();
+        if (numRows > 0 && numBins == (int)fScale.freqAxis.size() && getWidth() > 2)
+        {
+            const int width = getWidth()-2;
+            spectrogramImage = juce::Image(juce::Image::ARGB, width, numRows, true);
+            juce::Image::BitmapData pixels(spectrogramImage, juce::Image::BitmapData::writeOnly);
+            
+            // inverse of the display axis: x/width = log10(bin)/log10(numBins)
+            std::vector<int> binOfX(width);
+            for (int x=0;x<width;x++)
+                binOfX[x] = juce::jlimit(1, numBins-1, (int)std::pow((float)numBins, (x+0.5f)/width));
+            
+            for (int row=0;row<numRows;row++)
+            {
+                const float* levels = dB.data()+(size_t)row*numBins;
+                for (int x=0;x<width;x++)
+                {
+                    const float level = juce::jlimit(0.0f, 1.0f, 1.0f-levels[binOfX[x]]/SpectrumUtil::FLOOR);
+                    pixels.setPixelColour(x, row, juce::Colours::skyblue.withAlpha(level*level));
+                }
+            }
         }
+        repaint();
     }
     
     void resized() override
@@ -426,7 +1853,24 @@ public:
         
     void paint(juce::Graphics& g) override
     {
-        const juce::MessageManagerLock mmLpaintBordernow;
+        FA_TRACE_SCOPE("FreqAnalyzer::paint");
+        // no MessageManagerLock here: paint already runs on the message thread, and taking the lock
+        // would stop the analyzer being rendered off-screen through paintEntireComponent
+        
+        if (spectrogramImage.isValid() && !fScale.isLinear())
+        {
+            g.setOpacity(0.35f);
+            g.drawImage(spectrogramImage, getLocalBounds().reduced(1).toFloat());
+        }
+        
+        if (!overlays.empty())
+            paintOverlays(g);
+        
+        if (directRendering)
+            paintTracesDirect(g);
+        
+        if (stereoScopeOn)
+            paintStereoScope(g);
         
         g.setColour(juce::Colours::white);
         g.drawRect(rectAreaL);
@@ -437,15 +1881,348 @@ public:
     }
     
 private:
+    /// bytes of the view's own buffers, outside its channels
+    size_t getViewBytes() const
+    {
+        size_t bytes = vectorBytes(fScale.freqAxis)+vectorBytes(captureScratch)+vectorBytes(markerWeighting)+weighting.getMemoryBytes();
+        for (const auto& levels : markerLevels)
+            bytes += vectorBytes(levels);
+        for (const auto& overlay : overlays)
+            bytes += vectorBytes(overlay.dB)+overlay.weighting.getMemoryBytes();
+        for (const auto& scratch : overlayScratch)
+            bytes += vectorBytes(scratch);
+        for (const auto& trace : traces)
+            bytes += vectorBytes(trace.top)+vectorBytes(trace.bottom);
+        return bytes;
+    }
+    
+    /// lay the display out for the engine's current resolution, axis, markers and scope
+    void syncWithEngine()
+    {
+        const uint32_t order = engine.getOrder();
+        fScale.setNumBins(1 << (order-1));
+        fScale.setLinear(engine.isZoomed());
+        if (order != displayOrder)
+        {
+            LFAC.setResolution(order);
+            RFAC.setResolution(order);
+            displayOrder = order;
+        }
+        else
+        {
+            LFAC.refreshAxis();
+            RFAC.refreshAxis();
+        }
+        RFAC.setVisible(engine.isAnalyzingRight());
+        updateWeighting();
+        updateMarkers();
+        
+        stereoScopeOn = engine.isStereoScopeOn();
+        if (stereoScopeOn && !scopeImage.isValid())
+            scopeImage = juce::Image(juce::Image::ARGB, SCOPESIZE, SCOPESIZE, true);
+        else if (!stereoScopeOn)
+            scopeImage = juce::Image();
+    }
+    
+    /// rebuild the weighting table when the bins it is for have changed, and hand it and the bin frequencies to the channels
+    void updateWeighting()
+    {
+        const int numBins = 1 << (engine.getOrder()-1);
+        const double firstBinHz = engine.isZoomed() ? engine.getZoomLow() : 0.0;
+        const double binSpacingHz = engine.isZoomed() ? (engine.getZoomHigh()-engine.getZoomLow())/(numBins-1.0)
+                                                      : weightingSampleRate/(2.0*numBins);
+        LFAC.setBinAxis(firstBinHz, binSpacingHz);
+        RFAC.setBinAxis(firstBinHz, binSpacingHz);
+        if (weighting.update(weightingCurve, weightingTilt, firstBinHz, binSpacingHz, numBins))
+        {
+            LFAC.setWeighting(weighting.getOffsets(), numBins);
+            RFAC.setWeighting(weighting.getOffsets(), numBins);
+        }
+    }
+    
+    /// message thread: take up the engine's latest statistics and hand them to the channels
+    void updatePercentiles()
+    {
+        auto& percentiles = engine.getPercentiles();
+        percentiles.collect();
+        LFAC.updatePercentiles(percentiles);
+        RFAC.updatePercentiles(percentiles);
+    }
+    
+    /// while detached: run the engine's recent frames through the channels, the newest one is shown
+    void takeHistory()
+    {
+        struct Replay : public SpectrumFrameConsumer
+        {
+            Replay(FreqAnalChannel& l, FreqAnalChannel& r): left(l), right(r) {}
+            void offer(const SpectrumFrameRef& frame) override { (frame->channel == 0 ? left : right).takeFrame(frame); }
+            FreqAnalChannel& left;
+            FreqAnalChannel& right;
+        } replay(LFAC, RFAC);
+        engine.replayHistory(replay);
+        LFAC.showLatestFrame();
+        RFAC.showLatestFrame();
+    }
+    
+    /// 0..1 across the current axis (log bins at the given rate, or the linear zoom band), negative when off the axis
+    float axisPosition(float f, double binSampleRate) const
+    {
+        float position;
+        const float zoomLow = engine.getZoomLow();
+        const float zoomHigh = engine.getZoomHigh();
+        if (zoomHigh > zoomLow)
+            position = (f-zoomLow)/(zoomHigh-zoomLow);
+        else
+        {
+            const float numBins = (float)(1 << (engine.getOrder()-1));
+            const float bin = f*2.0f*numBins/(float)binSampleRate;
+            position = bin < 1.0f ? -1.0f : std::log10(bin)/std::log10(numBins);
+        }
+        return position >= 0.0f && position <= 1.0f ? position : -1.0f;
+    }
+    
+    /// place the pinned markers on the current axis
+    void updateMarkers()
+    {
+        const auto& pinnedFrequencies = engine.getPinnedFrequencies();
+        std::vector<float> positions(pinnedFrequencies.size());
+        markerWeighting.resize(pinnedFrequencies.size());
+        for (size_t pin=0;pin<positions.size();pin++)
+        {
+            positions[pin] = axisPosition(pinnedFrequencies[pin], engine.getPinnedSampleRate());
+            markerWeighting[pin] = WeightingTable::getOffset(weightingCurve, weightingTilt, pinnedFrequencies[pin]);
+        }
+        LFAC.setMarkerPositions(positions);
+        RFAC.setMarkerPositions(positions);
+    }
+    
+    /// message thread: pinned levels on the display dB scale (a sine reads as in its fft peak bin)
+    void collectMarkers()
+    {
+        const auto& pinnedFrequencies = engine.getPinnedFrequencies();
+        if (pinnedFrequencies.empty())
+            return;
+        const float scale = (float)(1 << (engine.getOrder()-1))*0.5f;
+        for (uint32_t leftright=0;leftright<(engine.isAnalyzingRight() ? 2u : 1u);leftright++)
+        {
+            for (int drywet=0;drywet<2;drywet++)
+            {
+                auto& levels = markerLevels[drywet];
+                levels.resize(pinnedFrequencies.size());
+                for (size_t pin=0;pin<levels.size();pin++)
+                    levels[pin] = engine.getPinnedAmplitude(leftright, (uint32_t)drywet, (int)pin)*scale;
+                SpectrumUtil::amp2db(levels.data(), markerWeighting.data(), levels.size());
+            }
+            (leftright == 0 ? LFAC : RFAC).setMarkerLevels(markerLevels[0], markerLevels[1]);
+        }
+    }
+    
+    /// rasterize references and dry/wet of both channels in one pass, at the physical pixel scale
+    void paintTracesDirect(juce::Graphics& g)
+    {
+        FA_TRACE_SCOPE("direct trace raster");
+        const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        const int width = juce::roundToInt(getWidth()*scale);
+        const int height = juce::roundToInt(getHeight()*scale);
+        if (width <= 0 || height <= 0)
+            return;
+        if (traceImage.getWidth() != width || traceImage.getHeight() != height)
+            traceImage = juce::Image(juce::Image::ARGB, width, height, true);
+        
+        LFAC.buildTraces(traces[1], traces[2], traces[0], scale);
+        RFAC.buildTraces(traces[4], traces[5], traces[3], scale);
+        // references below the live traces, right channel on top of left as with the components
+        const bool analyzeRight = engine.isAnalyzingRight();
+        const TraceRasterizer::Trace* order[6];
+        int numTraces = 0;
+        order[numTraces++] = &traces[0];
+        if (analyzeRight) order[numTraces++] = &traces[3];
+        order[numTraces++] = &traces[1];
+        order[numTraces++] = &traces[2];
+        if (analyzeRight)
+        {
+            order[numTraces++] = &traces[4];
+            order[numTraces++] = &traces[5];
+        }
+        rasterizer.render(traceImage, order, numTraces);
+        g.drawImage(traceImage, getLocalBounds().toFloat());
+    }
+    
+    /// message thread: latest hub spectra of the overlaid instances, power average of their channels in display dB
+    void collectOverlays()
+    {
+        if (overlays.empty())
+            return;
+        // the hub publishes 2^ORDER point magnitudes, the display's scale grows with its fft size
+        const float scale = (float)(1 << engine.getOrder())/(float)(1 << AnalyzerHub::ORDER);
+        for (auto& overlay : overlays)
+        {
+            const int slot = overlay.instance.slot;
+            const bool stereo = overlayHub->getNumChannels(slot) == 2;
+            overlay.valid = overlayHub->read(overlay.instance, 0, overlayScratch[0].data())
+                && (!stereo || overlayHub->read(overlay.instance, 1, overlayScratch[1].data()));
+            if (!overlay.valid)
+                continue;
+            overlay.sampleRate = overlayHub->getSampleRate(slot);
+            for (int bin=0;bin<AnalyzerHub::NUMBINS;bin++)
+            {
+                const float left = overlayScratch[0][bin];
+                const float right = stereo ? overlayScratch[1][bin] : left;
+                overlay.dB[bin] = std::sqrt(0.5f*(left*left+right*right))*scale;
+            }
+            // weighted at the overlaid instance's own bin frequencies
+            overlay.weighting.update(weightingCurve, weightingTilt, 0.0, overlay.sampleRate/(double)(1 << AnalyzerHub::ORDER), AnalyzerHub::NUMBINS);
+            SpectrumUtil::amp2db(overlay.dB.data(), overlay.weighting.getOffsets(), overlay.dB.size());
+        }
+        repaint();
+    }
+    
+    /// one polyline per overlaid instance (the loudest bin of each pixel column), names along the bottom left
+    void paintOverlays(juce::Graphics& g)
+    {
+        const float yScale = (getHeight()-2.0f)/SpectrumUtil::FLOOR;
+        g.setFont(12.0f);
+        for (size_t i=0;i<overlays.size();i++)
+        {
+            const auto& overlay = overlays[i];
+            g.setColour(overlay.colour.withAlpha(overlay.valid ? 0.8f : 0.35f));
+            g.drawText(overlay.name, 6, getHeight()-20-14*(int)i, 200, 14, juce::Justification::left);
+            if (!overlay.valid)
+                continue;
+            
+            juce::Path path;
+            bool started = false;
+            float columnX = -1.0f, columnY = 0.0f;
+            for (int bin=1;bin<AnalyzerHub::NUMBINS;bin++)
+            {
+                const float position = axisPosition(bin*overlay.sampleRate/(float)(1 << AnalyzerHub::ORDER), overlaySampleRate);
+                if (position < 0.0f)
+                    continue;
+                const float x = std::floor(position*(getWidth()-2.0f)) + 1.0f;
+                const float y = overlay.dB[bin]*yScale+1.0f;
+                if (x == columnX)
+                {
+                    columnY = juce::jmin(columnY, y);
+                    continue;
+                }
+                if (columnX >= 0.0f)
+                {
+                    if (started) path.lineTo(columnX, columnY);
+                    else path.startNewSubPath(columnX, columnY);
+                    started = true;
+                }
+                columnX = x;
+                columnY = y;
+            }
+            if (started)
+            {
+                path.lineTo(columnX, columnY);
+                g.setColour(overlay.colour.withAlpha(0.6f));
+                g.strokePath(path, juce::PathStrokeType(1.0f));
+            }
+        }
+    }
+    
+    void timerCallback() override
+    {
+        collectFrames();
+    }
+    
+    /// goniometer square with the correlation and balance bars under it
+    juce::Rectangle<int> getScopeBounds() const
+    {
+        return { getWidth()-SCOPESIZE-6, 6, SCOPESIZE, SCOPESIZE+30 };
+    }
+    
+    void paintStereoScope(juce::Graphics& g)
+    {
+        const auto area = getScopeBounds();
+        const auto square = area.withHeight(SCOPESIZE).toFloat();
+        g.setColour(juce::Colours::black.withAlpha(0.6f));
+        g.fillRect(area);
+        // L and R axes on the diagonals, mid straight up
+        g.setColour(juce::Colours::grey);
+        g.drawLine(square.getX(), square.getY(), square.getRight(), square.getBottom());
+        g.drawLine(square.getRight(), square.getY(), square.getX(), square.getBottom());
+        g.drawImage(scopeImage, square);
+        
+        // bars from the centre: correlation -1..+1, balance left..right
+        const auto& stereoScope = engine.getStereoScope();
+        const float values[2] = { stereoScope.getCorrelation(), stereoScope.getBalance() };
+        for (int bar=0;bar<2;bar++)
+        {
+            const float y = (float)(area.getY()+SCOPESIZE+4+bar*13);
+            const float centre = square.getCentreX();
+            const float end = centre+values[bar]*0.5f*(square.getWidth()-2.0f);
+            g.setColour(bar == 0 ? (values[0] < 0.0f ? juce::Colours::red : juce::Colours::limegreen) : juce::Colours::skyblue);
+            g.fillRect(juce::Rectangle<float>(juce::jmin(centre, end), y, std::abs(end-centre)+1.0f, 8.0f));
+            g.setColour(juce::Colours::grey);
+            g.drawLine(centre, y, centre, y+8.0f);
+        }
+    }
+    
+    /// the processor's analysis, this component only displays it
+    AnalysisEngine& engine;
+    
     /// leftright, drywet buffers, initialize with identities
-    FreqAnalChannel LFAC = FreqAnalChannel(0);
-    FreqAnalChannel RFAC = FreqAnalChannel(1);
+    // this view's x axis, shared by its channels and built before them
+    FreqScale4Display fScale;
+    FreqAnalChannel LFAC { 0, fScale };
+    FreqAnalChannel RFAC { 1, fScale };
     
     juce::Rectangle<int> rectAreaL;
     juce::Rectangle<int> rectAreaR;
     
     float sampleRate = SR_DEFAULT;
     
+    /// fft order the channels are laid out for
+    uint32_t displayOrder = FFTORDER_T;
+    
+    /// percentile curves are refreshed every PERCENTILEDIVIDER frames collected
+    static constexpr int PERCENTILEDIVIDER = 8;
+    int percentileCounter = 0;
+    
+    /// capture playback
+    std::vector<float> captureScratch;
+    
+    /// spectrogram of a dropped file
+    juce::Image spectrogramImage;
+    
+    /// pinned tone levels being converted, and the weighting at the pinned frequencies
+    std::vector<float> markerLevels[2];
+    std::vector<float> markerWeighting;
+    
+    /// weighting and tilt of the display, the table is for the current bins
+    WeightingTable::Curve weightingCurve = WeightingTable::flat;
+    float weightingTilt = 0.0f;
+    double weightingSampleRate = SR_DEFAULT;
+    WeightingTable weighting;
+    
+    /// other instances' hub spectra, drawn under the traces
+    struct Overlay
+    {
+        AnalyzerHub::InstanceRef instance;
+        juce::String name;
+        juce::Colour colour;
+        float sampleRate = SR_DEFAULT;
+        std::vector<float> dB;
+        WeightingTable weighting;
+        bool valid = false;
+    };
+    AnalyzerHub* overlayHub = nullptr;
+    double overlaySampleRate = SR_DEFAULT;
+    std::vector<Overlay> overlays;
+    std::vector<float> overlayScratch[2];
+    
+    /// stereo diagnostics of the output, drawn over the top right corner
+    static constexpr int SCOPESIZE = 120;
+    bool stereoScopeOn = false;
+    juce::Image scopeImage;
+    
+    /// direct trace rendering: L reference/dry/wet, R reference/dry/wet
+    bool directRendering = false;
+    TraceRasterizer rasterizer;
+    TraceRasterizer::Trace traces[6];
+    juce::Image traceImage;
+    
 };  // FreqAnalyzer class brackets
-
-
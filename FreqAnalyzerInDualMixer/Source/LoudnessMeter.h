@@ -0,0 +1,365 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    Created: 22 Oct 2026 1:52:37pm
+    Author:  Louis Deng
+
+    ITU-R BS.1770 loudness (momentary, short-term, integrated) and 4x
+    oversampled true-peak of one multichannel signal
+
+    each channel is K-weighted (shelf + RLB high-pass biquads, one fused pass
+    per block in double) and its squares are summed into 100 ms sub-blocks.
+    the 400 ms gating blocks (75% overlap) and the 3 s short-term window are
+    sums of the last 4 / 30 sub-blocks, kept in a ring that also holds every
+    sub-block one block (up to the maximum size prepare() was given) finishes
+    before advance() evaluates them. integrated loudness keeps a histogram
+    of the gating block loudness with the energy per bucket, so the absolute
+    and relative gates are applied without storing the blocks themselves.
+
+    true-peak runs a 48 tap polyphase interpolator, its 4 phases side by side
+    in SIMD lanes: one broadcast input sample times one coefficient register
+    per tap gives all 4 oversampled outputs at once
+
+    everything is allocated in prepare(), results are published as atomics
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class LoudnessMeter
+{
+public:
+#if JUCE_USE_SIMD
+    using Reg = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = (int)Reg::SIMDNumElements;
+#else
+    using Reg = float;
+    static constexpr int LANES = 1;
+#endif
+
+    static constexpr int MAXCHANNELS = 2;
+    /// reported for silence and before the first block
+    static constexpr float MINLUFS = -120.0f;
+
+    LoudnessMeter()
+    {
+    }
+
+    ~LoudnessMeter()
+    {
+    }
+
+    /// called from prepareToPlay, resets all measurements. blocks handed to processChannel() before an
+    /// advance() must not be longer than maximumBlockSize
+    void prepare(double sampleRate, int newNumChannels, int maximumBlockSize)
+    {
+        numChannels = juce::jlimit(1, MAXCHANNELS, newNumChannels);
+        subBlockLength = juce::jmax(1, juce::roundToInt(sampleRate*0.1));
+        // the short-term window, plus the sub-blocks one block finishes before advance() gets to them
+        ringSize = SHORTTERMSUBS+juce::jmax(0, maximumBlockSize)/subBlockLength+2;
+        designKWeighting(sampleRate);
+        designInterpolator();
+        histogram.assign(NUMBUCKETS, {});
+        for (auto& channel : channels)
+        {
+            channel = ChannelState();
+            channel.subBlocks.assign((size_t)ringSize, 0.0);
+        }
+        evaluated = 0;
+        resetPending.store(false);
+        for (auto* level : { &momentary, &shortTerm, &integrated, &truePeak })
+            level->store(MINLUFS);
+    }
+
+    /// message thread: restart integrated loudness and the true-peak hold, applied by the audio thread
+    void reset() { resetPending.store(true); }
+
+    /// audio thread: one block of a channel, every channel in turn with the same blocks, at most the
+    /// maximum block size between two advance() calls
+    template <typename SampleType>
+    void processChannel(uint32_t channel, const SampleType* input, int numSamples)
+    {
+        if (channel >= (uint32_t)numChannels)
+            return;
+        auto& state = channels[channel];
+
+        // K-weighting, both sections in one pass with their state in locals
+        double s1 = state.shelf[0], s2 = state.shelf[1];
+        double h1 = state.highpass[0], h2 = state.highpass[1];
+        double energy = state.energy;
+        int position = state.position;
+        for (int i=0;i<numSamples;i++)
+        {
+            const double x = (double)input[i];
+            const double y = shelfB[0]*x + s1;
+            s1 = shelfB[1]*x - shelfA[0]*y + s2;
+            s2 = shelfB[2]*x - shelfA[1]*y;
+            // RLB numerator is 1, -2, 1
+            const double z = y + h1;
+            h1 = -2.0*y - highpassA[0]*z + h2;
+            h2 = y - highpassA[1]*z;
+            energy += z*z;
+
+            if (++position == subBlockLength)
+            {
+                state.subBlocks[(size_t)(state.numSubBlocks % ringSize)] = energy;
+                state.numSubBlocks++;
+                energy = 0.0;
+                position = 0;
+            }
+        }
+        state.shelf[0] = s1; state.shelf[1] = s2;
+        state.highpass[0] = h1; state.highpass[1] = h2;
+        state.energy = energy;
+        state.position = position;
+
+        truePeakBlock(state, input, numSamples);
+    }
+
+    /// audio thread, after every channel got the same blocks: evaluate the finished sub-blocks and publish
+    void advance()
+    {
+        if (resetPending.exchange(false))
+            applyReset();
+
+        juce::int64 finished = channels[0].numSubBlocks;
+        for (int ch=1;ch<numChannels;ch++)
+            finished = juce::jmin(finished, channels[ch].numSubBlocks);
+        if (finished == evaluated)
+            return;
+
+        for (;evaluated<finished;evaluated++)
+        {
+            // gating block: the sub-block just finished and the 3 before it
+            if (evaluated >= 3)
+            {
+                const double block = windowMeanSquare(evaluated, 4);
+                const float lufs = toLUFS(block);
+                if (lufs > ABSOLUTEGATE)
+                {
+                    auto& bucket = histogram[(size_t)juce::jlimit(0, NUMBUCKETS-1, (int)((lufs-ABSOLUTEGATE)/BUCKETLU))];
+                    bucket.count++;
+                    bucket.energy += block;
+                }
+            }
+        }
+
+        const juce::int64 last = finished-1;
+        momentary.store(toLUFS(windowMeanSquare(last, (int)juce::jmin((juce::int64)4, finished))), std::memory_order_relaxed);
+        shortTerm.store(toLUFS(windowMeanSquare(last, (int)juce::jmin((juce::int64)SHORTTERMSUBS, finished))), std::memory_order_relaxed);
+        integrated.store(integratedLUFS(), std::memory_order_relaxed);
+
+        float peak = 0.0f;
+        for (int ch=0;ch<numChannels;ch++)
+            peak = juce::jmax(peak, channels[ch].truePeak);
+        truePeak.store(peak > 0.0f ? 20.0f*std::log10(peak) : MINLUFS, std::memory_order_relaxed);
+    }
+
+    /// any thread, LUFS and dBTP
+    float getMomentary() const { return momentary.load(std::memory_order_relaxed); }
+    float getShortTerm() const { return shortTerm.load(std::memory_order_relaxed); }
+    float getIntegrated() const { return integrated.load(std::memory_order_relaxed); }
+    float getTruePeak() const { return truePeak.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int SHORTTERMSUBS = 30;    // 3 s of 100 ms sub-blocks
+    static constexpr float ABSOLUTEGATE = -70.0f;
+    static constexpr float RELATIVEGATE = -10.0f;
+    static constexpr float BUCKETLU = 0.1f;     // integrated histogram, -70 .. +10 LUFS
+    static constexpr int NUMBUCKETS = 800;
+    static constexpr int PHASES = 4;
+    static constexpr int TAPSPERPHASE = 12;
+    static constexpr int PHASEGROUPS = (PHASES+LANES-1)/LANES;
+
+    struct ChannelState
+    {
+        double shelf[2] {};
+        double highpass[2] {};
+        double energy = 0.0;
+        int position = 0;
+        juce::int64 numSubBlocks = 0;
+        std::vector<double> subBlocks;  // ring of ringSize, sub-block n at n % ringSize
+
+        // interpolator input history, written twice so the taps read one run
+        std::array<float, TAPSPERPHASE*2> history {};
+        int historyPos = 0;
+        float truePeak = 0.0f;
+    };
+    ChannelState channels[MAXCHANNELS];
+    int numChannels = 2;
+    int subBlockLength = 4800;
+    int ringSize = SHORTTERMSUBS+2;
+    juce::int64 evaluated = 0;
+
+    // K-weighting coefficients, a0 = 1
+    double shelfB[3] {}, shelfA[2] {};
+    double highpassA[2] {};
+
+    // interpolator taps, tap k of every phase side by side
+    Reg phaseTaps[TAPSPERPHASE][PHASEGROUPS] {};
+
+    struct Bucket
+    {
+        juce::int64 count = 0;
+        double energy = 0.0;
+    };
+    std::vector<Bucket> histogram;
+
+    std::atomic<bool> resetPending { false };
+    std::atomic<float> momentary { MINLUFS };
+    std::atomic<float> shortTerm { MINLUFS };
+    std::atomic<float> integrated { MINLUFS };
+    std::atomic<float> truePeak { MINLUFS };
+
+#if JUCE_USE_SIMD
+    static Reg broadcast(float v) { return Reg::expand(v); }
+    static void setLane(Reg& r, int lane, float v) { r.set((size_t)lane, v); }
+    static float getLane(const Reg& r, int lane) { return r.get((size_t)lane); }
+    static Reg maxReg(Reg a, Reg b) { return Reg::max(a, b); }
+    static Reg minReg(Reg a, Reg b) { return Reg::min(a, b); }
+#else
+    static Reg broadcast(float v) { return v; }
+    static void setLane(Reg& r, int, float v) { r = v; }
+    static float getLane(const Reg& r, int) { return r; }
+    static Reg maxReg(Reg a, Reg b) { return juce::jmax(a, b); }
+    static Reg minReg(Reg a, Reg b) { return juce::jmin(a, b); }
+#endif
+
+    void applyReset()
+    {
+        for (auto& bucket : histogram)
+            bucket = {};
+        for (auto& channel : channels)
+            channel.truePeak = 0.0f;
+    }
+
+    static float toLUFS(double meanSquare)
+    {
+        if (meanSquare <= 0.0)
+            return MINLUFS;
+        return juce::jmax(MINLUFS, (float)(-0.691+10.0*std::log10(meanSquare)));
+    }
+
+    /// channel-summed mean square of the numSubs sub-blocks ending at lastSub
+    double windowMeanSquare(juce::int64 lastSub, int numSubs) const
+    {
+        if (numSubs <= 0)
+            return 0.0;
+        double sum = 0.0;
+        for (int ch=0;ch<numChannels;ch++)
+            for (int s=0;s<numSubs;s++)
+                sum += channels[ch].subBlocks[(size_t)((lastSub-s) % ringSize)];
+        return sum/((double)numSubs*subBlockLength);
+    }
+
+    /// gated mean over the histogram: absolute gate already applied, relative gate 10 LU under the mean
+    float integratedLUFS() const
+    {
+        juce::int64 count = 0;
+        double energy = 0.0;
+        for (const auto& bucket : histogram)
+        {
+            count += bucket.count;
+            energy += bucket.energy;
+        }
+        if (count == 0)
+            return MINLUFS;
+
+        const float gate = toLUFS(energy/count)+RELATIVEGATE;
+        count = 0;
+        energy = 0.0;
+        for (int b=0;b<NUMBUCKETS;b++)
+        {
+            // the bucket holding the gate is counted whole, an error of at most BUCKETLU on the gate
+            if (ABSOLUTEGATE+(b+1)*BUCKETLU <= gate)
+                continue;
+            count += histogram[b].count;
+            energy += histogram[b].energy;
+        }
+        return count > 0 ? toLUFS(energy/count) : MINLUFS;
+    }
+
+    /// BS.1770 K-weighting at any sample rate, from the analog prototypes of the 48 kHz filters
+    void designKWeighting(double fs)
+    {
+        const double pi = juce::MathConstants<double>::pi;
+        {
+            const double f0 = 1681.974450955533, G = 3.999843853973347, Q = 0.7071752369554196;
+            const double K = std::tan(pi*f0/fs);
+            const double Vh = std::pow(10.0, G/20.0);
+            const double Vb = std::pow(Vh, 0.4996667741545416);
+            const double a0 = 1.0 + K/Q + K*K;
+            shelfB[0] = (Vh + Vb*K/Q + K*K)/a0;
+            shelfB[1] = 2.0*(K*K - Vh)/a0;
+            shelfB[2] = (Vh - Vb*K/Q + K*K)/a0;
+            shelfA[0] = 2.0*(K*K - 1.0)/a0;
+            shelfA[1] = (1.0 - K/Q + K*K)/a0;
+        }
+        {
+            const double f0 = 38.13547087602444, Q = 0.5003270373238773;
+            const double K = std::tan(pi*f0/fs);
+            const double a0 = 1.0 + K/Q + K*K;
+            highpassA[0] = 2.0*(K*K - 1.0)/a0;
+            highpassA[1] = (1.0 - K/Q + K*K)/a0;
+        }
+    }
+
+    /// 48 tap Blackman windowed sinc at the original Nyquist, split into 4 phases of unity DC gain
+    void designInterpolator()
+    {
+        const int numTaps = PHASES*TAPSPERPHASE;
+        for (int phase=0;phase<PHASES;phase++)
+        {
+            double taps[TAPSPERPHASE];
+            double sum = 0.0;
+            for (int k=0;k<TAPSPERPHASE;k++)
+            {
+                const int n = k*PHASES+phase;
+                const double m = (n-0.5*(numTaps-1))/PHASES;
+                const double sinc = m == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi*m)/(juce::MathConstants<double>::pi*m);
+                const double w = juce::MathConstants<double>::twoPi*n/(numTaps-1);
+                taps[k] = sinc*(0.42-0.5*std::cos(w)+0.08*std::cos(2.0*w));
+                sum += taps[k];
+            }
+            for (int k=0;k<TAPSPERPHASE;k++)
+                setLane(phaseTaps[k][phase/LANES], phase % LANES, (float)(taps[k]/sum));
+        }
+        // padding lanes keep zero taps and read 0
+    }
+
+    template <typename SampleType>
+    void truePeakBlock(ChannelState& state, const SampleType* input, int numSamples)
+    {
+        Reg highest[PHASEGROUPS], lowest[PHASEGROUPS];
+        for (int g=0;g<PHASEGROUPS;g++)
+        {
+            highest[g] = broadcast(0.0f);
+            lowest[g] = broadcast(0.0f);
+        }
+
+        for (int i=0;i<numSamples;i++)
+        {
+            state.history[(size_t)state.historyPos] = (float)input[i];
+            state.history[(size_t)state.historyPos+TAPSPERPHASE] = (float)input[i];
+            state.historyPos = state.historyPos+1 == TAPSPERPHASE ? 0 : state.historyPos+1;
+            // newest sample first against tap 0
+            const float* h = state.history.data()+state.historyPos;
+            for (int g=0;g<PHASEGROUPS;g++)
+            {
+                Reg out = broadcast(0.0f);
+                for (int k=0;k<TAPSPERPHASE;k++)
+                    out = out + phaseTaps[k][g]*broadcast(h[TAPSPERPHASE-1-k]);
+                highest[g] = maxReg(highest[g], out);
+                lowest[g] = minReg(lowest[g], out);
+            }
+        }
+
+        for (int phase=0;phase<PHASES;phase++)
+            state.truePeak = juce::jmax(state.truePeak, getLane(highest[phase/LANES], phase % LANES),
+                                        -getLane(lowest[phase/LANES], phase % LANES));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(LoudnessMeter)
+};
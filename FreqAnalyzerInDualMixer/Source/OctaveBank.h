@@ -0,0 +1,238 @@
+/*
+  ==============================================================================
+
+    OctaveBank.h
+    Created: 21 Oct 2026 10:12:44am
+    Author:  Louis Deng
+
+    fractional-octave filter bank (1/3 or 1/6 octave), the RTA alternative to fftUnit
+
+    bands follow the IEC 61260 base-10 series, each band is a 6th order
+    Butterworth band-pass (3 biquads, bilinear with prewarped edges) normalized
+    to 0 dB at its centre. bands are packed one per SIMD lane, so a group of 4
+    (SSE/NEON) or 8 (AVX) bands runs as one cascade of 3 vector biquads. every
+    block the squared outputs are summed per band and folded into a one-pole
+    mean square with a fixed integration time
+
+    the band edges and the groups' coefficients and state are one
+    AnalyzerArena block, allocated with the bank
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AnalyzerArena.h"
+
+class OctaveBank
+{
+public:
+#if JUCE_USE_SIMD
+    using Reg = juce::dsp::SIMDRegister<float>;
+    static constexpr int LANES = (int)Reg::SIMDNumElements;
+#else
+    using Reg = float;
+    static constexpr int LANES = 1;
+#endif
+
+    /// bandsPerOctave 3 or 6, bands from 20 Hz up to 20 kHz or just below Nyquist
+    OctaveBank(int bandsPerOctave, double sampleRate): fs(sampleRate)
+    {
+        // IEC 61260 base-10 octave ratio, odd b: fm = 1000 G^(x/b), even b: fm = 1000 G^((2x+1)/2b)
+        const double G = std::pow(10.0, 0.3);
+        const double b = (double)bandsPerOctave;
+        std::vector<float> bandCentres, bandLowerEdges, bandUpperEdges;
+        for (int x=-60;x<=60;x++)
+        {
+            const double fm = 1000.0*std::pow(G, (bandsPerOctave % 2) ? x/b : (2*x+1)/(2*b));
+            const double f1 = fm*std::pow(G, -1.0/(2*b));
+            const double f2 = fm*std::pow(G, 1.0/(2*b));
+            if (fm < 19.5 || fm > 20500.0 || f2 >= 0.49*fs)
+                continue;
+            bandCentres.push_back((float)fm);
+            bandLowerEdges.push_back((float)f1);
+            bandUpperEdges.push_back((float)f2);
+        }
+
+        // zeroed by the allocation, every band starts silent
+        const size_t numBands = bandCentres.size();
+        const size_t numGroups = (numBands+LANES-1)/LANES;
+        const size_t edgesAt[3] = { arena.reserve<float>("rta centres", numBands), arena.reserve<float>("rta lower edges", numBands),
+                                    arena.reserve<float>("rta upper edges", numBands) };
+        const size_t groupsAt = arena.reserve<Group>("rta groups", numGroups);
+        arena.allocate();
+        centres = arena.place<float>(edgesAt[0], numBands);
+        lowerEdges = arena.place<float>(edgesAt[1], numBands);
+        upperEdges = arena.place<float>(edgesAt[2], numBands);
+        groups = arena.place<Group>(groupsAt, numGroups);
+        std::copy(bandCentres.begin(), bandCentres.end(), centres.begin());
+        std::copy(bandLowerEdges.begin(), bandLowerEdges.end(), lowerEdges.begin());
+        std::copy(bandUpperEdges.begin(), bandUpperEdges.end(), upperEdges.begin());
+        for (int band=0;band<getNumBands();band++)
+        {
+            double b0, a1[NUMSECTIONS], a2[NUMSECTIONS];
+            designBand(lowerEdges[band], upperEdges[band], centres[band], b0, a1, a2);
+            auto& group = groups[band/LANES];
+            for (int s=0;s<NUMSECTIONS;s++)
+            {
+                setLane(group.b0[s], band % LANES, (float)b0);
+                setLane(group.nb0[s], band % LANES, (float)-b0);
+                setLane(group.c1[s], band % LANES, (float)(a1[s]+2.0));
+                setLane(group.c2[s], band % LANES, (float)(a2[s]-1.0));
+            }
+        }
+        // padding lanes keep zero coefficients and stay silent
+
+        setIntegrationTime(0.125);
+    }
+
+    ~OctaveBank()
+    {
+    }
+
+    int getNumBands() const { return (int)centres.size(); }
+    float getCentreFrequency(int band) const { return centres[band]; }
+    float getLowerEdge(int band) const { return lowerEdges[band]; }
+    float getUpperEdge(int band) const { return upperEdges[band]; }
+
+    /// bytes of the band edges, coefficients and state
+    size_t getMemoryBytes() const { return arena.getTotalBytes(); }
+
+    /// one-pole integration time constant of the band levels (0.125 s = "fast")
+    void setIntegrationTime(double seconds)
+    {
+        integrationSamples = juce::jmax(1.0, seconds*fs);
+    }
+
+    /// audio thread: filter a block through every band and fold its mean square into the band levels
+    void processBlock(const float* input, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        const float blend = (float)(1.0-std::exp(-(double)numSamples/integrationSamples));
+        const Reg blockScale = broadcast(1.0f/(float)numSamples);
+        const Reg blendReg = broadcast(blend);
+
+        for (auto& group : groups)
+        {
+            // state stays in registers for the whole block
+            Reg z1[NUMSECTIONS], z2[NUMSECTIONS];
+            for (int s=0;s<NUMSECTIONS;s++)
+            {
+                z1[s] = group.z1[s];
+                z2[s] = group.z2[s];
+            }
+            Reg sum = broadcast(0.0f);
+
+            for (int i=0;i<numSamples;i++)
+            {
+                Reg x = broadcast(input[i]);
+                for (int s=0;s<NUMSECTIONS;s++)
+                {
+                    // transposed direct form II, b1 = 0 and b2 = -b0 for these band-pass sections,
+                    // a1 = c1 - 2 and a2 = c2 + 1 so the feedback keeps its precision
+                    const Reg y = group.b0[s]*x + z1[s];
+                    z1[s] = z2[s] + (y + y) - group.c1[s]*y;
+                    z2[s] = group.nb0[s]*x - y - group.c2[s]*y;
+                    x = y;
+                }
+                sum = sum + x*x;
+            }
+
+            for (int s=0;s<NUMSECTIONS;s++)
+            {
+                group.z1[s] = z1[s];
+                group.z2[s] = z2[s];
+            }
+            group.meanSquare = group.meanSquare + blendReg*(sum*blockScale - group.meanSquare);
+        }
+    }
+
+    /// rms level of a band, any time between processBlock calls on the same thread
+    float getRMS(int band) const
+    {
+        return std::sqrt(juce::jmax(0.0f, getLane(groups[band/LANES].meanSquare, band % LANES)));
+    }
+
+    /// forget filter state and levels
+    void reset()
+    {
+        for (auto& group : groups)
+        {
+            for (int s=0;s<NUMSECTIONS;s++)
+            {
+                group.z1[s] = broadcast(0.0f);
+                group.z2[s] = broadcast(0.0f);
+            }
+            group.meanSquare = broadcast(0.0f);
+        }
+    }
+
+private:
+    static constexpr int NUMSECTIONS = 3;
+
+    double fs;
+    double integrationSamples = 1.0;
+    AnalyzerArena arena;
+    ArenaArray<float> centres;
+    ArenaArray<float> lowerEdges;
+    ArenaArray<float> upperEdges;
+
+    /// LANES bands side by side, the feedback coefficients as their distance from a double pole at z = 1:
+    /// a1 close to -2 and a2 close to 1 lose the low bands' pole positions when rounded to float,
+    /// enough to move the centre gain and the edges of the lowest bands by tenths of a dB
+    struct Group
+    {
+        Reg b0[NUMSECTIONS] {}, nb0[NUMSECTIONS] {}, c1[NUMSECTIONS] {}, c2[NUMSECTIONS] {};
+        Reg z1[NUMSECTIONS] {}, z2[NUMSECTIONS] {};
+        Reg meanSquare {};
+    };
+    ArenaArray<Group> groups;
+
+#if JUCE_USE_SIMD
+    static Reg broadcast(float v) { return Reg::expand(v); }
+    static void setLane(Reg& r, int lane, float v) { r.set((size_t)lane, v); }
+    static float getLane(const Reg& r, int lane) { return r.get((size_t)lane); }
+#else
+    static Reg broadcast(float v) { return v; }
+    static void setLane(Reg& r, int, float v) { r = v; }
+    static float getLane(const Reg& r, int) { return r; }
+#endif
+
+    /// 6th order Butterworth band-pass f1..f2 as 3 sections b0*(1 - z^-2)/(1 + a1 z^-1 + a2 z^-2), 0 dB at fm
+    void designBand(double f1, double f2, double fm, double& b0, double* a1, double* a2) const
+    {
+        using C = std::complex<double>;
+        const double pi = juce::MathConstants<double>::pi;
+
+        // prewarped analog edges
+        const double w1 = 2.0*fs*std::tan(pi*f1/fs);
+        const double w2 = 2.0*fs*std::tan(pi*f2/fs);
+        const double w0sq = w1*w2;
+        const double bw = w2-w1;
+
+        // 3rd order lowpass prototype: one pole of the conjugate pair, and the real pole
+        // each becomes a band-pass pole pair s = (p*bw +- sqrt((p*bw)^2 - 4 w0^2))/2
+        const C upper = std::polar(1.0, 2.0*pi/3.0);
+        const C root = std::sqrt(upper*upper*bw*bw - 4.0*w0sq);
+        const C poles[NUMSECTIONS] = { (upper*bw+root)*0.5, (upper*bw-root)*0.5,
+                                       (-bw + std::sqrt(C(bw*bw - 4.0*w0sq)))*0.5 };
+
+        for (int s=0;s<NUMSECTIONS;s++)
+        {
+            // bilinear transform, each section takes the pole and its conjugate
+            const C z = (2.0*fs + poles[s])/(2.0*fs - poles[s]);
+            a1[s] = -2.0*z.real();
+            a2[s] = std::norm(z);
+        }
+
+        // normalize the cascade to unity at the centre, shared equally between the sections
+        const C zm = std::polar(1.0, -2.0*pi*fm/fs);
+        C response = 1.0;
+        for (int s=0;s<NUMSECTIONS;s++)
+            response *= (1.0 - zm*zm)/(1.0 + a1[s]*zm + a2[s]*zm*zm);
+        b0 = std::cbrt(1.0/std::abs(response));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(OctaveBank)
+};
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    PeakFinder.h
+    Created: 23 Oct 2026 8:47:35pm
+    Author:  Louis Deng
+
+    strongest spectral peaks of a trace, for labelling with frequency, note and
+    level
+
+    one linear scan over the dB levels: a bin is a peak when it is a local
+    maximum above the threshold. candidates go into a fixed-size min-heap of the
+    N strongest so far (one compare against its root for most of them), and only
+    the ones that get in are refined: a parabola through the peak and its two
+    neighbours on the log levels (Gaussian interpolation, close to exact for the
+    Hann window) gives the sub-bin position and the level at the top
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class PeakFinder
+{
+public:
+    static constexpr int MAXPEAKS = 8;
+
+    struct Peak
+    {
+        float bin = 0.0f;      // interpolated position, fractional bins
+        float level = 0.0f;    // interpolated level, dB as the input
+    };
+
+    PeakFinder()
+    {
+    }
+
+    ~PeakFinder()
+    {
+    }
+
+    /// how many peaks to keep, 0..MAXPEAKS
+    void setNumPeaks(int newNumPeaks) { maxPeaks = juce::jlimit(0, MAXPEAKS, newNumPeaks); }
+    int getMaxPeaks() const { return maxPeaks; }
+
+    /// levels at or below thresholdDB are never peaks
+    void setThreshold(float thresholdDB) { threshold = thresholdDB; }
+
+    /// scan numBins levels (dB), bin 0 (DC) is skipped, returns the number found, strongest first
+    int find(const float* dB, int numBins)
+    {
+        numPeaks = 0;
+        if (maxPeaks == 0)
+            return 0;
+
+        for (int bin=1;bin<numBins-1;bin++)
+        {
+            const float level = dB[bin];
+            if (level <= threshold || level <= dB[bin-1] || level < dB[bin+1])
+                continue;
+            if (numPeaks == maxPeaks && level <= heap[0].level)
+                continue;
+
+            const Peak peak = interpolate(dB, bin);
+            if (numPeaks < maxPeaks)
+            {
+                heap[numPeaks++] = peak;
+                std::push_heap(heap, heap+numPeaks, isStronger);
+            }
+            else
+            {
+                std::pop_heap(heap, heap+numPeaks, isStronger);
+                heap[numPeaks-1] = peak;
+                std::push_heap(heap, heap+numPeaks, isStronger);
+            }
+        }
+        std::sort_heap(heap, heap+numPeaks, isStronger);
+        return numPeaks;
+    }
+
+    int getNumPeaks() const { return numPeaks; }
+    /// after find(), strongest first
+    const Peak& getPeak(int index) const { return heap[index]; }
+
+private:
+    Peak heap[MAXPEAKS];
+    int numPeaks = 0;
+    int maxPeaks = 0;
+    float threshold = -120.0f;
+
+    /// min-heap order on the level, the weakest kept peak is at the root
+    static bool isStronger(const Peak& a, const Peak& b) { return a.level > b.level; }
+
+    static Peak interpolate(const float* dB, int bin)
+    {
+        const float alpha = dB[bin-1];
+        const float beta = dB[bin];
+        const float gamma = dB[bin+1];
+        const float curvature = alpha-2.0f*beta+gamma;
+        Peak peak;
+        if (curvature >= 0.0f)
+        {
+            // flat top, nothing to refine
+            peak.bin = (float)bin;
+            peak.level = beta;
+            return peak;
+        }
+        const float offset = juce::jlimit(-0.5f, 0.5f, 0.5f*(alpha-gamma)/curvature);
+        peak.bin = (float)bin+offset;
+        peak.level = beta-0.25f*(alpha-gamma)*offset;
+        return peak;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(PeakFinder)
+};
@@ -0,0 +1,305 @@
+/*
+  ==============================================================================
+
+    PercentileSpectrum.h
+    Created: 22 Oct 2026 9:27:02am
+    Author:  Louis Deng
+
+    long-term level statistics of a spectrum, percentiles per display band over
+    the last few minutes
+
+    every band keeps a histogram of its dB levels in 1 dB buckets (log buckets
+    of the magnitude). to forget old frames the window is cut into SLICES time
+    slices with a histogram each, plus their running total; when a slice is
+    full the oldest one is subtracted from the total and reused. memory is
+    fixed per band whatever the window length, and a percentile is one scan
+    over the buckets of the total. the slices, total and bucket scratch of a
+    sketch are one AnalyzerArena block, rebuilt when it is configured
+
+    PercentileSpectrum keeps a sketch per channel for the analysis engine, so
+    the statistics run on across editor sessions: the producing thread picks a
+    frame now and then and queues its levels at a fixed set of log spaced bins,
+    the message thread adds them to the sketches
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SpectrumUtil.h"
+#include "SpectrumFrames.h"
+#include "AnalyzerArena.h"
+
+class PercentileSketch
+{
+public:
+    /// time slices the window is cut into, the window slides by one slice at a time
+    static constexpr int SLICES = 8;
+    /// 1 dB buckets from the display floor up to TOPDB, levels outside are clamped
+    static constexpr float TOPDB = 160.0f;
+
+    PercentileSketch()
+    {
+    }
+
+    ~PercentileSketch()
+    {
+    }
+
+    /// (re)start with numBands bands over a window of windowSeconds, forgets all frames
+    void configure(int newNumBands, double windowSeconds)
+    {
+        numBands = newNumBands;
+        numBuckets = (int)(TOPDB-SpectrumUtil::FLOOR);
+        sliceMs = windowSeconds*1000.0/SLICES;
+        // zeroed by the allocation, so every configure starts from empty histograms
+        auto arena = std::make_unique<AnalyzerArena>();
+        const size_t slicesAt = arena->reserve<uint16_t>("percentile slices", (size_t)SLICES*numBands*numBuckets);
+        const size_t totalAt = arena->reserve<uint32_t>("percentile total", (size_t)numBands*numBuckets);
+        const size_t bucketsAt = arena->reserve<int>("percentile buckets", (size_t)numBands);
+        arena->allocate();
+        slices = arena->place<uint16_t>(slicesAt, (size_t)SLICES*numBands*numBuckets);
+        total = arena->place<uint32_t>(totalAt, (size_t)numBands*numBuckets);
+        bucketOfBand = arena->place<int>(bucketsAt, (size_t)numBands);
+        buffers = std::move(arena);
+        currentSlice = 0;
+        sliceStartMs = -1.0;
+        numFrames = 0;
+    }
+
+    int getNumBands() const { return numBands; }
+
+    /// bytes of the histograms, 0 before the first configure
+    size_t getMemoryBytes() const { return buffers == nullptr ? 0 : buffers->getTotalBytes(); }
+
+    /// add one frame of band levels (dB), nowMs a monotonic clock in milliseconds
+    void addFrame(const float* dB, double nowMs)
+    {
+        if (numBands == 0)
+            return;
+        if (sliceStartMs < 0.0)
+            sliceStartMs = nowMs;
+        while (nowMs-sliceStartMs >= sliceMs)
+        {
+            // after a long pause the whole window is stale, every slice goes
+            if (nowMs-sliceStartMs >= sliceMs*SLICES)
+            {
+                for (int i=0;i<SLICES;i++)
+                    advanceSlice();
+                sliceStartMs = nowMs;
+                break;
+            }
+            advanceSlice();
+            sliceStartMs += sliceMs;
+        }
+
+        // bucket indices for all bands first, a plain loop the compiler vectorizes
+        const float floorDB = SpectrumUtil::FLOOR;
+        const float topBucket = (float)(numBuckets-1);
+        int* buckets = bucketOfBand.data();
+        for (int band=0;band<numBands;band++)
+            buckets[band] = (int)juce::jlimit(0.0f, topBucket, dB[band]-floorDB);
+
+        uint16_t* slice = slices.data()+(size_t)currentSlice*numBands*numBuckets;
+        for (int band=0;band<numBands;band++)
+        {
+            const size_t i = (size_t)band*numBuckets+buckets[band];
+            // a slice saturates rather than wraps, only on absurdly long slices
+            if (slice[i] < std::numeric_limits<uint16_t>::max())
+            {
+                slice[i]++;
+                total[i]++;
+            }
+        }
+        numFrames++;
+    }
+
+    /// levels (dB) at the given fractions (0..1) for every band, out[p] holds numBands values
+    /// false while no frame has been added
+    bool getPercentiles(const float* fractions, int numFractions, std::vector<float>* out) const
+    {
+        if (numFrames == 0 || numBands == 0)
+            return false;
+        for (int p=0;p<numFractions;p++)
+            out[p].resize(numBands);
+
+        for (int band=0;band<numBands;band++)
+        {
+            const uint32_t* histogram = total.data()+(size_t)band*numBuckets;
+            uint32_t count = 0;
+            for (int b=0;b<numBuckets;b++)
+                count += histogram[b];
+
+            // fractions are met in ascending order during one cumulative scan
+            uint32_t below = 0;
+            int b = 0;
+            for (int p=0;p<numFractions;p++)
+            {
+                const float target = fractions[p]*(float)count;
+                while (b < numBuckets-1 && (float)(below+histogram[b]) < target)
+                    below += histogram[b++];
+                // spread evenly inside the bucket
+                const float within = histogram[b] > 0 ? (target-(float)below)/(float)histogram[b] : 0.0f;
+                out[p][band] = SpectrumUtil::FLOOR+(float)b+juce::jlimit(0.0f, 1.0f, within);
+            }
+        }
+        return true;
+    }
+
+private:
+    int numBands = 0;
+    int numBuckets = 0;
+    double sliceMs = 1000.0;
+
+    std::unique_ptr<AnalyzerArena> buffers;
+    ArenaArray<uint16_t> slices;    // SLICES x numBands x numBuckets
+    ArenaArray<uint32_t> total;     // numBands x numBuckets, sum of the slices
+    ArenaArray<int> bucketOfBand;
+    int currentSlice = 0;
+    double sliceStartMs = -1.0;
+    juce::int64 numFrames = 0;
+
+    /// drop the oldest slice from the total and reuse it for the frames to come
+    void advanceSlice()
+    {
+        currentSlice = (currentSlice+1) % SLICES;
+        const size_t sliceSize = (size_t)numBands*numBuckets;
+        uint16_t* oldest = slices.data()+(size_t)currentSlice*sliceSize;
+        for (size_t i=0;i<sliceSize;i++)
+            total[i] -= oldest[i];
+        std::fill(oldest, oldest+sliceSize, (uint16_t)0);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(PercentileSketch)
+};
+
+/// long-term statistics of the dry spectrum of both channels, subscribed to the analysis engine's frames
+class PercentileSpectrum : public SpectrumFrameConsumer
+{
+public:
+    /// log spaced bins the statistics are kept at, whatever the resolution
+    static constexpr int NUMBANDS = 256;
+    /// a frame per channel this often, plenty for a window of minutes
+    static constexpr double INTERVAL_S = 0.05;
+
+    PercentileSpectrum(): fifo(FIFOSIZE), slots(FIFOSIZE)
+    {
+        intervalTicks = juce::Time::secondsToHighResolutionTicks(INTERVAL_S);
+        bandBins.reserve(NUMBANDS);
+    }
+
+    ~PercentileSpectrum() override
+    {
+    }
+
+    /// producer stopped: statistics of numBins bins (a new resolution), forgets all frames
+    void setNumBins(int newNumBins)
+    {
+        numBins = newNumBins;
+        // from bin 1 up, a low bin picked by several bands is kept once
+        bandBins.clear();
+        for (int band=0;band<NUMBANDS;band++)
+        {
+            const int bin = juce::jlimit(1, numBins-1, (int)std::round(std::pow((double)(numBins-1), (double)band/(NUMBANDS-1))));
+            if (bandBins.empty() || bin > bandBins.back())
+                bandBins.push_back(bin);
+        }
+        restart();
+    }
+
+    /// producer stopped: a window of windowSeconds, 0 for off, forgets all frames
+    void setWindow(double windowSeconds)
+    {
+        windowS = windowSeconds;
+        restart();
+    }
+
+    /// producer stopped: forget all frames, when the analysis changed under the statistics
+    void restart()
+    {
+        const int numBands = windowS > 0.0 ? (int)bandBins.size() : 0;
+        for (auto& sketch : sketches)
+            sketch.configure(numBands, juce::jmax(1.0, windowS));
+        fifo.reset();
+        lastTicks[0] = lastTicks[1] = 0;
+        active.store(numBands > 0, std::memory_order_relaxed);
+    }
+
+    double getWindow() const { return windowS; }
+    int getNumBins() const { return numBins; }
+    /// the bin of every band, ascending
+    const std::vector<int>& getBandBins() const { return bandBins; }
+
+    /// producer: queue the dry levels of a frame at the band bins, every INTERVAL_S per channel, never allocates
+    void offer(const SpectrumFrameRef& frame) override
+    {
+        // zoom frames are on another axis
+        if (frame->zoomed || !active.load(std::memory_order_relaxed) || frame->numBins != (uint32_t)numBins)
+            return;
+        auto& last = lastTicks[frame->channel & 1];
+        if (frame->ticks-last < intervalTicks)
+            return;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        // the message thread has fallen behind, leave this one out
+        if (size1 == 0)
+            return;
+        last = frame->ticks;
+        auto& slot = slots[(size_t)start1];
+        slot.channel = frame->channel & 1;
+        slot.ticks = frame->ticks;
+        const float* dry = frame->getMagnitudes(0);
+        for (size_t band=0;band<bandBins.size();band++)
+            slot.levels[band] = dry[bandBins[band]];
+        SpectrumUtil::amp2db(slot.levels, nullptr, bandBins.size());
+        fifo.finishedWrite(1);
+    }
+
+    /// message thread: add the queued levels to the statistics
+    void collect()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+        for (int i=0;i<size1+size2;i++)
+        {
+            const auto& slot = slots[(size_t)(i < size1 ? start1+i : start2+i-size1)];
+            // timed by publication, so frames replayed from the history land where they belong
+            sketches[slot.channel].addFrame(slot.levels, juce::Time::highResolutionTicksToSeconds(slot.ticks)*1000.0);
+        }
+        fifo.finishedRead(size1+size2);
+    }
+
+    /// message thread: levels (dB, unweighted) at the given fractions for every band of a channel, false while there are none
+    bool getPercentiles(uint32_t channel, const float* fractions, int numFractions, std::vector<float>* out) const
+    {
+        return sketches[channel].getPercentiles(fractions, numFractions, out);
+    }
+
+    /// bytes of both sketches' histograms, the band map and the hand-over slots
+    size_t getMemoryBytes() const { return sketches[0].getMemoryBytes()+sketches[1].getMemoryBytes()+vectorBytes(bandBins)+vectorBytes(slots); }
+
+private:
+    /// room for the frames of the engine's history replayed at once
+    static constexpr int FIFOSIZE = 128;
+
+    struct Slot
+    {
+        uint32_t channel = 0;
+        juce::int64 ticks = 0;
+        float levels[NUMBANDS];
+    };
+
+    PercentileSketch sketches[2];
+    double windowS = 0.0;
+    int numBins = 0;
+    std::vector<int> bandBins;
+    std::atomic<bool> active { false };
+
+    // producer state, and the levels it hands over
+    juce::int64 intervalTicks = 0;
+    juce::int64 lastTicks[2] = { 0, 0 };
+    juce::AbstractFifo fifo;
+    std::vector<Slot> slots;
+
+    JUCE_DECLARE_NON_COPYABLE(PercentileSpectrum)
+};
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    PinnedTones.h
+    Created: 21 Oct 2026 6:48:20pm
+    Author:  Louis Deng
+
+    sliding DFT bank tracking the level of a few pinned frequencies (pilot
+    tones, hum harmonics, feedback) sample by sample, without waiting for a hop
+
+    every pinned frequency f keeps three sliding DFT sums over the last
+    N samples, at f and f +- fs/N. their combination 0.5 S(f) - 0.25 S(f-fs/N)
+    - 0.25 S(f+fs/N) is the Hann windowed DFT at f, so the level has the same
+    leakage behaviour as the fft units. each sum updates in O(1) per sample:
+
+        S_n = e^(jw) (S_n-1 - x[n-N]) + x[n] e^(-jw(N-1))
+
+    the sums are kept as plain structure-of-arrays loops over all lanes, which
+    the compiler vectorizes, in double because the recursion has its pole on
+    the unit circle and would otherwise collect rounding drift. cost is per
+    pinned frequency and per sample, independent of the fft size. the delay
+    line and the lanes are one AnalyzerArena block, rebuilt by configure
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AnalyzerArena.h"
+
+class PinnedToneBank
+{
+public:
+    /// most frequencies one bank tracks
+    static constexpr int MAXPINNED = 64;
+
+    PinnedToneBank()
+    {
+    }
+
+    ~PinnedToneBank()
+    {
+    }
+
+    /// message thread, while no audio thread is processing: track the given frequencies over a
+    /// Hann window of windowSeconds, frequencies beyond MAXPINNED or outside 0..Nyquist are ignored
+    void configure(const std::vector<float>& frequencies, double sampleRate, double windowSeconds)
+    {
+        windowSize = juce::jlimit(64, 1 << 15, juce::roundToInt(windowSeconds*sampleRate));
+        historyPos = 0;
+
+        numPinned = 0;
+        std::vector<double> omegas;
+        for (float f : frequencies)
+        {
+            if (numPinned == MAXPINNED || f <= 0.0f || f >= 0.5*sampleRate)
+                continue;
+            const double w = juce::MathConstants<double>::twoPi*f/sampleRate;
+            const double dw = juce::MathConstants<double>::twoPi/windowSize;
+            // lanes of a pin sit side by side: f, f - fs/N, f + fs/N
+            for (double omega : { w, w-dw, w+dw })
+                omegas.push_back(omega);
+            pinnedFrequencies[numPinned++] = f;
+        }
+
+        // zeroed by the allocation: an empty delay line and sums
+        const size_t numLanes = omegas.size();
+        auto arena = std::make_unique<AnalyzerArena>();
+        const size_t historyAt = arena->reserve<float>("pinned history", (size_t)windowSize);
+        const size_t lanesAt[6] = { arena->reserve<double>("pinned rotate re", numLanes), arena->reserve<double>("pinned rotate im", numLanes),
+                                    arena->reserve<double>("pinned entry re", numLanes), arena->reserve<double>("pinned entry im", numLanes),
+                                    arena->reserve<double>("pinned sum re", numLanes), arena->reserve<double>("pinned sum im", numLanes) };
+        arena->allocate();
+        history = arena->place<float>(historyAt, (size_t)windowSize);
+        rotateRe = arena->place<double>(lanesAt[0], numLanes);
+        rotateIm = arena->place<double>(lanesAt[1], numLanes);
+        entryRe = arena->place<double>(lanesAt[2], numLanes);
+        entryIm = arena->place<double>(lanesAt[3], numLanes);
+        sumRe = arena->place<double>(lanesAt[4], numLanes);
+        sumIm = arena->place<double>(lanesAt[5], numLanes);
+        buffers = std::move(arena);
+        for (size_t l=0;l<numLanes;l++)
+        {
+            rotateRe[l] = std::cos(omegas[l]);
+            rotateIm[l] = std::sin(omegas[l]);
+            entryRe[l] = std::cos(omegas[l]*(windowSize-1));
+            entryIm[l] = -std::sin(omegas[l]*(windowSize-1));
+        }
+        for (auto& amplitude : amplitudes)
+            amplitude.store(0.0f);
+    }
+
+    int getNumPinned() const { return numPinned; }
+    float getFrequency(int pin) const { return pinnedFrequencies[pin]; }
+
+    /// audio thread: slide every sum through a block, then refresh the levels
+    void processBlock(const float* input, int numSamples)
+    {
+        if (numPinned == 0)
+            return;
+
+        const int numLanes = numPinned*3;
+        double* sRe = sumRe.data();
+        double* sIm = sumIm.data();
+        const double* cRe = rotateRe.data();
+        const double* cIm = rotateIm.data();
+        const double* eRe = entryRe.data();
+        const double* eIm = entryIm.data();
+
+        for (int i=0;i<numSamples;i++)
+        {
+            const double x = input[i];
+            const double leaving = history[historyPos];
+            history[historyPos] = input[i];
+            historyPos = historyPos+1 == windowSize ? 0 : historyPos+1;
+
+            for (int l=0;l<numLanes;l++)
+            {
+                const double re = sRe[l]-leaving;
+                const double im = sIm[l];
+                sRe[l] = cRe[l]*re - cIm[l]*im + x*eRe[l];
+                sIm[l] = cRe[l]*im + cIm[l]*re + x*eIm[l];
+            }
+        }
+
+        // a sine of amplitude A reads A*N/4 through the Hann combination
+        const double toAmplitude = 4.0/windowSize;
+        for (int pin=0;pin<numPinned;pin++)
+        {
+            const int l = pin*3;
+            const double re = 0.5*sRe[l] - 0.25*(sRe[l+1]+sRe[l+2]);
+            const double im = 0.5*sIm[l] - 0.25*(sIm[l+1]+sIm[l+2]);
+            amplitudes[pin].store((float)(std::sqrt(re*re+im*im)*toAmplitude), std::memory_order_relaxed);
+        }
+    }
+
+    /// peak amplitude of a pinned sine as of the last processed block, any thread
+    float getAmplitude(int pin) const { return amplitudes[pin].load(std::memory_order_relaxed); }
+
+    /// bytes of the delay line and lanes, none before the first configure
+    size_t getMemoryBytes() const { return buffers != nullptr ? buffers->getTotalBytes() : 0; }
+
+private:
+    int numPinned = 0;
+    float pinnedFrequencies[MAXPINNED] {};
+    std::atomic<float> amplitudes[MAXPINNED] {};
+
+    // input delay line, the sample leaving the window
+    std::unique_ptr<AnalyzerArena> buffers;
+    int windowSize = 64;
+    ArenaArray<float> history;
+    int historyPos = 0;
+
+    // per lane: e^(jw), e^(-jw(N-1)) and the running sum
+    ArenaArray<double> rotateRe, rotateIm;
+    ArenaArray<double> entryRe, entryIm;
+    ArenaArray<double> sumRe, sumIm;
+
+    JUCE_DECLARE_NON_COPYABLE(PinnedToneBank)
+};
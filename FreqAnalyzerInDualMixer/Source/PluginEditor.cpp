@@ -15,7 +15,7 @@ FreqAnalyzerInDualMixerAudioProcessorEditor::FreqAnalyzerInDualMixerAudioProcess
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (660, 580);
+    setSize (660, 610);
     setResizable(false, false);
     
     
@@ -28,20 +28,259 @@ FreqAnalyzerInDualMixerAudioProcessorEditor::FreqAnalyzerInDualMixerAudioProcess
     //true is to the left, false is above
     mDWMixKnobLabel.attachToComponent (&mDWMixKnob, false);
     mDWMixKnob.setBounds(20, 90, 120, 120);
-    mDWMixKnob.addListener(this);
     mDWMixKnobAtt.reset (new SliderAttachment (valueTreeState, "00-allmix", mDWMixKnob));
     
-    freqAnalyzerPtr.reset( new FreqAnalyzer );
-    for(int i=0; i<2; i++){
-        audioProcessor.mDWM[i]->communicateFreqAnalyzerPtr(freqAnalyzerPtr);
+    // analyzer resolution, item ids are the fft order and the overlap shift + 1
+    addAndMakeVisible(mFFTSizeBox);
+    mFFTSizeBox.addItem("2048", 11);
+    mFFTSizeBox.addItem("4096", 12);
+    mFFTSizeBox.addItem("8192", 13);
+    // the selection is kept in the state, the engine may be running below it on a reduced quality tier
+    mFFTSizeBox.setSelectedId((int)valueTreeState.state.getProperty("fftOrder", (int)FFTORDER_T), juce::dontSendNotification);
+    mFFTSizeBoxLabel.setText ("FFT Size", juce::dontSendNotification);
+    mFFTSizeBoxLabel.attachToComponent (&mFFTSizeBox, false);
+    mFFTSizeBox.setBounds(180, 110, 120, 24);
+    mFFTSizeBox.onChange = [this] { analyzerResolutionChanged(); };
+    
+    addAndMakeVisible(mOverlapBox);
+    mOverlapBox.addItem("0 %", 1);
+    mOverlapBox.addItem("50 %", 2);
+    mOverlapBox.addItem("75 %", 3);
+    mOverlapBox.setSelectedId((int)valueTreeState.state.getProperty("overlapShift", (int)(FFTORDER_T-FFTORDER_A))+1, juce::dontSendNotification);
+    mOverlapBoxLabel.setText ("Overlap", juce::dontSendNotification);
+    mOverlapBoxLabel.attachToComponent (&mOverlapBox, false);
+    mOverlapBox.setBounds(320, 110, 120, 24);
+    mOverlapBox.onChange = [this] { analyzerResolutionChanged(); };
+    
+    // item ids are the bands per octave, 1 for fft, 2 for zoom fft
+    addAndMakeVisible(mAnalysisModeBox);
+    mAnalysisModeBox.addItem("FFT", 1);
+    mAnalysisModeBox.addItem("Zoom FFT", 2);
+    mAnalysisModeBox.addItem("RTA 1/3 oct", 3);
+    mAnalysisModeBox.addItem("RTA 1/6 oct", 6);
+    auto& engine = audioProcessor.getAnalysisEngine();
+    mAnalysisModeBox.setSelectedId(engine.getRTABandsPerOctave() > 0 ? engine.getRTABandsPerOctave() : (engine.isZoomed() ? 2 : 1), juce::dontSendNotification);
+    mAnalysisModeBoxLabel.setText ("Analysis", juce::dontSendNotification);
+    mAnalysisModeBoxLabel.attachToComponent (&mAnalysisModeBox, false);
+    mAnalysisModeBox.setBounds(180, 250, 120, 24);
+    mAnalysisModeBox.onChange = [this] { analysisModeChanged(); };
+    
+    addChildComponent(mZoomRange);
+    mZoomRange.setSliderStyle(juce::Slider::TwoValueHorizontal);
+    mZoomRange.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+    mZoomRange.setRange(10.0, 20000.0, 0.1);
+    mZoomRange.setSkewFactorFromMidPoint(500.0);
+    if (engine.isZoomed())
+        mZoomRange.setMinAndMaxValues(engine.getZoomLow(), engine.getZoomHigh(), juce::dontSendNotification);
+    else
+        mZoomRange.setMinAndMaxValues(40.0, 80.0, juce::dontSendNotification);
+    mZoomRange.setVisible(engine.isZoomed());
+    mZoomRangeLabel.setText ("Zoom " + juce::String(mZoomRange.getMinValue(), 1) + " - " + juce::String(mZoomRange.getMaxValue(), 1) + " Hz", juce::dontSendNotification);
+    mZoomRangeLabel.attachToComponent (&mZoomRange, false);
+    mZoomRange.setBounds(310, 250, 140, 24);
+    // rebuilt when the drag ends, a zoom restart refills several seconds of signal
+    mZoomRange.onDragEnd = [this] { analysisModeChanged(); };
+    
+    addAndMakeVisible(mPinnedEditor);
+    mPinnedEditor.setTextToShowWhenEmpty("Pin Hz, e.g. 50, 100, 1000", juce::Colours::grey);
+    juce::StringArray pinnedText;
+    for (float frequency : engine.getPinnedFrequencies())
+        pinnedText.add(juce::String(frequency, 1));
+    mPinnedEditor.setText(pinnedText.joinIntoString(", "), false);
+    mPinnedEditor.setBounds(470, 258, 170, 24);
+    mPinnedEditor.onReturnKey = [this] { pinnedChanged(); };
+    mPinnedEditor.onFocusLost = [this] { pinnedChanged(); };
+    
+    for (int inout=0;inout<2;inout++)
+    {
+        addAndMakeVisible(mLoudnessLabels[inout]);
+        mLoudnessLabels[inout].setBounds(180, 26+22*inout, 460, 20);
     }
+    addAndMakeVisible(mLoudnessResetButton);
+    mLoudnessResetButton.setButtonText("Reset loudness");
+    mLoudnessResetButton.setBounds(20, 26, 120, 22);
+    mLoudnessResetButton.onClick = [this]
+    {
+        audioProcessor.getLoudnessMeter(0).reset();
+        audioProcessor.getLoudnessMeter(1).reset();
+    };
+    
+    // weighting and tilt are a view setting, kept in the state like the resolution
+    addAndMakeVisible(mWeightingBox);
+    mWeightingBox.addItem("Flat", WeightingTable::flat+1);
+    mWeightingBox.addItem("A-weighting", WeightingTable::aWeighting+1);
+    mWeightingBox.addItem("C-weighting", WeightingTable::cWeighting+1);
+    mWeightingBox.addItem("ITU-R 468", WeightingTable::itu468+1);
+    mWeightingBox.setSelectedId((int)valueTreeState.state.getProperty("weighting", (int)WeightingTable::flat)+1, juce::dontSendNotification);
+    mWeightingBox.setBounds(180, 69, 120, 20);
+    mWeightingBox.onChange = [this] { weightingChanged(); };
+    
+    addAndMakeVisible(mTiltBox);
+    mTiltBox.addItem("No tilt", 1);
+    mTiltBox.addItem("+3 dB/oct", 2);
+    mTiltBox.addItem("+4.5 dB/oct", 3);
+    mTiltBox.addItem("+6 dB/oct", 4);
+    mTiltBox.setSelectedId((int)valueTreeState.state.getProperty("tilt", 1), juce::dontSendNotification);
+    mTiltBox.setBounds(320, 69, 120, 20);
+    mTiltBox.onChange = [this] { weightingChanged(); };
+    
+    addAndMakeVisible(mPeaksBox);
+    mPeaksBox.addItem("No peaks", 1);
+    mPeaksBox.addItem("3 peaks", 4);
+    mPeaksBox.addItem("5 peaks", 6);
+    mPeaksBox.addItem("8 peaks", 9);
+    mPeaksBox.setSelectedId((int)valueTreeState.state.getProperty("peaks", 0)+1, juce::dontSendNotification);
+    mPeaksBox.setBounds(460, 69, 120, 20);
+    mPeaksBox.onChange = [this]
+    {
+        valueTreeState.state.setProperty("peaks", mPeaksBox.getSelectedId()-1, nullptr);
+        freqAnalyzerPtr->setPeaks(mPeaksBox.getSelectedId()-1);
+    };
+    
+    addAndMakeVisible(mPercentileBox);
+    mPercentileBox.addItem("Off", 1);
+    mPercentileBox.addItem("1 min", 2);
+    mPercentileBox.addItem("5 min", 6);
+    mPercentileBox.addItem("15 min", 16);
+    // the statistics run in the engine, an open window carries on from the last session
+    mPercentileBox.setSelectedId((int)(engine.getPercentileWindow()/60.0)+1, juce::dontSendNotification);
+    mPercentileBoxLabel.setText ("Percentiles", juce::dontSendNotification);
+    mPercentileBoxLabel.attachToComponent (&mPercentileBox, false);
+    mPercentileBox.setBounds(20, 258, 120, 24);
+    mPercentileBox.onChange = [this]
+    {
+        // the statistics restart from the engine's history, read while the audio thread is kept away
+        audioProcessor.detachAnalyzer();
+        freqAnalyzerPtr->setPercentileWindow(60.0*(mPercentileBox.getSelectedId()-1));
+        // during playback it stays detached until back to live
+        if (captureReader == nullptr)
+            audioProcessor.attachAnalyzer();
+    };
+    
+    // the view subscribes to the engine and starts from its history, no analysis is set up here
+    audioProcessor.detachAnalyzer();
+    // kept by default, the engine ran on while closed; otherwise its frames are from the last session
+    if (!audioProcessor.getKeepHistory())
+        engine.clearHistory();
+    freqAnalyzerPtr.reset( new FreqAnalyzer(engine) );
+    audioProcessor.setEditorOpen(true);
+    audioProcessor.attachAnalyzer();
     addAndMakeVisible(*freqAnalyzerPtr);
     freqAnalyzerPtr->setBounds(15, 295, 630, 270);
+    weightingChanged();
+    freqAnalyzerPtr->setPeaks(mPeaksBox.getSelectedId()-1);
+    
+    // capture to disk / playback
+    addAndMakeVisible(mCaptureButton);
+    mCaptureButton.setButtonText(audioProcessor.getSpectrumCapture().isCapturing() ? "Stop capture" : "Start capture");
+    mCaptureButton.setBounds(470, 90, 170, 24);
+    mCaptureButton.onClick = [this] { captureButtonClicked(); };
+    
+    addAndMakeVisible(mOpenCaptureButton);
+    mOpenCaptureButton.setButtonText("Open capture...");
+    mOpenCaptureButton.setBounds(470, 125, 170, 24);
+    mOpenCaptureButton.onClick = [this] { openCaptureClicked(); };
+    
+    addChildComponent(mCapturePosition);
+    mCapturePosition.setSliderStyle(juce::Slider::LinearHorizontal);
+    mCapturePosition.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
+    mCapturePosition.setBounds(470, 160, 170, 24);
+    mCapturePosition.onValueChange = [this]
+    {
+        if (captureReader != nullptr)
+            freqAnalyzerPtr->showCapturedFrame(*captureReader, (juce::int64)mCapturePosition.getValue());
+    };
+    
+    addChildComponent(mLiveButton);
+    mLiveButton.setButtonText("Back to live");
+    mLiveButton.setBounds(470, 195, 170, 24);
+    mLiveButton.onClick = [this] { backToLive(); };
+    
+    addAndMakeVisible(mReferenceLabel);
+    mReferenceLabel.setText("Drop an audio file for reference", juce::dontSendNotification);
+    mReferenceLabel.setBounds(470, 230, 170, 20);
+    
+    addAndMakeVisible(mDirectRenderButton);
+    mDirectRenderButton.setButtonText("Direct trace rendering");
+    mDirectRenderButton.setBounds(180, 190, 170, 24);
+    mDirectRenderButton.onClick = [this] { freqAnalyzerPtr->setDirectRendering(mDirectRenderButton.getToggleState()); };
+    
+    addAndMakeVisible(mStereoScopeButton);
+    mStereoScopeButton.setButtonText("Stereo scope");
+    mStereoScopeButton.setToggleState(engine.isStereoScopeOn(), juce::dontSendNotification);
+    mStereoScopeButton.setBounds(355, 190, 110, 24);
+    mStereoScopeButton.onClick = [this]
+    {
+        const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+        audioProcessor.detachAnalyzer();
+        freqAnalyzerPtr->setStereoScope(mStereoScopeButton.getToggleState(), sampleRate);
+        // during playback it stays detached until back to live
+        if (captureReader == nullptr)
+            audioProcessor.attachAnalyzer();
+    };
+    
+    addAndMakeVisible(mKeepHistoryButton);
+    mKeepHistoryButton.setButtonText("Keep history");
+    mKeepHistoryButton.setToggleState(audioProcessor.getKeepHistory(), juce::dontSendNotification);
+    mKeepHistoryButton.setBounds(20, 50, 150, 20);
+    mKeepHistoryButton.onClick = [this] { audioProcessor.setKeepHistory(mKeepHistoryButton.getToggleState()); };
+    
+    addAndMakeVisible(mOverlayButton);
+    mOverlayButton.setButtonText("Overlay...");
+    mOverlayButton.setBounds(20, 214, 120, 22);
+    mOverlayButton.onClick = [this] { overlayButtonClicked(); };
+    
+    // sweep measurement, below the analyzer
+    addAndMakeVisible(mSweepButton);
+    mSweepButton.setButtonText("Measure sweep");
+    mSweepButton.setBounds(15, 575, 120, 24);
+    mSweepButton.onClick = [this] { sweepButtonClicked(); };
+    
+    addAndMakeVisible(mSweepLengthBox);
+    mSweepLengthBox.addItem("2 s sweep", 2);
+    mSweepLengthBox.addItem("5 s sweep", 5);
+    mSweepLengthBox.addItem("10 s sweep", 10);
+    mSweepLengthBox.setSelectedId((int)valueTreeState.state.getProperty("sweepLength", 5), juce::dontSendNotification);
+    mSweepLengthBox.setBounds(145, 575, 90, 24);
+    mSweepLengthBox.onChange = [this] { valueTreeState.state.setProperty("sweepLength", mSweepLengthBox.getSelectedId(), nullptr); };
+    
+    addAndMakeVisible(mSweepStatusLabel);
+    mSweepStatusLabel.setBounds(245, 575, 260, 24);
+    
+    addAndMakeVisible(mSweepResultButton);
+    mSweepResultButton.setButtonText("Show result");
+    mSweepResultButton.setEnabled(false);
+    mSweepResultButton.setBounds(515, 575, 130, 24);
+    mSweepResultButton.onClick = [this]
+    {
+        sweepResultView.setVisible(!sweepResultView.isVisible());
+        mSweepResultButton.setButtonText(sweepResultView.isVisible() ? "Hide result" : "Show result");
+    };
+    
+    // over the analyzer
+    addChildComponent(sweepResultView);
+    sweepResultView.setBounds(15, 295, 630, 270);
+    updateSweep();
+    
+    addAndMakeVisible(mQualityLabel);
+    mQualityLabel.setBounds(180, 160, 260, 20);
+    applyQualityTier(audioProcessor.getQualityGovernor().getTier());
+    // also picks up partial file analysis results, so a bit faster than the governor needs
+    startTimerHz(10);
     
 }
 
 FreqAnalyzerInDualMixerAudioProcessorEditor::~FreqAnalyzerInDualMixerAudioProcessorEditor()
 {
+    stopTimer();
+    fileAnalysis.cancel();
+    // the overlaid instances can stop analyzing for this editor
+    setOverlayInstances({});
+    // the view unsubscribes while the audio thread is kept away, the engine then carries on without it
+    audioProcessor.detachAnalyzer();
+    freqAnalyzerPtr.reset();
+    audioProcessor.setEditorOpen(false);
+    audioProcessor.attachAnalyzer();
 }
 
 //==============================================================================
@@ -61,13 +300,326 @@ void FreqAnalyzerInDualMixerAudioProcessorEditor::resized()
     // subcomponents in your editor..
 }
 
-void FreqAnalyzerInDualMixerAudioProcessorEditor::sliderValueChanged(juce::Slider* sliderRef)
+void FreqAnalyzerInDualMixerAudioProcessorEditor::analyzerResolutionChanged()
+{
+    valueTreeState.state.setProperty("fftOrder", mFFTSizeBox.getSelectedId(), nullptr);
+    valueTreeState.state.setProperty("overlapShift", mOverlapBox.getSelectedId()-1, nullptr);
+    // during playback the new resolution is applied when going back to live
+    if (captureReader == nullptr)
+        applyQualityTier(appliedTier);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::analysisModeChanged()
+{
+    const int id = mAnalysisModeBox.getSelectedId();
+    const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+    const bool zoomed = id == 2;
+    mZoomRange.setVisible(zoomed);
+    mZoomRangeLabel.setText ("Zoom " + juce::String(mZoomRange.getMinValue(), 1) + " - " + juce::String(mZoomRange.getMaxValue(), 1) + " Hz", juce::dontSendNotification);
+    
+    audioProcessor.detachAnalyzer();
+    freqAnalyzerPtr->setRTA(id >= 3 ? id : 0, sampleRate);
+    if (zoomed)
+        freqAnalyzerPtr->setZoom((float)mZoomRange.getMinValue(), (float)mZoomRange.getMaxValue(), sampleRate);
+    else
+        freqAnalyzerPtr->setZoom(0.0f, 0.0f, sampleRate);
+    // during playback it stays detached until back to live
+    if (captureReader == nullptr)
+        audioProcessor.attachAnalyzer();
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::pinnedChanged()
+{
+    std::vector<float> frequencies;
+    for (const auto& token : juce::StringArray::fromTokens(mPinnedEditor.getText(), ", ;", ""))
+        if (token.getFloatValue() > 0.0f)
+            frequencies.push_back(token.getFloatValue());
+    const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+    
+    audioProcessor.detachAnalyzer();
+    freqAnalyzerPtr->setPinned(frequencies, sampleRate);
+    // during playback it stays detached until back to live
+    if (captureReader == nullptr)
+        audioProcessor.attachAnalyzer();
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::weightingChanged()
+{
+    static constexpr float tilts[] = { 0.0f, 3.0f, 4.5f, 6.0f };
+    const int curve = mWeightingBox.getSelectedId()-1;
+    const int tiltId = juce::jlimit(1, 4, mTiltBox.getSelectedId());
+    valueTreeState.state.setProperty("weighting", curve, nullptr);
+    valueTreeState.state.setProperty("tilt", tiltId, nullptr);
+    
+    const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+    weightingSampleRate = sampleRate;
+    freqAnalyzerPtr->setWeighting((WeightingTable::Curve)juce::jlimit(0, (int)WeightingTable::itu468, curve), tilts[tiltId-1], sampleRate);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::applyQualityTier(int tier)
+{
+    const auto settings = QualityGovernor::getSettings(tier, (uint32_t)mFFTSizeBox.getSelectedId(), (uint32_t)(mOverlapBox.getSelectedId()-1), FFTORDER_MIN);
+    
+    // the new resolution's buffers are allocated while the audio thread still runs the old ones,
+    // it is only kept away while they are swapped in; a change of the right channel restarts both channels on new ones too
+    std::unique_ptr<AnalysisStorage> storage;
+    if (settings.order != freqAnalyzerPtr->getOrder() || settings.overlapShift != freqAnalyzerPtr->getOverlapShift()
+        || settings.analyzeRight != freqAnalyzerPtr->isAnalyzingRight())
+        storage = std::make_unique<AnalysisStorage>(settings.order, settings.overlapShift);
+    audioProcessor.detachAnalyzer();
+    storage = freqAnalyzerPtr->setReducedLoad(settings.frameDivider, settings.analyzeRight, std::move(storage));
+    audioProcessor.attachAnalyzer();
+    // and the old ones freed once it has them
+    storage.reset();
+    
+    appliedTier = tier;
+    const size_t memoryBytes = audioProcessor.getMemoryBytes()+freqAnalyzerPtr->getMemoryBytes();
+    mQualityLabel.setText("Analysis quality: " + QualityGovernor::getTierName(tier)
+                          + ", " + juce::String((int)((memoryBytes+512)/1024)) + " KB", juce::dontSendNotification);
+    DBG(audioProcessor.getMemoryReport() + "\n" + freqAnalyzerPtr->getMemoryReport());
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::timerCallback()
+{
+    const int tier = audioProcessor.getQualityGovernor().getTier();
+    if (tier != appliedTier && captureReader == nullptr)
+        applyQualityTier(tier);
+    
+    // prepareToPlay at another rate moves every bin, the weighting table and the peak labels' axis follow it,
+    // and the engine rebuilds its pinned tones, RTA bands, zoom and stereo scope for it
+    if (audioProcessor.getSampleRate() > 0.0 && audioProcessor.getSampleRate() != weightingSampleRate)
+        weightingChanged();
+    if (audioProcessor.getSampleRate() > 0.0 && audioProcessor.getSampleRate() != freqAnalyzerPtr->getEngine().getSampleRate())
+    {
+        audioProcessor.detachAnalyzer();
+        freqAnalyzerPtr->setSampleRate(audioProcessor.getSampleRate());
+        // during playback it stays detached until back to live
+        if (captureReader == nullptr)
+            audioProcessor.attachAnalyzer();
+    }
+    
+    updateReference();
+    updateLoudness();
+    updateSweep();
+    
+    // instances removed from the session drop out of the overlay
+    const auto& hub = audioProcessor.getAnalyzerHub();
+    std::vector<AnalyzerHub::InstanceRef> current;
+    for (const auto& instance : overlayInstances)
+        if (hub.isCurrent(instance))
+            current.push_back(instance);
+    if (current.size() != overlayInstances.size())
+        setOverlayInstances(current);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::overlayButtonClicked()
+{
+    auto& hub = audioProcessor.getAnalyzerHub();
+    juce::PopupMenu menu;
+    for (int slot=0;slot<AnalyzerHub::MAXINSTANCES;slot++)
+    {
+        if (slot == audioProcessor.getHubSlot() || !hub.isLive(slot))
+            continue;
+        const auto instance = hub.getInstance(slot);
+        const bool shown = std::find(overlayInstances.begin(), overlayInstances.end(), instance) != overlayInstances.end();
+        menu.addItem(slot+1, hub.getName(slot), true, shown);
+    }
+    if (menu.getNumItems() == 0)
+        menu.addItem(-1, "No other instances", false);
+    
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&mOverlayButton), [this] (int result)
+    {
+        auto& hub = audioProcessor.getAnalyzerHub();
+        if (result <= 0 || !hub.isLive(result-1))
+            return;
+        const auto instance = hub.getInstance(result-1);
+        auto instances = overlayInstances;
+        const auto found = std::find(instances.begin(), instances.end(), instance);
+        if (found != instances.end())
+            instances.erase(found);
+        else
+            instances.push_back(instance);
+        setOverlayInstances(instances);
+    });
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::setOverlayInstances(const std::vector<AnalyzerHub::InstanceRef>& instances)
+{
+    auto& hub = audioProcessor.getAnalyzerHub();
+    // watch the new list before letting go of the old one, so a kept instance never stops publishing
+    for (const auto& instance : instances)
+        hub.watch(instance.slot);
+    for (const auto& instance : overlayInstances)
+        hub.unwatch(instance.slot);
+    overlayInstances = instances;
+    
+    const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+    freqAnalyzerPtr->setOverlays(&hub, overlayInstances, sampleRate);
+    mOverlayButton.setButtonText(overlayInstances.empty() ? "Overlay..." : "Overlay (" + juce::String((int)overlayInstances.size()) + ")...");
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::updateLoudness()
+{
+    for (int inout=0;inout<2;inout++)
+    {
+        const auto& meter = audioProcessor.getLoudnessMeter(inout);
+        mLoudnessLabels[inout].setText(juce::String(inout == 0 ? "In " : "Out")
+                                        + "   M " + juce::String(meter.getMomentary(), 1)
+                                        + "   S " + juce::String(meter.getShortTerm(), 1)
+                                        + "   I " + juce::String(meter.getIntegrated(), 1) + " LUFS"
+                                        + "   TP " + juce::String(meter.getTruePeak(), 1) + " dBTP",
+                                        juce::dontSendNotification);
+    }
+}
+
+bool FreqAnalyzerInDualMixerAudioProcessorEditor::isInterestedInFileDrag(const juce::StringArray& files)
+{
+    for (int i=0;i<files.size();i++)
+        if (FileAnalysis::canAnalyze(files[i]))
+            return true;
+    return false;
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::filesDropped(const juce::StringArray& files, int, int)
 {
-    if (sliderRef == &mDWMixKnob)
+    for (int i=0;i<files.size();i++)
     {
-        for(int i=0; i<2; i++){
-            audioProcessor.mDWM[i]->injectProportion(0.0f);
+        if (!FileAnalysis::canAnalyze(files[i]))
+            continue;
+        
+        const juce::File file(files[i]);
+        // analyzed at the selected fft size, shown whenever the display runs at that size
+        if (fileAnalysis.start(file, (uint32_t)mFFTSizeBox.getSelectedId()))
+        {
+            referenceName = file.getFileName();
+            updateReference();
+        }
+        else
+        {
+            mReferenceLabel.setText("Could not read " + file.getFileName(), juce::dontSendNotification);
         }
+        return;
+    }
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::updateReference()
+{
+    if (!fileAnalysis.getResultsIfNew(referenceVersion, referenceResults))
+        return;
+    
+    const auto& r = referenceResults;
+    freqAnalyzerPtr->setReference(r.averageDB[0], r.averageDB[1]);
+    freqAnalyzerPtr->setReferenceSpectrogram(r.spectrogramDB, FileAnalysis::SPECTROGRAMROWS, r.numBins);
+    mReferenceLabel.setText(referenceName + " " + juce::String(juce::roundToInt(r.progress*100.0f)) + " %", juce::dontSendNotification);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::sweepButtonClicked()
+{
+    auto& sweep = audioProcessor.getSweepMeasurement();
+    const auto state = sweep.getState();
+    if (state == SweepMeasurement::running || state == SweepMeasurement::analysing)
+        sweep.cancel();
+    else
+    {
+        const double sampleRate = audioProcessor.getSampleRate() > 0.0 ? audioProcessor.getSampleRate() : (double)SR_DEFAULT;
+        sweep.start(sampleRate, (double)mSweepLengthBox.getSelectedId(), SweepMeasurement::DEFAULTLEVEL_DB);
     }
+    updateSweep();
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::updateSweep()
+{
+    auto& sweep = audioProcessor.getSweepMeasurement();
+    if (sweep.getResultsIfNew(sweepVersion, sweepResults))
+    {
+        sweepResultView.setResults(sweepResults);
+        mSweepResultButton.setEnabled(true);
+    }
+    
+    const auto state = sweep.getState();
+    const int percent = juce::roundToInt(sweep.getProgress()*100.0f);
+    const bool measuring = state == SweepMeasurement::running || state == SweepMeasurement::analysing;
+    mSweepButton.setButtonText(measuring ? "Cancel" : "Measure sweep");
+    mSweepLengthBox.setEnabled(!measuring);
+    juce::String status;
+    switch (state)
+    {
+        case SweepMeasurement::running:
+            status = "Sweeping (replaces the input) " + juce::String(percent) + " %";
+            break;
+        case SweepMeasurement::analysing:
+            status = "Analysing " + juce::String(percent) + " %";
+            break;
+        case SweepMeasurement::done:
+            status = "Latency " + juce::String(sweepResults.latency) + " smps";
+            break;
+        case SweepMeasurement::failed:
+            status = "No sweep in the recording";
+            break;
+        case SweepMeasurement::idle:
+        default:
+            break;
+    }
+    mSweepStatusLabel.setText(status, juce::dontSendNotification);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::captureButtonClicked()
+{
+    auto& capture = audioProcessor.getSpectrumCapture();
+    if (capture.isCapturing())
+    {
+        capture.stop();
+        DBG("capture stopped, dropped frames: " + juce::String(capture.getDroppedFrames()));
+    }
+    else
+    {
+        auto directory = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("FreqAnalyzer Captures");
+        directory.createDirectory();
+        capture.start(directory);
+    }
+    mCaptureButton.setButtonText(capture.isCapturing() ? "Stop capture" : "Start capture");
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::openCaptureClicked()
+{
+    captureChooser.reset(new juce::FileChooser("Open spectrum capture",
+                                               juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("FreqAnalyzer Captures"),
+                                               "*.fasc"));
+    captureChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                [this] (const juce::FileChooser& chooser)
+    {
+        const auto file = chooser.getResult();
+        if (file.existsAsFile())
+            startPlayback(file);
+    });
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::startPlayback(const juce::File& file)
+{
+    std::unique_ptr<SpectrumCaptureReader> reader (new SpectrumCaptureReader(file));
+    if (!reader->isValid() || reader->getNumRecords() == 0)
+    {
+        DBG("not a readable capture: " + file.getFullPathName());
+        return;
+    }
+    
+    // live frames would overwrite the playback, keep the analyzer away from the audio thread until back to live
+    audioProcessor.detachAnalyzer();
+    captureReader = std::move(reader);
+    
+    mCapturePosition.setRange(0.0, (double)(captureReader->getNumRecords()-1), 1.0);
+    mCapturePosition.setValue(0.0, juce::dontSendNotification);
+    mCapturePosition.setVisible(true);
+    mLiveButton.setVisible(true);
+    freqAnalyzerPtr->showCapturedFrame(*captureReader, 0);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessorEditor::backToLive()
+{
+    captureReader.reset();
+    mCapturePosition.setVisible(false);
+    mLiveButton.setVisible(false);
+    // rebuilds at the selected resolution and attaches again
+    applyQualityTier(audioProcessor.getQualityGovernor().getTier());
 }
 
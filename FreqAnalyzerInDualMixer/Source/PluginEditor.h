@@ -14,7 +14,7 @@
 //==============================================================================
 /**
 */
-class FreqAnalyzerInDualMixerAudioProcessorEditor : public juce::AudioProcessorEditor, public juce::Slider::Listener
+class FreqAnalyzerInDualMixerAudioProcessorEditor : public juce::AudioProcessorEditor, public juce::FileDragAndDropTarget, private juce::Timer
 {
 public:
     FreqAnalyzerInDualMixerAudioProcessorEditor (FreqAnalyzerInDualMixerAudioProcessor&, juce::AudioProcessorValueTreeState&);
@@ -24,7 +24,37 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
     
-    void sliderValueChanged(juce::Slider*) override;
+    /// fft size / overlap selection changed, rebuild the analyzer at the new resolution
+    void analyzerResolutionChanged();
+    
+    /// fft or fractional-octave RTA analysis selected
+    void analysisModeChanged();
+    
+    /// pinned frequency list edited, retune the pinned tone banks
+    void pinnedChanged();
+    
+    /// display weighting or tilt selected, or the sample rate it was built for changed
+    void weightingChanged();
+    double weightingSampleRate = 0.0;
+    
+    /// apply a governor quality tier on top of the selected resolution
+    void applyQualityTier(int tier);
+    
+    /// capture to disk, and playback of a capture file in place of the live display
+    void captureButtonClicked();
+    void openCaptureClicked();
+    void startPlayback(const juce::File& file);
+    void backToLive();
+    
+    /// pick other instances of the plugin to overlay, from the process-wide hub
+    void overlayButtonClicked();
+    
+    /// start or cancel a sine sweep measurement of the wet path
+    void sweepButtonClicked();
+    
+    /// dropping an audio file analyzes it in the background and shows it as a reference
+    bool isInterestedInFileDrag(const juce::StringArray& files) override;
+    void filesDropped(const juce::StringArray& files, int x, int y) override;
     
     // memory of VTS
     typedef juce::AudioProcessorValueTreeState::SliderAttachment SliderAttachment;
@@ -40,15 +70,86 @@ private:
     juce::AudioProcessorValueTreeState& valueTreeState;
     
     // custom added objects
-    /* when re-init UI, this needs to concur with already existing freq analyzer
-     initialize the pointer here helps save processing power when UI is not opened
+    /* view of the processor's AnalysisEngine, created and destroyed while the engine is
+     detached so it can subscribe to its frames, it holds no analysis state of its own
      */
-    std::shared_ptr<FreqAnalyzer> freqAnalyzerPtr;
+    std::unique_ptr<FreqAnalyzer> freqAnalyzerPtr;
     
     juce::Slider mDWMixKnob;
     juce::Label mDWMixKnobLabel;
     std::unique_ptr<SliderAttachment> mDWMixKnobAtt;
     
+    juce::ComboBox mFFTSizeBox;
+    juce::Label mFFTSizeBoxLabel;
+    juce::ComboBox mOverlapBox;
+    juce::Label mOverlapBoxLabel;
+    juce::ComboBox mAnalysisModeBox;
+    juce::Label mAnalysisModeBoxLabel;
+    // zoom band, shown in zoom mode
+    juce::Slider mZoomRange;
+    juce::Label mZoomRangeLabel;
+    // pinned frequencies, comma separated Hz
+    juce::TextEditor mPinnedEditor;
+    // input and output loudness readouts
+    juce::Label mLoudnessLabels[2];
+    juce::TextButton mLoudnessResetButton;
+    void updateLoudness();
+    
+    // display weighting, item id is the WeightingTable curve + 1, and tilt
+    juce::ComboBox mWeightingBox;
+    juce::ComboBox mTiltBox;
+    // labelled peaks per trace, item id is the count + 1
+    juce::ComboBox mPeaksBox;
+    
+    // long-term percentile window, item id is minutes + 1
+    juce::ComboBox mPercentileBox;
+    juce::Label mPercentileBoxLabel;
+    
+    // software trace rasterizer instead of Graphics lines
+    juce::ToggleButton mDirectRenderButton;
+    // goniometer, correlation and balance over the analyzer
+    juce::ToggleButton mStereoScopeButton;
+    // analysis keeps running with the editor closed
+    juce::ToggleButton mKeepHistoryButton;
+    
+    // governor tier shown to the user
+    juce::Label mQualityLabel;
+    int appliedTier = 0;
+    
+    void timerCallback() override;
+    
+    // spectrum capture controls
+    juce::TextButton mCaptureButton;
+    juce::TextButton mOpenCaptureButton;
+    juce::Slider mCapturePosition;
+    juce::TextButton mLiveButton;
+    std::unique_ptr<juce::FileChooser> captureChooser;
+    /// open while a capture file is being played back, the analyzer is detached meanwhile
+    std::unique_ptr<SpectrumCaptureReader> captureReader;
+    
+    // instances overlaid from the hub, each watched for as long as it is in the list
+    juce::TextButton mOverlayButton;
+    std::vector<AnalyzerHub::InstanceRef> overlayInstances;
+    void setOverlayInstances(const std::vector<AnalyzerHub::InstanceRef>& instances);
+    
+    // whole-file reference analysis, results are polled by the timer
+    FileAnalysis fileAnalysis;
+    FileAnalysis::Results referenceResults;
+    uint32_t referenceVersion = 0;
+    juce::String referenceName;
+    juce::Label mReferenceLabel;
+    void updateReference();
+    
+    // sine sweep measurement, progress and results are polled by the timer, the result covers the analyzer when shown
+    juce::TextButton mSweepButton;
+    juce::ComboBox mSweepLengthBox;
+    juce::Label mSweepStatusLabel;
+    juce::TextButton mSweepResultButton;
+    SweepResultView sweepResultView;
+    SweepMeasurement::Results sweepResults;
+    uint32_t sweepVersion = 0;
+    void updateSweep();
+    
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FreqAnalyzerInDualMixerAudioProcessorEditor)
 };
@@ -39,11 +39,23 @@ FreqAnalyzerInDualMixerAudioProcessor::FreqAnalyzerInDualMixerAudioProcessor()
     {
         mDWM[i].reset( new DWmixer<float> );
         mDWM[i]->setid( (uint32_t) i );
+        mDWMDouble[i].reset( new DWmixer<double> );
+        mDWMDouble[i]->setid( (uint32_t) i );
     }
+    // cached once, the audio thread reads the mix through this atomic instead of going through the editor
+    mixParameter = vtsParameters.getRawParameterValue("00-allmix");
+    hubSlot = analyzerHub->registerInstance();
+    // captures are fed by the engine whether or not an editor is open
+    analysisEngine.setCapture(&spectrumCapture);
+    attachAnalyzer();
+    startTimerHz(5);
 }
 
 FreqAnalyzerInDualMixerAudioProcessor::~FreqAnalyzerInDualMixerAudioProcessor()
 {
+    stopTimer();
+    detachAnalyzer();
+    analyzerHub->unregisterInstance(hubSlot);
 }
 
 //==============================================================================
@@ -113,6 +125,26 @@ void FreqAnalyzerInDualMixerAudioProcessor::prepareToPlay (double sampleRate, in
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    mSampleRate = (float)sampleRate;
+    mBufferSize = samplesPerBlock;
+    streamPosition = 0;
+    // the dry copy is made every block, allocated here so processBlock never does
+    const int numDryChannels = juce::jmax(2, getTotalNumInputChannels(), getTotalNumOutputChannels());
+    if (isUsingDoublePrecision())
+        dryDouble.setSize(numDryChannels, samplesPerBlock);
+    else
+        dryFloat.setSize(numDryChannels, samplesPerBlock);
+    qualityGovernor.prepare(sampleRate, samplesPerBlock);
+    spectrumCapture.prepare(sampleRate);
+    for (auto& meter : loudnessMeters)
+        meter.prepare(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+    for (auto& mixer : mDWM)
+        mixer->prepare(sampleRate, mixParameter->load());
+    for (auto& mixer : mDWMDouble)
+        mixer->prepare(sampleRate, (double)mixParameter->load());
+    hubFeed.prepare();
+    if (hubSlot >= 0)
+        analyzerHub->setFormat(hubSlot, sampleRate, getTotalNumOutputChannels());
 }
 
 void FreqAnalyzerInDualMixerAudioProcessor::releaseResources()
@@ -149,6 +181,19 @@ bool FreqAnalyzerInDualMixerAudioProcessor::isBusesLayoutSupported (const BusesL
 
 void FreqAnalyzerInDualMixerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processSamples(buffer, mDWM, dryFloat);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, mDWMDouble, dryDouble);
+}
+
+template <typename SampleType>
+void FreqAnalyzerInDualMixerAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, std::unique_ptr< DWmixer<SampleType> >* mixers,
+                                                              juce::AudioBuffer<SampleType>& drySamples)
+{
+    FA_TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -163,38 +208,149 @@ void FreqAnalyzerInDualMixerAudioProcessor::processBlock (juce::AudioBuffer<floa
         buffer.clear (i, 0, buffer.getNumSamples());
 
     
-    // copy dry input all channels
-    juce::AudioBuffer<float> drySamples;
-    drySamples.makeCopyOf(buffer);
+    // a running sweep measurement is the input, on every channel
+    sweepMeasurement.generate(buffer.getArrayOfWritePointers(), totalNumInputChannels, buffer.getNumSamples());
+    
+    // copy dry input all channels, into the buffer prepared for it (only a host exceeding
+    // its announced block size makes this allocate)
+    drySamples.makeCopyOf(buffer, true);
+    
+    // the engine is not reconfigured until this scope ends, even if the editor changes a setting meanwhile
+    // with the editor closed it only runs to keep the history a view opens on
+    const AnalyzerHandoff::ReadScope analyzerScope(analyzerHandoff);
+    const bool analyzing = editorOpen.load(std::memory_order_relaxed) || keepHistory.load(std::memory_order_relaxed);
+    AnalysisEngine* analyzer = analyzing ? analyzerScope.get() : nullptr;
+    const int numSamples = buffer.getNumSamples();
+    const bool offline = isNonRealtime();
+    
+    // hops are counted from prepareToPlay, not from whenever the engine was attached, rebuilt or started again
+    if (analyzer != nullptr && (analyzer->needsAlignment() || !engineRunning))
+        analyzer->alignTo(streamPosition);
+    engineRunning = analyzer != nullptr;
+    spectrumCapture.setDrainWhenFull(offline);
+    
+    // one parameter read per block, the mixers ramp to it over a fixed time from a sample grid of the stream,
+    // so the render depends on where the host changes the value, not on how it splits the stream into blocks
+    const float mix = mixParameter->load(std::memory_order_relaxed);
+    for (int channel = 0; channel < 2; channel++)
+        mixers[channel]->setTargetProportion((SampleType)mix, streamPosition);
+    
+    // the analyzer's own work in this callback, which is all the quality governor can shed
+    juce::int64 analysisTicks = 0;
     
-    // for each output channel
-    for (int channel = 0; channel < totalNumOutputChannels; channel++)
+    if (totalNumInputChannels == 1 && totalNumOutputChannels == 2)
     {
-        int dryReadFromChan = 0;
-        if (totalNumInputChannels == 1 && totalNumOutputChannels == 1)
+        // mono -> stereo, copy inL to inR in buffer
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+    }
+    
+    // chunks end on the analyzer hop, so the dry/wet x L/R frames reach it together and are transformed as one batch,
+    // and stay within the announced block size the loudness meters were prepared for
+    for (int start = 0; start < numSamples;)
+    {
+        int numChunk = juce::jmin(numSamples - start, juce::jmax(1, mBufferSize));
+        if (analyzer != nullptr)
+            numChunk = juce::jmin(numChunk, analyzer->samplesToNextHop());
+        
+        // for each output channel
+        for (int channel = 0; channel < totalNumOutputChannels; channel++)
         {
-            // mono -> mono
-            dryReadFromChan = 0;
+            int dryReadFromChan = 0;
+            if (totalNumInputChannels == 1)
+            {
+                // mono -> mono, mono -> stereo
+                dryReadFromChan = 0;
+            }
+            else
+            {
+                // stereo -> stereo
+                dryReadFromChan = channel;
+            }
+            
+            auto* drySamplesPtr = drySamples.getReadPointer(dryReadFromChan, start);
+            auto* channelDSP = buffer.getWritePointer(channel, start);
+            
+            // dry wet mixer
+            mixers[channel]->processBuffer(drySamplesPtr,channelDSP,numChunk,analyzer,loudnessMeters);
         }
-        else if (totalNumInputChannels == 1 && totalNumOutputChannels == 2)
+        
+        for (auto& meter : loudnessMeters)
+            meter.advance();
+        
+        if (analyzer != nullptr)
         {
-            // mono -> stereo
-            dryReadFromChan = 0;
-            // copy inL to inR in buffer
-            buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            if (totalNumOutputChannels == 2)
+                analyzer->injectStereo(buffer.getReadPointer(0, start), buffer.getReadPointer(1, start), numChunk);
+            analyzer->transformPending();
+            analysisTicks += juce::Time::getHighResolutionTicks()-startTicks;
         }
-        else
+        
+        start += numChunk;
+    }
+    
+    // other instances' editors are overlaying this one, nothing is analyzed for the hub otherwise
+    if (analyzerHub->isWatched(hubSlot))
+        hubFeed.process(*analyzerHub, hubSlot, buffer.getArrayOfReadPointers(), totalNumOutputChannels, numSamples);
+    
+    sweepMeasurement.record(drySamples.getReadPointer(0), buffer.getReadPointer(0), numSamples);
+    
+    streamPosition += numSamples;
+    
+    // only the analyzer's injection and transforms are reported, the mixers, meters, hub feed and sweep cost
+    // the same at every tier and stepping the analyzer down would not shed any of it
+    // offline renders have no real-time budget, and keep the tier fixed so the output does not depend on timing
+    for (int channel = 0; channel < 2; channel++)
+        analysisTicks += mixers[channel]->takeAnalysisTicks();
+    if (analyzer != nullptr && !offline)
+        qualityGovernor.reportCallback(juce::Time::highResolutionTicksToSeconds(analysisTicks), numSamples);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessor::timerCallback()
+{
+    if (!editorOpen.load(std::memory_order_relaxed))
+    {
+        applyQualityTier(qualityGovernor.getTier());
+        // prepareToPlay at another rate: what the engine runs for the old one is rebuilt, the open editor does this itself
+        if (getSampleRate() > 0.0 && getSampleRate() != analysisEngine.getSampleRate())
         {
-            // stereo -> stereo
-            dryReadFromChan = channel;
+            detachAnalyzer();
+            analysisEngine.setSampleRate(getSampleRate());
+            attachAnalyzer();
         }
-        
-        auto* drySamplesPtr = drySamples.getReadPointer(dryReadFromChan);
-        auto* channelDSP = buffer.getWritePointer(channel);
-        
-        // dry wet mixer
-        mDWM[channel]->processBuffer(drySamplesPtr,channelDSP,buffer.getNumSamples());
     }
+    analysisEngine.getPercentiles().collect();
+    framePool.releaseRetired();
+}
+
+void FreqAnalyzerInDualMixerAudioProcessor::applyQualityTier (int tier)
+{
+    // the resolution the editor saved, the same ceiling its boxes show
+    const auto selectedOrder = (uint32_t)juce::jlimit((int)FFTORDER_MIN, (int)FFTORDER_MAX, (int)vtsParameters.state.getProperty("fftOrder", (int)FFTORDER_T));
+    const auto selectedOverlapShift = (uint32_t)juce::jlimit(0, (int)OVERLAPSHIFT_MAX, (int)vtsParameters.state.getProperty("overlapShift", (int)(FFTORDER_T-FFTORDER_A)));
+    const auto settings = QualityGovernor::getSettings(tier, selectedOrder, selectedOverlapShift, FFTORDER_MIN);
+    const bool newResolution = settings.order != analysisEngine.getOrder() || settings.overlapShift != analysisEngine.getOverlapShift();
+    const bool newRight = settings.analyzeRight != analysisEngine.isAnalyzingRight();
+    if (!newResolution && !newRight && settings.frameDivider == analysisEngine.getFrameDivider())
+        return;
+    
+    // built while the audio thread still runs the old buffers, freed once it is back on the new ones,
+    // a change of the right channel restarts both channels on new buffers too
+    std::unique_ptr<AnalysisStorage> storage;
+    if (newResolution || newRight)
+        storage = std::make_unique<AnalysisStorage>(settings.order, settings.overlapShift);
+    detachAnalyzer();
+    storage = analysisEngine.setReducedLoad(settings.frameDivider, settings.analyzeRight, std::move(storage));
+    attachAnalyzer();
+    storage.reset();
+}
+
+juce::String FreqAnalyzerInDualMixerAudioProcessor::getMemoryReport() const
+{
+    return "analysis engine\n" + analysisEngine.getMemoryReport()
+        + "\nframe pool: " + juce::String((juce::int64)framePool.getMemoryBytes()) + " B"
+        + "\nhub feed: " + juce::String((juce::int64)hubFeed.getMemoryBytes()) + " B"
+        + "\ninstance total: " + juce::String((juce::int64)getMemoryBytes()) + " B";
 }
 
 //==============================================================================
@@ -225,10 +381,23 @@ void FreqAnalyzerInDualMixerAudioProcessor::setStateInformation (const void* dat
         if (xmlState->hasTagName (vtsParameters.state.getType()))
         {
             vtsParameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+            keepHistory.store((bool)vtsParameters.state.getProperty("keepHistory", true), std::memory_order_relaxed);
             //DBG("GOT STATE INFO FROM " << "..." << "! ");
         }
 }
 
+void FreqAnalyzerInDualMixerAudioProcessor::setKeepHistory (bool shouldKeep)
+{
+    keepHistory.store(shouldKeep, std::memory_order_relaxed);
+    vtsParameters.state.setProperty("keepHistory", shouldKeep, nullptr);
+}
+
+void FreqAnalyzerInDualMixerAudioProcessor::updateTrackProperties (const TrackProperties& properties)
+{
+    if (hubSlot >= 0 && properties.name.has_value() && properties.name->isNotEmpty())
+        analyzerHub->setName(hubSlot, *properties.name);
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
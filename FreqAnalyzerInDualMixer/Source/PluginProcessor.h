@@ -10,11 +10,14 @@
 
 #include <JuceHeader.h>
 #include "DWmixer.h"
+#include "AnalyzerHandoff.h"
+#include "QualityGovernor.h"
+#include "SweepMeasurement.h"
 
 //==============================================================================
 /**
 */
-class FreqAnalyzerInDualMixerAudioProcessor  : public juce::AudioProcessor
+class FreqAnalyzerInDualMixerAudioProcessor  : public juce::AudioProcessor, private juce::Timer
 {
 public:
     //==============================================================================
@@ -30,6 +33,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -54,18 +59,103 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    /// track name from the host, shown in other instances' overlay lists
+    void updateTrackProperties (const TrackProperties& properties) override;
+    
     //==============================================================================
-    /// DWMix pointer
+    /// DWMix pointer, one set per processing precision
     std::unique_ptr< DWmixer<float> > mDWM[2];
+    std::unique_ptr< DWmixer<double> > mDWMDouble[2];
+    
+    /// message thread: hand the analysis engine to / take it back from the audio thread,
+    /// the engine is only reconfigured (or subscribed to) while detached
+    void attachAnalyzer() { analyzerHandoff.attach(&analysisEngine); }
+    void detachAnalyzer() { analyzerHandoff.detach(); }
+    
+    /// analysis state shared by every editor session, views subscribe to it
+    AnalysisEngine& getAnalysisEngine() { return analysisEngine; }
+    
+    /// message thread: the engine runs while an editor is open, and with it closed only when history is kept
+    /// the open editor applies the quality tier to the engine, the processor does while it is closed
+    void setEditorOpen(bool isOpen) { editorOpen.store(isOpen, std::memory_order_relaxed); }
+    /// message thread: keep analyzing with the editor closed, so it opens on the recent spectra; saved with the state
+    void setKeepHistory(bool shouldKeep);
+    bool getKeepHistory() const { return keepHistory.load(std::memory_order_relaxed); }
+    
+    /// message thread: analysis memory of this instance (engine, frame pool and hub feed), and the breakdown
+    size_t getMemoryBytes() const { return analysisEngine.getMemoryBytes()+framePool.getMemoryBytes()+hubFeed.getMemoryBytes(); }
+    juce::String getMemoryReport() const;
+    
+    /// analysis quality tier under CPU pressure, polled by the editor, and by the processor while it is closed
+    const QualityGovernor& getQualityGovernor() const { return qualityGovernor; }
+    
+    /// spectrum capture to disk, started/stopped from the editor
+    SpectrumCapture& getSpectrumCapture() { return spectrumCapture; }
+    
+    /// BS.1770 loudness and true-peak of the dry input (0) and the mixed output (1), read by the editor
+    LoudnessMeter& getLoudnessMeter(int inout) { return loudnessMeters[inout]; }
+    
+    /// sine sweep measurement of the wet path, started and read by the editor
+    SweepMeasurement& getSweepMeasurement() { return sweepMeasurement; }
+    
+    /// registry of all instances in this process, and this instance's slot in it (-1 if it was full)
+    AnalyzerHub& getAnalyzerHub() { return *analyzerHub; }
+    int getHubSlot() const { return hubSlot; }
     
 private:
     //==============================================================================
+    /// shared body of both processBlock overloads
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, std::unique_ptr< DWmixer<SampleType> >* mixers,
+                         juce::AudioBuffer<SampleType>& drySamples);
+    
+    /// message thread: the engine's upkeep across editor sessions, the tier while no editor is open,
+    /// the percentiles collected and the frames of earlier resolutions freed once they are all back
+    void timerCallback() override;
+    /// message thread, no editor open: run the engine at a tier below the saved resolution, as the editor does
+    void applyQualityTier(int tier);
+    
     /// buffer size smps
     int mBufferSize;
     /// sampling rate Hz
     float mSampleRate;
+    /// samples processed since prepareToPlay, hop phase reference for the analyzer
+    juce::int64 streamPosition = 0;
+    /// copy of the dry input of a block, sized in prepareToPlay for either precision
+    juce::AudioBuffer<float> dryFloat;
+    juce::AudioBuffer<double> dryDouble;
     /// vts parameters
     juce::AudioProcessorValueTreeState vtsParameters;
+    /// "00-allmix" raw value, 0 dry .. 1 wet
+    std::atomic<float>* mixParameter = nullptr;
+    /// analysis engine as seen from the audio thread
+    AnalyzerHandoff analyzerHandoff;
+    /// measures analyzer cost against the real-time budget
+    QualityGovernor qualityGovernor;
+    /// published spectrum frames, a set sized for each resolution is given to it by the engine
+    /// declared before everything that can hold a frame so it is destroyed after them
+    SpectrumFramePool framePool;
+    /// writes published frames to disk, lives here so a capture can run across editor sessions
+    SpectrumCapture spectrumCapture;
+    /// fft units, RTA, zoom, pinned tones and stereo scope, kept across editor sessions
+    AnalysisEngine analysisEngine { framePool };
+    /// audio thread: the engine was analyzing the previous block, its hops are realigned when it starts again
+    bool engineRunning = false;
+    std::atomic<bool> editorOpen { false };
+    /// analyse with the editor closed too, so it opens on the last few seconds
+    std::atomic<bool> keepHistory { true };
+    /// input and output loudness, metered whether or not the editor is open
+    LoudnessMeter loudnessMeters[2];
+    /// replaces the input with its sweep while measuring, records the dry and wet result
+    SweepMeasurement sweepMeasurement;
+    /// shared between all instances in this process, the output spectrum is published to it while watched
+    juce::SharedResourcePointer<AnalyzerHub> analyzerHub;
+    int hubSlot = -1;
+    HubFeed hubFeed;
+#if FA_TRACE
+    /// trace writer, shared between all instances in this process
+    juce::SharedResourcePointer<TraceLog::Session> traceSession;
+#endif
     //==============================================================================
     
     //==============================================================================
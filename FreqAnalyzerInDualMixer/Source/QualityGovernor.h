@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Created: 19 Oct 2026 3:48:12pm
+    Author:  Louis Deng
+
+    backs the analyzer off under CPU pressure
+
+    the audio thread reports how long the analyzer took in each callback, the
+    governor compares that to the callback's real-time budget (numSamples/sr)
+    and steps the quality tier down or up with hysteresis. the editor polls the
+    tier and applies it to its analyzer on the message thread, the processor
+    does while no editor is open
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class QualityGovernor
+{
+public:
+    /// quality tiers, each one includes the reductions of the ones above it
+    enum Tier
+    {
+        full = 0,       // user selected fft size / overlap
+        noOverlap,      // overlap off
+        smallFFT,       // + smallest fft order
+        halfRate,       // + every other frame transformed
+        leftOnly,       // + right channel not analyzed
+        numTiers
+    };
+
+    /// what the analyzer runs at on a tier
+    struct Settings
+    {
+        uint32_t order;
+        uint32_t overlapShift;
+        int frameDivider;
+        bool analyzeRight;
+    };
+
+    /// the user's selection is the ceiling, each tier takes a further step down from it
+    /// smallestOrder: the fft order smallFFT drops to
+    static Settings getSettings(int t, uint32_t selectedOrder, uint32_t selectedOverlapShift, uint32_t smallestOrder)
+    {
+        Settings settings { selectedOrder, selectedOverlapShift, 1, true };
+        if (t >= noOverlap) settings.overlapShift = 0;
+        if (t >= smallFFT) settings.order = smallestOrder;
+        if (t >= halfRate) settings.frameDivider = 2;
+        if (t >= leftOnly) settings.analyzeRight = false;
+        return settings;
+    }
+
+    QualityGovernor()
+    {
+    }
+
+    ~QualityGovernor()
+    {
+    }
+
+    /// called from prepareToPlay
+    void prepare(double sampleRate, int samplesPerBlock)
+    {
+        sr = sampleRate;
+        load = 0.0;
+        overSeconds = 0.0;
+        underSeconds = 0.0;
+        DBG("governor budget per block = " + juce::String(1000.0*samplesPerBlock/sampleRate) + " ms");
+    }
+
+    /// audio thread: analyzer time spent in a callback of numSamples, once per processBlock
+    void reportCallback(double secondsUsed, int numSamples)
+    {
+        if (sr <= 0.0 || numSamples <= 0)
+            return;
+
+        const double budget = (double)numSamples/sr;
+        load += LOADSMOOTHING*(secondsUsed/budget-load);
+        loadShare.store((float)load, std::memory_order_relaxed);
+
+        const int t = tier.load(std::memory_order_relaxed);
+        if (load > DOWNTHRESHOLD && t < numTiers-1)
+        {
+            underSeconds = 0.0;
+            overSeconds += budget;
+            if (overSeconds >= DOWNHOLDSECONDS)
+            {
+                tier.store(t+1, std::memory_order_relaxed);
+                overSeconds = 0.0;
+            }
+        }
+        else if (load < UPTHRESHOLD && t > 0)
+        {
+            overSeconds = 0.0;
+            underSeconds += budget;
+            if (underSeconds >= UPHOLDSECONDS)
+            {
+                tier.store(t-1, std::memory_order_relaxed);
+                underSeconds = 0.0;
+            }
+        }
+        else
+        {
+            overSeconds = 0.0;
+            underSeconds = 0.0;
+        }
+    }
+
+    /// current tier, any thread
+    int getTier() const { return tier.load(std::memory_order_relaxed); }
+
+    /// smoothed analyzer time as a fraction of the real-time budget, any thread
+    float getLoadShare() const { return loadShare.load(std::memory_order_relaxed); }
+
+    static juce::String getTierName(int t)
+    {
+        switch (t)
+        {
+            case full:      return "full";
+            case noOverlap: return "no overlap";
+            case smallFFT:  return "2048 pt";
+            case halfRate:  return "half rate";
+            case leftOnly:  return "left only";
+        }
+        return {};
+    }
+
+private:
+    // analyzer share of the budget that triggers a step down / allows a step up
+    static constexpr double DOWNTHRESHOLD = 0.25;
+    static constexpr double UPTHRESHOLD = 0.08;
+    // how long the load must stay past a threshold (seconds of audio) before stepping
+    static constexpr double DOWNHOLDSECONDS = 0.5;
+    static constexpr double UPHOLDSECONDS = 3.0;
+    // one-pole smoothing per callback
+    static constexpr double LOADSMOOTHING = 0.1;
+
+    // audio thread state
+    double sr = 0.0;
+    double load = 0.0;
+    double overSeconds = 0.0;
+    double underSeconds = 0.0;
+
+    std::atomic<int> tier { full };
+    std::atomic<float> loadShare { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE(QualityGovernor)
+};
@@ -0,0 +1,297 @@
+/*
+  ==============================================================================
+
+    SpectrumCapture.h
+    Created: 20 Oct 2026 9:41:26am
+    Author:  Louis Deng
+
+    streams every published spectrum frame to disk, and reads captures back
+
+    file format (.fasc, native little-endian): one CaptureFileHeader followed by
+    fixed-size records, each a CaptureRecordHeader plus numBins int16 levels in
+    centi-dB (same dB scale as the display, SpectrumUtil::amp2db). fixed records
+    make any frame addressable as headerSize + index*recordSize, so the reader
+    simply memory-maps the file
+
+    the capture subscribes to the analyzer's published frames: the audio thread
+    only queues a reference to each pooled frame, a background thread converts
+    and writes them (dry and wet record per frame), and starts a new file when
+    the current one passes the size limit or the fft size changes
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SpectrumUtil.h"
+#include "SpectrumFrames.h"
+
+const uint32_t CAPTURE_VERSION = 1;
+const uint32_t CAPTURE_MIN_FFTSIZE = 2048;  // the analyzer's resolutions, 1 << FFTORDER_MIN..FFTORDER_MAX
+const uint32_t CAPTURE_MAX_FFTSIZE = 8192;
+const float CAPTURE_DBSTEP = 0.01f;   // quantization step of the stored levels
+
+struct CaptureFileHeader
+{
+    char magic[4];          // "FASC"
+    uint32_t version;
+    uint32_t headerSize;    // offset of the first record
+    uint32_t recordSize;    // bytes per record, header included
+    uint32_t fftSize;
+    uint32_t numBins;       // levels per record, bins 0..fftSize/2-1
+    uint32_t window;        // 0 rectangular, 1 Hann
+    uint32_t axis;          // 0 linear bins, bin k at k*sampleRate/fftSize Hz
+    float sampleRate;
+    float dBStep;           // stored value * dBStep = dB
+    float dBFloor;
+    uint32_t reserved;
+    juce::int64 startTimeMs; // wall clock at capture start, ms since 1970
+    uint8_t padding[8];
+};
+static_assert(sizeof(CaptureFileHeader) == 64, "capture header must stay 64 bytes");
+
+struct CaptureRecordHeader
+{
+    double seconds;         // since capture start
+    uint32_t frameIndex;    // records of the same hop share the index
+    uint8_t channel;        // 0 left, 1 right
+    uint8_t drywet;         // 0 dry, 1 wet
+    uint16_t reserved;
+};
+static_assert(sizeof(CaptureRecordHeader) == 16, "capture record header must stay 16 bytes");
+
+/// writer side, owned by the processor so captures outlive the editor
+class SpectrumCapture : public SpectrumFrameConsumer, private juce::Thread
+{
+public:
+    SpectrumCapture(): juce::Thread("FreqAnalyzer capture writer"), queue(QUEUESIZE)
+    {
+    }
+
+    ~SpectrumCapture() override
+    {
+        stop();
+    }
+
+    /// called from prepareToPlay
+    void prepare(double newSampleRate)
+    {
+        sampleRate.store((float)newSampleRate);
+    }
+
+    /// message thread: start a new capture into the given directory, rotating at maxFileBytes
+    void start(const juce::File& directory, juce::int64 maxFileBytes = (juce::int64)256 << 20)
+    {
+        stop();
+
+        // drop anything left over from the previous capture
+        queue.clear();
+
+        captureDirectory = directory;
+        maxBytes = maxFileBytes;
+        captureName = "FreqAnalyzerCapture_" + juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S");
+        fileCount = 0;
+        startTicks = juce::Time::getHighResolutionTicks();
+        startTimeMs = juce::Time::currentTimeMillis();
+
+        startThread();
+        active.store(true);
+    }
+
+    /// message thread: stop capturing, remaining frames are written before this returns
+    void stop()
+    {
+        if (!active.load() && !isThreadRunning())
+            return;
+        active.store(false);
+        stopThread(2000);
+        drain();
+        stream.reset();
+    }
+
+    bool isCapturing() const { return active.load(); }
+
+    juce::uint32 getDroppedFrames() const { return dropped.load(); }
+    
+    /// audio thread, once per block: while rendering offline, offer() writes the queued frames
+    /// itself instead of dropping the frame when the queue is full, so an offline capture is complete
+    void setDrainWhenFull(bool shouldDrain) { drainWhenFull.store(shouldDrain, std::memory_order_relaxed); }
+
+    /// audio thread: keep a reference to a published frame, never allocates, drops the frame when full
+    /// (writes the queue to disk on the calling thread instead when setDrainWhenFull(true), offline only)
+    void offer(const SpectrumFrameRef& frame) override
+    {
+        // zoom frames have no place in the linear-bin file format
+        if (!active.load(std::memory_order_relaxed) || frame->zoomed)
+            return;
+
+        // an offline render has no deadline, it does the writer's work rather than waiting for it
+        if (queue.isFull() && drainWhenFull.load(std::memory_order_relaxed))
+            drain();
+        if (!queue.push(frame))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    // frames, two records each
+    static constexpr uint32_t QUEUESIZE = 32;
+    static constexpr int DRAININTERVAL_MS = 20;
+
+    // producer/consumer queue of frame references
+    SpectrumFrameQueue queue;
+    std::atomic<bool> active { false };
+    std::atomic<bool> drainWhenFull { false };
+    // the writer thread and an offline render both drain, one at a time
+    juce::CriticalSection drainLock;
+    std::atomic<juce::uint32> dropped { 0 };
+    std::atomic<float> sampleRate { 0.0f };
+
+    // writer thread state
+    juce::File captureDirectory;
+    juce::String captureName;
+    juce::int64 maxBytes = 0;
+    int fileCount = 0;
+    juce::int64 startTicks = 0;
+    juce::int64 startTimeMs = 0;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    CaptureFileHeader fileHeader;
+    std::vector<float> dBScratch;
+    std::vector<int16_t> levelScratch;
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(DRAININTERVAL_MS);
+            drain();
+        }
+    }
+
+    void drain()
+    {
+        const juce::ScopedLock sl(drainLock);
+        SpectrumFrameRef frame;
+        while (queue.pop(frame))
+        {
+            writeRecord(*frame, 0);
+            writeRecord(*frame, 1);
+            // back to the pool as soon as it is on its way to disk
+            frame.reset();
+        }
+        if (stream != nullptr)
+            stream->flush();
+    }
+
+    void writeRecord(const SpectrumFrame& frame, uint32_t drywet)
+    {
+        // new file on size limit or when the analyzer resolution changed
+        if (stream == nullptr || frame.fftSize != fileHeader.fftSize || frame.numBins != fileHeader.numBins
+            || stream->getPosition() >= maxBytes)
+        {
+            openNextFile(frame.fftSize, frame.numBins);
+            if (stream == nullptr)
+                return;
+        }
+
+        CaptureRecordHeader record {};
+        record.seconds = juce::Time::highResolutionTicksToSeconds(frame.ticks-startTicks);
+        record.frameIndex = frame.frameIndex;
+        record.channel = (uint8_t)frame.channel;
+        record.drywet = (uint8_t)drywet;
+
+        const float* magnitudes = frame.getMagnitudes(drywet);
+        dBScratch.assign(magnitudes, magnitudes+frame.numBins);
+        SpectrumUtil::amp2db(dBScratch);
+        levelScratch.resize(frame.numBins);
+        for (uint32_t i=0;i<frame.numBins;i++)
+            levelScratch[i] = (int16_t)juce::jlimit(-32768, 32767, juce::roundToInt(dBScratch[i]/CAPTURE_DBSTEP));
+
+        stream->write(&record, sizeof(record));
+        stream->write(levelScratch.data(), levelScratch.size()*sizeof(int16_t));
+    }
+
+    void openNextFile(uint32_t fftSize, uint32_t numBins)
+    {
+        stream.reset();
+        const auto file = captureDirectory.getChildFile(captureName + "_" + juce::String(fileCount++).paddedLeft('0', 3) + ".fasc");
+        stream.reset(new juce::FileOutputStream(file));
+        if (stream->failedToOpen())
+        {
+            DBG("capture file could not be opened: " + file.getFullPathName());
+            stream.reset();
+            return;
+        }
+        stream->truncate();
+
+        fileHeader = {};
+        std::memcpy(fileHeader.magic, "FASC", 4);
+        fileHeader.version = CAPTURE_VERSION;
+        fileHeader.headerSize = sizeof(CaptureFileHeader);
+        fileHeader.recordSize = (uint32_t)(sizeof(CaptureRecordHeader) + numBins*sizeof(int16_t));
+        fileHeader.fftSize = fftSize;
+        fileHeader.numBins = numBins;
+        fileHeader.window = 1;
+        fileHeader.axis = 0;
+        fileHeader.sampleRate = sampleRate.load();
+        fileHeader.dBStep = CAPTURE_DBSTEP;
+        fileHeader.dBFloor = SpectrumUtil::FLOOR;
+        fileHeader.startTimeMs = startTimeMs;
+        stream->write(&fileHeader, sizeof(fileHeader));
+        DBG("capturing to " + file.getFullPathName());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumCapture)
+};
+
+/// reader side, memory-maps a capture file for random access playback
+class SpectrumCaptureReader
+{
+public:
+    explicit SpectrumCaptureReader(const juce::File& file): mapped(file, juce::MemoryMappedFile::readOnly)
+    {
+        const auto* data = static_cast<const char*>(mapped.getData());
+        if (data == nullptr || mapped.getSize() < sizeof(CaptureFileHeader))
+            return;
+
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, "FASC", 4) != 0 || header.version != CAPTURE_VERSION)
+            return;
+        // nothing below is read from a header that does not describe a file this plugin could have written
+        if (header.headerSize < sizeof(CaptureFileHeader) || header.headerSize > mapped.getSize())
+            return;
+        if (!juce::isPowerOfTwo(header.fftSize) || header.fftSize < CAPTURE_MIN_FFTSIZE || header.fftSize > CAPTURE_MAX_FFTSIZE
+            || header.numBins != header.fftSize/2
+            || header.recordSize != sizeof(CaptureRecordHeader) + header.numBins*sizeof(int16_t))
+            return;
+
+        numRecords = (juce::int64)((mapped.getSize()-header.headerSize)/header.recordSize);
+        valid = true;
+    }
+
+    bool isValid() const { return valid; }
+
+    const CaptureFileHeader& getHeader() const { return header; }
+
+    juce::int64 getNumRecords() const { return numRecords; }
+
+    /// record info and its levels in dB (getHeader().numBins floats), false if out of range
+    bool readRecord(juce::int64 index, CaptureRecordHeader& info, float* dBOut) const
+    {
+        if (!valid || index < 0 || index >= numRecords)
+            return false;
+
+        const auto* record = static_cast<const char*>(mapped.getData()) + header.headerSize + index*header.recordSize;
+        std::memcpy(&info, record, sizeof(info));
+        const auto* levels = reinterpret_cast<const int16_t*>(record + sizeof(CaptureRecordHeader));
+        for (uint32_t i=0;i<header.numBins;i++)
+            dBOut[i] = (float)levels[i]*header.dBStep;
+        return true;
+    }
+
+private:
+    juce::MemoryMappedFile mapped;
+    CaptureFileHeader header {};
+    juce::int64 numRecords = 0;
+    bool valid = false;
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumCaptureReader)
+};
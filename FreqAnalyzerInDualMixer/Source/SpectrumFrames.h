@@ -0,0 +1,443 @@
+/*
+  ==============================================================================
+
+    SpectrumFrames.h
+    Created: 23 Oct 2026 10:06:15am
+    Author:  Louis Deng
+
+    publication of computed spectra to any number of consumers without copies
+
+    a published frame (dry and wet magnitudes of one channel plus a small
+    header) lives in a pooled buffer that is immutable once published and
+    reference counted. the producer fills a frame taken from the pool and
+    offers it to every subscribed consumer, each keeps a reference for as long
+    as it needs the frame (the display until it has converted it, the capture
+    writer until it is on disk). when the last reference goes the buffer goes
+    back on the pool's lock-free free list, so after start-up nothing is
+    allocated
+
+    the frames are sized for the analyzer's resolution: a new resolution comes
+    with a new set of frames, and the pool keeps the old set until the last
+    frame still referenced from it has come back. a set is one AnalyzerArena
+    block of its own rather than part of the analysis storage's, since a
+    retired set outlives the storage it was made with
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AnalyzerArena.h"
+
+class SpectrumFrameSet;
+
+/// one channel's dry and wet magnitudes of a hop, read-only once published
+/// a cache line per header, so the reference counts of neighbouring frames are never shared
+class alignas(AnalyzerArena::ALIGNMENT) SpectrumFrame
+{
+public:
+    uint32_t frameIndex = 0;    // hops since prepareToPlay, shared by the channels of a hop
+    uint32_t channel = 0;       // 0 left, 1 right
+    uint32_t fftSize = 0;
+    uint32_t numBins = 0;       // magnitudes per stream, bins 0..numBins-1
+    bool zoomed = false;        // bins spread over the zoom band instead of 0..Nyquist
+    juce::int64 ticks = 0;      // high resolution ticks at publication
+
+    /// drywet 0 dry, 1 wet, numBins magnitudes on the fft scale
+    const float* getMagnitudes(uint32_t drywet) const { return magnitudes+drywet*capacity; }
+    /// producer only, before publication
+    float* getWritePointer(uint32_t drywet) { return magnitudes+drywet*capacity; }
+    uint32_t getCapacity() const { return capacity; }
+
+private:
+    friend class SpectrumFrameSet;
+    friend class SpectrumFrameRef;
+
+    SpectrumFrameSet* set = nullptr;
+    uint32_t index = 0;
+    uint32_t capacity = 0;
+    std::atomic<int> refs { 0 };
+    std::atomic<uint32_t> nextFree { 0 };
+    float* magnitudes = nullptr;    // 2*capacity in the set's arena
+};
+
+/// counted reference to a pooled frame, copying retains and destruction releases, never allocates
+class SpectrumFrameRef
+{
+public:
+    SpectrumFrameRef()
+    {
+    }
+    ~SpectrumFrameRef() { reset(); }
+
+    SpectrumFrameRef(const SpectrumFrameRef& other): frame(other.frame)
+    {
+        if (frame != nullptr)
+            frame->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    SpectrumFrameRef(SpectrumFrameRef&& other) noexcept: frame(other.frame) { other.frame = nullptr; }
+    SpectrumFrameRef& operator=(SpectrumFrameRef other) noexcept
+    {
+        std::swap(frame, other.frame);
+        return *this;
+    }
+
+    inline void reset();
+
+    const SpectrumFrame* get() const { return frame; }
+    const SpectrumFrame* operator->() const { return frame; }
+    const SpectrumFrame& operator*() const { return *frame; }
+    explicit operator bool() const { return frame != nullptr; }
+
+    /// producer only: write access while the frame is not yet shared
+    SpectrumFrame* getForWriting() const
+    {
+        jassert(frame == nullptr || frame->refs.load() == 1);
+        return frame;
+    }
+
+private:
+    friend class SpectrumFrameSet;
+    explicit SpectrumFrameRef(SpectrumFrame* f): frame(f) {}
+
+    SpectrumFrame* frame = nullptr;
+};
+
+/// fixed set of frames of one size, taken and returned through a lock-free stack (index + ABA tag in one word)
+/// the headers and all their magnitudes are one arena block
+class SpectrumFrameSet
+{
+public:
+    SpectrumFrameSet(uint32_t numFrames, uint32_t maxBins)
+    {
+        const size_t framesAt = arena.reserve<SpectrumFrame>("frame headers", numFrames);
+        const size_t magnitudesAt = arena.reserve<float>("frame magnitudes", (size_t)numFrames*maxBins*2);
+        arena.allocate();
+        frames = arena.place<SpectrumFrame>(framesAt, numFrames);
+        const auto magnitudes = arena.place<float>(magnitudesAt, (size_t)numFrames*maxBins*2);
+        for (uint32_t i=0;i<numFrames;i++)
+        {
+            auto& frame = frames[i];
+            frame.set = this;
+            frame.index = i;
+            frame.capacity = maxBins;
+            frame.magnitudes = magnitudes.data()+(size_t)i*maxBins*2;
+            frame.nextFree.store(i+1 < numFrames ? i+1 : NONE);
+        }
+        head.store(pack(0, numFrames > 0 ? 0 : NONE));
+    }
+
+    ~SpectrumFrameSet()
+    {
+        // every reference must have been released, see SpectrumFramePool::releaseRetired()
+        jassert(isIdle());
+    }
+
+    /// any thread: an unshared frame to fill, empty when every frame is in use
+    SpectrumFrameRef acquire()
+    {
+        uint64_t h = head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            const uint32_t i = indexOf(h);
+            if (i == NONE)
+                return {};
+            const uint64_t next = pack(tagOf(h)+1, frames[i].nextFree.load(std::memory_order_relaxed));
+            if (head.compare_exchange_weak(h, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                inUse.fetch_add(1, std::memory_order_relaxed);
+                frames[i].refs.store(1, std::memory_order_relaxed);
+                return SpectrumFrameRef(&frames[i]);
+            }
+        }
+    }
+
+    uint32_t getNumFrames() const { return (uint32_t)frames.size(); }
+    uint32_t getMaxBins() const { return frames.empty() ? 0 : frames[0].capacity; }
+
+    /// bytes of frame storage, for memory reports
+    size_t getMemoryBytes() const { return arena.getTotalBytes(); }
+
+    /// any thread: no frame of this set is referenced
+    bool isIdle() const { return inUse.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class SpectrumFrameRef;
+    static constexpr uint32_t NONE = 0xffffffffu;
+
+    AnalyzerArena arena;
+    ArenaArray<SpectrumFrame> frames;
+    std::atomic<uint64_t> head { 0 };
+    std::atomic<uint32_t> inUse { 0 };
+
+    static uint64_t pack(uint32_t tag, uint32_t index) { return ((uint64_t)tag << 32) | index; }
+    static uint32_t indexOf(uint64_t h) { return (uint32_t)h; }
+    static uint32_t tagOf(uint64_t h) { return (uint32_t)(h >> 32); }
+
+    void recycle(SpectrumFrame* frame)
+    {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            frame->nextFree.store(indexOf(h), std::memory_order_relaxed);
+            if (head.compare_exchange_weak(h, pack(tagOf(h)+1, frame->index), std::memory_order_release, std::memory_order_relaxed))
+                break;
+        }
+        // the last touch of the set, a retired one may be freed from here on
+        inUse.fetch_sub(1, std::memory_order_release);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumFrameSet)
+};
+
+/// the frames a publisher takes from: the set of the current resolution, and the sets
+/// of earlier resolutions until nothing refers to their frames any more
+class SpectrumFramePool
+{
+public:
+    SpectrumFramePool()
+    {
+    }
+    SpectrumFramePool(uint32_t numFrames, uint32_t maxBins)
+    {
+        setFrames(std::make_unique<SpectrumFrameSet>(numFrames, maxBins));
+    }
+
+    ~SpectrumFramePool()
+    {
+        // every reference must have been released, consumers are destroyed before their pool
+    }
+
+    /// message thread, while no producer acquires: take frames from newFrames from now on,
+    /// the current set is retired until its last frame is back
+    void setFrames(std::unique_ptr<SpectrumFrameSet> newFrames)
+    {
+        if (current != nullptr)
+            retired.push_back(std::move(current));
+        current = std::move(newFrames);
+        releaseRetired();
+    }
+
+    /// message thread: free the retired sets none of whose frames is referenced any more
+    void releaseRetired()
+    {
+        retired.erase(std::remove_if(retired.begin(), retired.end(), [] (const std::unique_ptr<SpectrumFrameSet>& frames) { return frames->isIdle(); }),
+                      retired.end());
+    }
+
+    /// any thread: an unshared frame to fill, empty when every frame is in use (counted as dropped)
+    SpectrumFrameRef acquire()
+    {
+        SpectrumFrameRef frame;
+        if (current != nullptr)
+            frame = current->acquire();
+        if (!frame)
+            exhausted.fetch_add(1, std::memory_order_relaxed);
+        return frame;
+    }
+
+    uint32_t getNumFrames() const { return current == nullptr ? 0 : current->getNumFrames(); }
+    uint32_t getMaxBins() const { return current == nullptr ? 0 : current->getMaxBins(); }
+
+    /// message thread: bytes of frame storage, retired sets included, for memory reports
+    size_t getMemoryBytes() const
+    {
+        size_t bytes = current == nullptr ? 0 : current->getMemoryBytes();
+        for (const auto& frames : retired)
+            bytes += frames->getMemoryBytes();
+        return bytes;
+    }
+
+    /// times acquire() found no free frame, a sign of a stalled consumer
+    juce::uint32 getExhaustedCount() const { return exhausted.load(); }
+
+private:
+    std::unique_ptr<SpectrumFrameSet> current;
+    std::vector<std::unique_ptr<SpectrumFrameSet>> retired;
+    std::atomic<juce::uint32> exhausted { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumFramePool)
+};
+
+inline void SpectrumFrameRef::reset()
+{
+    if (frame != nullptr && frame->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        frame->set->recycle(frame);
+    frame = nullptr;
+}
+
+/// single-producer single-consumer queue of frame references, preallocated
+class SpectrumFrameQueue
+{
+public:
+    explicit SpectrumFrameQueue(uint32_t capacityPowerOfTwo): slots(capacityPowerOfTwo)
+    {
+        jassert(juce::isPowerOfTwo(capacityPowerOfTwo));
+    }
+
+    ~SpectrumFrameQueue()
+    {
+    }
+
+    /// producer: false when full, the frame is then not kept
+    bool push(const SpectrumFrameRef& frame)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        if (w-readIndex.load(std::memory_order_acquire) >= (uint32_t)slots.size())
+            return false;
+        slots[w & (slots.size()-1)] = frame;
+        writeIndex.store(w+1, std::memory_order_release);
+        return true;
+    }
+
+    /// consumer: false when empty
+    bool pop(SpectrumFrameRef& frame)
+    {
+        const uint32_t r = readIndex.load(std::memory_order_relaxed);
+        if (r == writeIndex.load(std::memory_order_acquire))
+            return false;
+        frame = std::move(slots[r & (slots.size()-1)]);
+        readIndex.store(r+1, std::memory_order_release);
+        return true;
+    }
+
+    bool isFull() const { return writeIndex.load()-readIndex.load() >= (uint32_t)slots.size(); }
+
+    /// consumer: release everything queued
+    void clear()
+    {
+        SpectrumFrameRef frame;
+        while (pop(frame))
+            frame.reset();
+    }
+
+private:
+    std::vector<SpectrumFrameRef> slots;
+    std::atomic<uint32_t> writeIndex { 0 };
+    std::atomic<uint32_t> readIndex { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumFrameQueue)
+};
+
+/// anything that wants published frames, offer() runs on the producing thread and must not block
+/// (apart from an offline render waiting on purpose) or allocate, keeping the frame is copying the reference
+class SpectrumFrameConsumer
+{
+public:
+    virtual ~SpectrumFrameConsumer()
+    {
+    }
+    virtual void offer(const SpectrumFrameRef& frame) = 0;
+};
+
+/// the most recent frames offered, for a consumer that subscribes late (a view opening) to start from
+/// written by the one producing thread, read and cleared only while that thread is kept away
+class SpectrumFrameHistory : public SpectrumFrameConsumer
+{
+public:
+    /// maxCapacity: the most frames setCapacity() will be asked to keep
+    explicit SpectrumFrameHistory(uint32_t maxCapacity): frames(maxCapacity), capacity(maxCapacity)
+    {
+    }
+
+    ~SpectrumFrameHistory() override
+    {
+    }
+
+    /// producer: keep the frame in place of the oldest one, zoom frames too (the owner clears them when the band changes)
+    void offer(const SpectrumFrameRef& frame) override
+    {
+        frames[writeCount % capacity] = frame;
+        writeCount++;
+    }
+
+    /// producer stopped: offer the kept frames to another consumer, oldest first
+    void replayTo(SpectrumFrameConsumer& consumer) const
+    {
+        const size_t numKept = juce::jmin(writeCount, capacity);
+        for (size_t i=writeCount-numKept;i<writeCount;i++)
+            consumer.offer(frames[i % capacity]);
+    }
+
+    /// producer stopped: keep the newCapacity most recent frames (at most maxCapacity), releases everything kept
+    void setCapacity(uint32_t newCapacity)
+    {
+        clear();
+        capacity = juce::jlimit((size_t)1, frames.size(), (size_t)newCapacity);
+    }
+
+    /// producer stopped: release everything kept
+    void clear()
+    {
+        for (auto& frame : frames)
+            frame.reset();
+        writeCount = 0;
+    }
+
+    /// bytes of the references kept, the frames themselves are the pool's
+    size_t getMemoryBytes() const { return vectorBytes(frames); }
+
+private:
+    std::vector<SpectrumFrameRef> frames;
+    size_t capacity;
+    size_t writeCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumFrameHistory)
+};
+
+/// fan-out of frames to a fixed number of consumer slots
+class SpectrumPublisher
+{
+public:
+    static constexpr int MAXCONSUMERS = 8;
+
+    explicit SpectrumPublisher(SpectrumFramePool& framePool): pool(framePool)
+    {
+    }
+
+    ~SpectrumPublisher()
+    {
+    }
+
+    /// message thread only, while no producer is publishing (detached)
+    void addConsumer(SpectrumFrameConsumer* consumer)
+    {
+        for (auto& slot : consumers)
+        {
+            if (slot == consumer)
+                return;
+            if (slot == nullptr)
+            {
+                slot = consumer;
+                return;
+            }
+        }
+        jassertfalse;   // raise MAXCONSUMERS
+    }
+
+    /// message thread only, while no producer is publishing (detached)
+    void removeConsumer(SpectrumFrameConsumer* consumer)
+    {
+        for (auto& slot : consumers)
+            if (slot == consumer)
+                slot = nullptr;
+    }
+
+    SpectrumFramePool& getPool() { return pool; }
+
+    /// producer: stamp the frame and hand it to every consumer, the caller's reference is kept
+    void publish(const SpectrumFrameRef& frame)
+    {
+        if (!frame)
+            return;
+        frame.getForWriting()->ticks = juce::Time::getHighResolutionTicks();
+        for (auto* consumer : consumers)
+            if (consumer != nullptr)
+                consumer->offer(frame);
+    }
+
+private:
+    SpectrumFramePool& pool;
+    SpectrumFrameConsumer* consumers[MAXCONSUMERS] {};
+
+    JUCE_DECLARE_NON_COPYABLE(SpectrumPublisher)
+};
@@ -20,15 +20,71 @@ inline float amp2db(float amp)
     return dbNegative;  // expected to return -inf when amp=0.0f
 }
 
+/// magnitudes to display dB in place, with a per-bin dB offset (weighting and tilt, see WeightingTable) added
+/// in the same pass: one add per bin, and a straight loop without calls into pow so it can vectorize
+/// the floor is applied to the weighted level, offsetDB nullptr for none
+inline void amp2db(float* data, const float* offsetDB, size_t numBins)
+{
+    // smallest power passed to log10, far enough below the floor for any offset to leave it there
+    const float minPower = 1e-30f;
+    if (offsetDB == nullptr)
+    {
+        for (size_t i=0;i<numBins;i++)
+        {
+            const float power = data[i]*data[i];
+            data[i] = juce::jmax(FLOOR, 20.0f*std::log10(juce::jmax(power, minPower)));
+        }
+        return;
+    }
+    for (size_t i=0;i<numBins;i++)
+    {
+        const float power = data[i]*data[i];
+        data[i] = juce::jmax(FLOOR, 20.0f*std::log10(juce::jmax(power, minPower)) + offsetDB[i]);
+    }
+}
+
 inline void amp2db(std::vector<float>& input)
 {
-    for (int i=0;i<size(input);i++)
+    amp2db(input.data(), nullptr, input.size());
+}
+
+/// display dB (40 log10 of the magnitude) to dBFS of a sine for an fftSize point frame, where a full
+/// scale sine reads fftSize/4 through the Hann combination
+inline float display2dbfs(float displayDB, int fftSize)
+{
+    return 0.5f*displayDB - 20.0f*std::log10(0.25f*(float)fftSize);
+}
+
+/// cosine usable in constant expressions (range reduced Taylor series), for compile-time tables
+constexpr double cosConstexpr(double x)
+{
+    const double pi = 3.14159265358979323846;
+    while (x > pi) x -= 2.0*pi;
+    while (x < -pi) x += 2.0*pi;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n=1;n<=24;n++)
     {
-        if (pow(input[i],2.0f) < 1e-16) {input[i] = FLOOR;}
-        else {input[i] = 20.0f*log10( pow(input[i],2.0f) );}
+        term *= -x*x/((2.0*n-1.0)*(2.0*n));
+        sum += term;
     }
+    return sum;
 }
 
+/// periodic Hann window scaled to unity coherent gain, so tone levels match the unwindowed spectrum
+template <size_t N>
+constexpr std::array<float,N> makeHannWindow()
+{
+    std::array<float,N> window {};
+    for (size_t i=0;i<N;i++)
+        window[i] = (float)(1.0-cosConstexpr(2.0*3.14159265358979323846*(double)i/(double)N));
+    return window;
+}
+
+/// one table per window length, generated at compile time
+template <size_t N>
+inline constexpr std::array<float,N> hannWindow = makeHannWindow<N>();
+
 /// fft bin to frequency conversion - probably won't use this one in spectrometer
 inline float bin2freq(float sr, uint32_t maxBin, uint32_t bin)
 {
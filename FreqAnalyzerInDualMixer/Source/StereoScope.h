@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    StereoScope.h
+    Created: 22 Oct 2026 5:04:51pm
+    Author:  Louis Deng
+
+    stereo diagnostics of the output: phase correlation, L/R balance and a
+    goniometer (vectorscope) point cloud
+
+    the audio thread only sums LL, RR and LR over each block (dot products,
+    four partial sums so they vectorize) into smoothed energies, and decimates
+    the mid/side points: of every group of samples it keeps the two with the
+    lowest and highest mid value, so peaks survive the decimation. points go
+    into a single-producer single-consumer ring (an AnalyzerArena block
+    allocated with the scope, points are dropped while it is full), the
+    message thread picks up the new ones and writes them straight into an
+    image that fades a little every frame
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "AnalyzerArena.h"
+
+class StereoScope
+{
+public:
+    struct Point { float side, mid; };
+
+    StereoScope()
+    {
+        const size_t ringAt = arena.reserve<Point>("stereo scope ring", RINGSIZE);
+        arena.allocate();
+        ring = arena.place<Point>(ringAt, RINGSIZE);
+    }
+
+    ~StereoScope()
+    {
+    }
+
+    /// message thread, while no audio thread is processing
+    void prepare(double sampleRate)
+    {
+        readIndex.store(writeIndex.load());
+        sr = sampleRate;
+        // two points kept per group, about POINTRATE points a second
+        groupSize = juce::jmax(1, juce::roundToInt(2.0*sampleRate/POINTRATE));
+        groupCount = 0;
+        smoothLL = smoothRR = smoothLR = 0.0;
+        correlation.store(0.0f);
+        balance.store(0.0f);
+    }
+
+    /// audio thread: one block of the left and right output
+    template <typename SampleType>
+    void processBlock(const SampleType* left, const SampleType* right, int numSamples)
+    {
+        if (numSamples <= 0)
+            return;
+
+        // energies, independent partial sums so the loop vectorizes without reassociation
+        float ll[4] {}, rr[4] {}, lr[4] {};
+        int i = 0;
+        for (;i+4<=numSamples;i+=4)
+        {
+            for (int k=0;k<4;k++)
+            {
+                const float l = (float)left[i+k];
+                const float r = (float)right[i+k];
+                ll[k] += l*l;
+                rr[k] += r*r;
+                lr[k] += l*r;
+            }
+        }
+        for (;i<numSamples;i++)
+        {
+            const float l = (float)left[i];
+            const float r = (float)right[i];
+            ll[0] += l*l;
+            rr[0] += r*r;
+            lr[0] += l*r;
+        }
+        const double blockLL = (double)ll[0]+ll[1]+ll[2]+ll[3];
+        const double blockRR = (double)rr[0]+rr[1]+rr[2]+rr[3];
+        const double blockLR = (double)lr[0]+lr[1]+lr[2]+lr[3];
+
+        const double blend = 1.0-std::exp(-(double)numSamples/(INTEGRATIONSECONDS*sr));
+        smoothLL += blend*(blockLL/numSamples - smoothLL);
+        smoothRR += blend*(blockRR/numSamples - smoothRR);
+        smoothLR += blend*(blockLR/numSamples - smoothLR);
+        const double product = smoothLL*smoothRR;
+        correlation.store(product > 1e-20 ? (float)(smoothLR/std::sqrt(product)) : 0.0f, std::memory_order_relaxed);
+        const double sum = smoothLL+smoothRR;
+        balance.store(sum > 1e-20 ? (float)((smoothRR-smoothLL)/sum) : 0.0f, std::memory_order_relaxed);
+
+        // min/max preserving decimation of the mid/side points
+        uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        const uint32_t consumed = readIndex.load(std::memory_order_acquire);
+        for (int n=0;n<numSamples;n++)
+        {
+            const float l = (float)left[n];
+            const float r = (float)right[n];
+            const Point p { (r-l)*juce::MathConstants<float>::sqrt2*0.5f, (l+r)*juce::MathConstants<float>::sqrt2*0.5f };
+            if (groupCount == 0 || p.mid < groupLow.mid) groupLow = p;
+            if (groupCount == 0 || p.mid > groupHigh.mid) groupHigh = p;
+            if (++groupCount == groupSize)
+            {
+                // the message thread is not keeping up (or not looking), drop rather than overwrite
+                if (w-consumed <= RINGSIZE-2)
+                {
+                    ring[w++ & (RINGSIZE-1)] = groupLow;
+                    ring[w++ & (RINGSIZE-1)] = groupHigh;
+                }
+                groupCount = 0;
+            }
+        }
+        writeIndex.store(w, std::memory_order_release);
+    }
+
+    /// -1 (out of phase) .. +1 (mono), any thread
+    float getCorrelation() const { return correlation.load(std::memory_order_relaxed); }
+    /// -1 (left only) .. +1 (right only), any thread
+    float getBalance() const { return balance.load(std::memory_order_relaxed); }
+
+    /// bytes of the point ring
+    size_t getMemoryBytes() const { return arena.getTotalBytes(); }
+
+    /// message thread: fade the image and plot the points written since the last call, returns false if none
+    bool render(juce::Image& image)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_acquire);
+        uint32_t r = readIndex.load(std::memory_order_relaxed);
+        // after a pause only the newest points are worth drawing
+        if (w-r > MAXPOINTSPERFRAME)
+            r = w-MAXPOINTSPERFRAME;
+        if (w == r)
+            return false;
+
+        const int size = juce::jmin(image.getWidth(), image.getHeight());
+        juce::Image::BitmapData pixels(image, juce::Image::BitmapData::readWrite);
+        for (int y=0;y<size;y++)
+        {
+            auto* line = reinterpret_cast<juce::PixelARGB*>(pixels.getLinePointer(y));
+            for (int x=0;x<size;x++)
+                line[x].multiplyAlpha(FADE);
+        }
+
+        const juce::PixelARGB dot = juce::Colours::limegreen.withAlpha(0.5f).getPixelARGB();
+        const float half = 0.5f*(size-1);
+        for (;r!=w;r++)
+        {
+            const Point p = ring[r & (RINGSIZE-1)];
+            // full scale at the edge, mid upwards
+            const int x = juce::roundToInt(half+p.side*half);
+            const int y = juce::roundToInt(half-p.mid*half);
+            if (x < 0 || y < 0 || x >= size || y >= size)
+                continue;
+            reinterpret_cast<juce::PixelARGB*>(pixels.getLinePointer(y))[x].blend(dot);
+        }
+        readIndex.store(w, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t RINGSIZE = 1 << 15;
+    static constexpr uint32_t MAXPOINTSPERFRAME = 1 << 12;
+    static constexpr double POINTRATE = 24000.0;
+    static constexpr double INTEGRATIONSECONDS = 0.3;
+    static constexpr float FADE = 0.8f;
+
+    double sr = 48000.0;
+    double smoothLL = 0.0, smoothRR = 0.0, smoothLR = 0.0;
+    std::atomic<float> correlation { 0.0f };
+    std::atomic<float> balance { 0.0f };
+
+    AnalyzerArena arena;
+    ArenaArray<Point> ring;
+    std::atomic<uint32_t> writeIndex { 0 };
+    std::atomic<uint32_t> readIndex { 0 };
+    int groupSize = 4;
+    int groupCount = 0;
+    Point groupLow {}, groupHigh {};
+
+    JUCE_DECLARE_NON_COPYABLE(StereoScope)
+};
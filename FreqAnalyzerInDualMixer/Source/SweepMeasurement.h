@@ -0,0 +1,516 @@
+/*
+  ==============================================================================
+
+    SweepMeasurement.h
+    Created: 24 Oct 2026 11:05:32am
+    Author:  Louis Deng
+
+    exponential sine sweep (Farina) measurement of the wet path: impulse and
+    frequency response, and the harmonic distortion orders separated in time
+
+    while a measurement runs the sweep replaces the plugin's input, so the dry
+    signal is the sweep and the wet signal is whatever the wet path makes of
+    it. the audio thread only copies the precomputed sweep out and the dry and
+    wet samples into buffers allocated when the measurement was started (it
+    try-locks, so a restart from the message thread never makes it wait).
+    once the sweep and a silent tail have been recorded a background thread
+    convolves both recordings with the inverse filter (time reversed sweep
+    with a 6 dB/octave envelope) through PartitionedConvolver. the dry result
+    is the reference: its peak marks time zero and unity gain. in the wet
+    result the linear impulse response sits at that peak and harmonic order n
+    arrives L ln(n) earlier, L = T / ln(f2/f1), so each is windowed out and
+    transformed on its own
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "FastConvolution.h"
+
+class SweepMeasurement : private juce::Thread
+{
+public:
+    /// linear response and harmonics 2..MAXORDER
+    static constexpr int MAXORDER = 5;
+    /// log spaced response points between the sweep's start and end frequencies
+    static constexpr int RESPONSEPOINTS = 256;
+    /// sweep level, loud enough to stay clear of the noise without driving the wet path into clipping
+    static constexpr float DEFAULTLEVEL_DB = -12.0f;
+
+    enum State
+    {
+        idle = 0,
+        running,        // sweep playing and being recorded
+        analysing,      // recorded, deconvolving on the background thread
+        done,
+        failed
+    };
+
+    struct Results
+    {
+        double sampleRate = 48000.0;
+        /// linear impulse response of the wet path, unity gain, PREROLL_S before time zero
+        std::vector<float> impulse;
+        int impulseZero = 0;
+        /// wet path delay against the dry signal, samples
+        int latency = 0;
+        /// excitation frequencies of the response points, Hz
+        std::vector<float> frequencies;
+        /// [0] linear response, [n-1] level of harmonic n, dB against the input level, below MINDB where not measured
+        std::vector<float> responseDB[MAXORDER];
+    };
+
+    /// response points at or below this were not measured (harmonic above Nyquist)
+    static constexpr float MINDB = -200.0f;
+
+    SweepMeasurement(): juce::Thread("FreqAnalyzer sweep")
+    {
+    }
+
+    ~SweepMeasurement() override
+    {
+        stopThread(4000);
+    }
+
+    /// message thread: sweep 20 Hz .. 20 kHz (or below Nyquist) over durationSeconds at levelDB (dBFS),
+    /// replaces a measurement that is still running or analysing
+    void start(double sampleRate, double durationSeconds, float levelDB)
+    {
+        stopThread(4000);
+        {
+            // the audio thread skips the block rather than wait for this
+            const juce::SpinLock::ScopedLockType lock(bufferLock);
+            state.store(idle);
+
+            sr = sampleRate;
+            f1 = FSTART;
+            f2 = juce::jmin(FEND, 0.45*sampleRate);
+            const int sweepLength = juce::roundToInt(durationSeconds*sampleRate);
+            sweepRate = durationSeconds/std::log(f2/f1);
+            makeSweep(sweepLength, juce::Decibels::decibelsToGain(levelDB));
+            recordLength = sweepLength+juce::roundToInt(TAIL_S*sampleRate);
+            dry.assign((size_t)recordLength, 0.0f);
+            wet.assign((size_t)recordLength, 0.0f);
+            generatePosition = 0;
+            recordPosition = 0;
+            progress.store(0.0f);
+            state.store(running, std::memory_order_release);
+        }
+        startThread();
+    }
+
+    /// message thread: stop playing the sweep and drop the measurement, results of an earlier one stay
+    void cancel()
+    {
+        stopThread(4000);
+        const juce::SpinLock::ScopedLockType lock(bufferLock);
+        state.store(idle);
+    }
+
+    State getState() const { return (State)state.load(std::memory_order_acquire); }
+    /// 0..1 through recording, then through the analysis
+    float getProgress() const { return progress.load(std::memory_order_relaxed); }
+
+    /// message thread: copy the results of the last finished measurement if there are newer ones than lastVersion
+    bool getResultsIfNew(uint32_t& lastVersion, Results& out) const
+    {
+        const juce::ScopedLock sl(resultLock);
+        if (resultsVersion == lastVersion)
+            return false;
+        lastVersion = resultsVersion;
+        out = results;
+        return true;
+    }
+
+    /// audio thread, before the dry signal is taken: overwrite the input with the sweep (silence in the tail)
+    template <typename SampleType>
+    void generate(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        if (state.load(std::memory_order_acquire) != running)
+            return;
+        const juce::SpinLock::ScopedTryLockType lock(bufferLock);
+        if (!lock.isLocked() || state.load(std::memory_order_relaxed) != running)
+            return;
+
+        const int sweepLength = (int)sweep.size();
+        for (int i=0;i<numSamples;i++)
+        {
+            const int n = generatePosition+i;
+            const SampleType sample = n < sweepLength ? (SampleType)sweep[n] : (SampleType)0;
+            for (int channel=0;channel<numChannels;channel++)
+                channels[channel][i] = sample;
+        }
+        generatePosition += numSamples;
+    }
+
+    /// audio thread, after the wet path: record the dry and wet left channel, hands over to the analysis when full
+    template <typename SampleType>
+    void record(const SampleType* drySamples, const SampleType* wetSamples, int numSamples)
+    {
+        if (state.load(std::memory_order_acquire) != running)
+            return;
+        const juce::SpinLock::ScopedTryLockType lock(bufferLock);
+        if (!lock.isLocked() || state.load(std::memory_order_relaxed) != running)
+            return;
+
+        const int numRecord = juce::jmin(numSamples, recordLength-recordPosition);
+        for (int i=0;i<numRecord;i++)
+        {
+            dry[recordPosition+i] = (float)drySamples[i];
+            wet[recordPosition+i] = (float)wetSamples[i];
+        }
+        recordPosition += numRecord;
+        progress.store(0.5f*(float)recordPosition/(float)recordLength, std::memory_order_relaxed);
+        if (recordPosition == recordLength)
+            state.store(analysing, std::memory_order_release);
+    }
+
+private:
+    static constexpr double FSTART = 20.0;
+    static constexpr double FEND = 20000.0;
+    static constexpr double TAIL_S = 1.0;
+    static constexpr double FADEIN_S = 0.05;
+    static constexpr double FADEOUT_S = 0.005;
+    /// impulse response window: before time zero, and at most after it
+    static constexpr double PREROLL_S = 0.005;
+    static constexpr double IRLENGTH_S = 0.5;
+    /// a harmonic window stops this long before the next lower order's, clear of the ringing that
+    /// response has ahead of its peak from the sweep's band limits
+    static constexpr double GUARD_S = 0.02;
+    static constexpr int BLOCKORDER = 13;
+    static constexpr int POLL_MS = 50;
+
+    // set up by start() under bufferLock, then owned by the audio thread while running
+    // and by the analysis thread once analysing
+    juce::SpinLock bufferLock;
+    std::atomic<int> state { idle };
+    std::atomic<float> progress { 0.0f };
+    double sr = 48000.0;
+    double f1 = FSTART;
+    double f2 = FEND;
+    double sweepRate = 1.0;     // L, seconds per e-fold of frequency
+    std::vector<float> sweep;
+    std::vector<float> dry;
+    std::vector<float> wet;
+    int recordLength = 0;
+    int generatePosition = 0;
+    int recordPosition = 0;
+
+    juce::CriticalSection resultLock;
+    Results results;
+    uint32_t resultsVersion = 0;
+
+    void makeSweep(int length, float gain)
+    {
+        sweep.resize((size_t)length);
+        const double k = juce::MathConstants<double>::twoPi*f1*sweepRate;
+        for (int n=0;n<length;n++)
+        {
+            const double t = n/sr;
+            sweep[n] = (float)(gain*sweepEnvelope(n, length)*std::sin(k*(std::exp(t/sweepRate)-1.0)));
+        }
+    }
+
+    /// raised cosine fade in at the low end and out at the high end of a sweep of length samples
+    double sweepEnvelope(int n, int length) const
+    {
+        const int fadeIn = juce::jmin(length/4, juce::roundToInt(FADEIN_S*sr));
+        const int fadeOut = juce::jmin(length/4, juce::roundToInt(FADEOUT_S*sr));
+        if (n < fadeIn)
+            return 0.5-0.5*std::cos(juce::MathConstants<double>::pi*n/fadeIn);
+        if (n >= length-fadeOut)
+            return 0.5-0.5*std::cos(juce::MathConstants<double>::pi*(length-1-n)/fadeOut);
+        return 1.0;
+    }
+
+    void run() override
+    {
+        while (getState() == running)
+        {
+            if (threadShouldExit())
+                return;
+            wait(POLL_MS);
+        }
+        if (getState() != analysing)
+            return;
+
+        Results measured;
+        if (analyse(measured))
+        {
+            {
+                const juce::ScopedLock sl(resultLock);
+                results = std::move(measured);
+                resultsVersion++;
+            }
+            state.store(done, std::memory_order_release);
+        }
+        else if (!threadShouldExit())
+            state.store(failed, std::memory_order_release);
+    }
+
+    /// false when cancelled, or when the dry recording shows no sweep (the audio thread was not running it)
+    bool analyse(Results& measured)
+    {
+        // inverse filter: the sweep reversed, amplitude falling 6 dB/octave from its high end. it carries the
+        // sweep's fades too: cut off at its start, it would pass a copy of the sweep itself, arriving
+        // L ln(f2/f) before time zero at every f, right through the harmonic windows
+        const int sweepLength = (int)sweep.size();
+        std::vector<float> inverse((size_t)sweepLength);
+        for (int n=0;n<sweepLength;n++)
+        {
+            const double t = n/sr;
+            inverse[n] = (float)(std::sin(juce::MathConstants<double>::twoPi*f1*sweepRate*(std::exp((sweepLength-1-n)/sr/sweepRate)-1.0))
+                                 *std::exp(-t/sweepRate)*sweepEnvelope(sweepLength-1-n, sweepLength));
+        }
+
+        std::vector<float> dryResponse, wetResponse;
+        if (!deconvolve(inverse, dry, dryResponse, 0.75f) || !deconvolve(inverse, wet, wetResponse, 1.0f))
+            return false;
+
+        // time zero and the impulse scale from the dry signal, which is the sweep itself
+        int zero = 0;
+        for (int n=1;n<(int)dryResponse.size();n++)
+            if (std::abs(dryResponse[n]) > std::abs(dryResponse[zero]))
+                zero = n;
+        const float reference = dryResponse[zero];
+        if (std::abs(reference) < 1e-9f)
+            return false;
+        for (auto& sample : dryResponse)
+            sample /= reference;
+        for (auto& sample : wetResponse)
+            sample /= reference;
+
+        // the wet path may delay the signal, look for its peak within the tail
+        const int tail = recordLength-sweepLength;
+        int peak = zero;
+        for (int n=zero;n<juce::jmin((int)wetResponse.size(), zero+tail/2);n++)
+            if (std::abs(wetResponse[n]) > std::abs(wetResponse[peak]))
+                peak = n;
+
+        measured.sampleRate = sr;
+        measured.latency = peak-zero;
+        const int preroll = juce::roundToInt(PREROLL_S*sr);
+        // the windows start preroll samples before the dry and wet peaks (peak >= zero)
+        if (zero < preroll)
+            return false;
+        const int irLength = juce::jmin(juce::roundToInt(IRLENGTH_S*sr), (int)wetResponse.size()-peak+preroll);
+        measured.impulseZero = preroll;
+        measured.impulse.assign(wetResponse.begin()+(peak-preroll), wetResponse.begin()+(peak-preroll+irLength));
+
+        measured.frequencies.resize(RESPONSEPOINTS);
+        for (int i=0;i<RESPONSEPOINTS;i++)
+            measured.frequencies[i] = (float)(f1*std::pow(f2/f1, i/(RESPONSEPOINTS-1.0)));
+
+        // the dry response in the same window is the input level, so the wet levels come out relative to it
+        // (the deconvolved sweep is only roughly flat, dividing by it takes out its ripple at the band edges)
+        std::vector<float> inputDB(RESPONSEPOINTS, MINDB);
+        spectrumOf(dryResponse.data()+zero-preroll, juce::jmin(irLength, (int)dryResponse.size()-zero+preroll), preroll, 1, measured.frequencies, inputDB);
+
+        // order n arrives L ln(n) before the linear response, and runs until shortly before order n-1 begins
+        const int guard = juce::roundToInt(GUARD_S*sr);
+        for (int order=1;order<=MAXORDER;order++)
+        {
+            const int start = peak-juce::roundToInt(sweepRate*std::log((double)order)*sr)-preroll;
+            const int spacing = order == 1 ? irLength : juce::roundToInt(sweepRate*std::log(order/(order-1.0))*sr)-guard;
+            const int length = juce::jmin(irLength, spacing);
+            auto& response = measured.responseDB[order-1];
+            response.assign(RESPONSEPOINTS, MINDB);
+            if (start < 0 || length <= preroll*2)
+                continue;
+            spectrumOf(wetResponse.data()+start, length, preroll, order, measured.frequencies, response);
+            for (int i=0;i<RESPONSEPOINTS;i++)
+                if (response[i] > MINDB)
+                    response[i] -= inputDB[i];
+        }
+        progress.store(1.0f);
+        return true;
+    }
+
+    /// full convolution of a recording with the inverse filter, up to the end of the recording
+    bool deconvolve(const std::vector<float>& inverse, const std::vector<float>& recording, std::vector<float>& output, float progressEnd)
+    {
+        PartitionedConvolver convolver(inverse.data(), (int)inverse.size(), BLOCKORDER);
+        const int blockSize = convolver.getBlockSize();
+        const int numBlocks = ((int)recording.size()+blockSize-1)/blockSize;
+        output.assign((size_t)numBlocks*blockSize, 0.0f);
+        std::vector<float> block((size_t)blockSize);
+        const float progressStart = progress.load();
+        for (int b=0;b<numBlocks;b++)
+        {
+            if (threadShouldExit())
+                return false;
+            const int start = b*blockSize;
+            const int length = juce::jmin(blockSize, (int)recording.size()-start);
+            std::fill(block.begin(), block.end(), 0.0f);
+            std::copy(recording.begin()+start, recording.begin()+start+length, block.begin());
+            convolver.processBlock(block.data(), output.data()+start);
+            progress.store(progressStart+(progressEnd-progressStart)*(b+1)/numBlocks, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /// levels (dB) of a windowed slice of the deconvolved signal at order x the excitation frequencies
+    void spectrumOf(const float* slice, int length, int fade, int order, const std::vector<float>& frequencies, std::vector<float>& levelsDB)
+    {
+        const int fftOrder = juce::jlimit(8, 18, (int)std::ceil(std::log2((double)length)));
+        const int fftSize = 1 << fftOrder;
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> buffer((size_t)fftSize*2, 0.0f);
+        for (int n=0;n<juce::jmin(length, fftSize);n++)
+        {
+            // half Hann fades at both ends of the window
+            double envelope = 1.0;
+            if (n < fade)
+                envelope = 0.5-0.5*std::cos(juce::MathConstants<double>::pi*n/fade);
+            else if (n >= length-fade)
+                envelope = 0.5-0.5*std::cos(juce::MathConstants<double>::pi*(length-1-n)/fade);
+            buffer[n] = (float)(slice[n]*envelope);
+        }
+        fft.performFrequencyOnlyForwardTransform(buffer.data(), true);
+
+        for (size_t i=0;i<frequencies.size();i++)
+        {
+            const double f = order*(double)frequencies[i];
+            if (f >= 0.5*sr)
+                continue;
+            const double bin = f*fftSize/sr;
+            const int lower = (int)bin;
+            const double fraction = bin-lower;
+            const double magnitude = buffer[lower]+(buffer[lower+1]-buffer[lower])*fraction;
+            levelsDB[i] = (float)juce::jmax((double)MINDB+1.0, 20.0*std::log10(juce::jmax(magnitude, 1e-12)));
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(SweepMeasurement)
+};
+
+/// results of the last sweep measurement: linear and harmonic responses over a log frequency axis,
+/// the impulse response in a strip along the bottom
+class SweepResultView : public juce::Component
+{
+public:
+    SweepResultView()
+    {
+    }
+
+    ~SweepResultView()
+    {
+    }
+
+    void setResults(const SweepMeasurement::Results& newResults)
+    {
+        results = newResults;
+        repaint();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.fillAll(juce::Colours::black);
+        g.setColour(juce::Colours::white);
+        g.drawRect(getLocalBounds());
+        if (results.frequencies.empty())
+            return;
+
+        const auto plot = getLocalBounds().reduced(1).withTrimmedBottom(IMPULSEHEIGHT).toFloat();
+        const float fLow = results.frequencies.front();
+        const float fHigh = results.frequencies.back();
+        auto xOf = [&] (float f) { return plot.getX()+plot.getWidth()*std::log(f/fLow)/std::log(fHigh/fLow); };
+        auto yOf = [&] (float dB) { return plot.getY()+plot.getHeight()*(TOPDB-dB)/(TOPDB-BOTTOMDB); };
+
+        // grid: decades and every 20 dB
+        g.setFont(11.0f);
+        for (float f : { 100.0f, 1000.0f, 10000.0f })
+        {
+            if (f <= fLow || f >= fHigh)
+                continue;
+            g.setColour(juce::Colours::grey.withAlpha(0.4f));
+            g.drawVerticalLine(juce::roundToInt(xOf(f)), plot.getY(), plot.getBottom());
+            g.setColour(juce::Colours::grey);
+            g.drawSingleLineText(f < 1000.0f ? juce::String((int)f) : juce::String((int)f/1000) + "k", juce::roundToInt(xOf(f))+2, juce::roundToInt(plot.getBottom())-2);
+        }
+        for (float dB=TOPDB;dB>=BOTTOMDB;dB-=20.0f)
+        {
+            g.setColour(juce::Colours::grey.withAlpha(0.4f));
+            g.drawHorizontalLine(juce::roundToInt(yOf(dB)), plot.getX(), plot.getRight());
+            g.setColour(juce::Colours::grey);
+            g.drawSingleLineText(juce::String((int)dB) + " dB", juce::roundToInt(plot.getX())+2, juce::roundToInt(yOf(dB))-2);
+        }
+
+        const juce::Colour colours[SweepMeasurement::MAXORDER] =
+            { juce::Colours::white, juce::Colours::red, juce::Colours::orange, juce::Colours::yellow, juce::Colours::limegreen };
+        for (int order=SweepMeasurement::MAXORDER;order>=1;order--)
+        {
+            const auto& response = results.responseDB[order-1];
+            juce::Path path;
+            bool drawing = false;
+            for (size_t i=0;i<response.size();i++)
+            {
+                if (response[i] <= SweepMeasurement::MINDB)
+                {
+                    drawing = false;
+                    continue;
+                }
+                const float x = xOf(results.frequencies[i]);
+                const float y = juce::jlimit(plot.getY(), plot.getBottom(), yOf(response[i]));
+                if (drawing)
+                    path.lineTo(x, y);
+                else
+                    path.startNewSubPath(x, y);
+                drawing = true;
+            }
+            g.setColour(colours[order-1]);
+            g.strokePath(path, juce::PathStrokeType(order == 1 ? 1.5f : 1.0f));
+            g.drawSingleLineText(order == 1 ? juce::String("linear") : "H" + juce::String(order),
+                                 juce::roundToInt(plot.getRight())-48, juce::roundToInt(plot.getY())+14+12*(order-1));
+        }
+
+        paintImpulse(g, getLocalBounds().reduced(1).removeFromBottom(IMPULSEHEIGHT).toFloat());
+    }
+
+private:
+    static constexpr int IMPULSEHEIGHT = 60;
+    static constexpr float TOPDB = 20.0f;
+    static constexpr float BOTTOMDB = -120.0f;
+
+    SweepMeasurement::Results results;
+
+    /// the impulse response scaled to its peak, time zero marked, the latency written next to it
+    void paintImpulse(juce::Graphics& g, juce::Rectangle<float> area)
+    {
+        g.setColour(juce::Colours::grey.withAlpha(0.4f));
+        g.drawHorizontalLine(juce::roundToInt(area.getY()), area.getX(), area.getRight());
+        const auto& impulse = results.impulse;
+        if (impulse.empty())
+            return;
+
+        float peak = 1e-9f;
+        for (float sample : impulse)
+            peak = juce::jmax(peak, std::abs(sample));
+        const float centre = area.getCentreY();
+        const float scale = 0.45f*area.getHeight()/peak;
+        // the loudest sample of each pixel column, so a long response still shows its decay
+        juce::Path path;
+        const int width = juce::jmax(1, (int)area.getWidth());
+        for (int x=0;x<width;x++)
+        {
+            const size_t first = (size_t)x*impulse.size()/width;
+            const size_t last = juce::jmax(first+1, (size_t)(x+1)*impulse.size()/width);
+            float extreme = 0.0f;
+            for (size_t i=first;i<last && i<impulse.size();i++)
+                if (std::abs(impulse[i]) > std::abs(extreme))
+                    extreme = impulse[i];
+            if (x == 0)
+                path.startNewSubPath(area.getX(), centre-extreme*scale);
+            else
+                path.lineTo(area.getX()+x, centre-extreme*scale);
+        }
+        g.setColour(juce::Colours::skyblue);
+        g.strokePath(path, juce::PathStrokeType(1.0f));
+
+        g.setColour(juce::Colours::grey);
+        g.drawSingleLineText("impulse, latency " + juce::String(results.latency) + " smps",
+                             juce::roundToInt(area.getX())+4, juce::roundToInt(area.getY())+12);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(SweepResultView)
+};
@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    TraceLog.h
+    Created: 19 Oct 2026 10:12:31am
+    Author:  Louis Deng
+
+    opt-in begin/end event tracing for audio callbacks, fft hops, spectrum
+    publishes and paints, written to a Chrome trace JSON file (chrome://tracing,
+    ui.perfetto.dev)
+
+    off by default, add FA_TRACE=1 to the preprocessor definitions to enable,
+    the trace is written to the temp directory as FreqAnalyzerTrace_<time>.json
+
+    each traced thread claims one of MAXTHREADS rings on its first event and
+    hands it back when it exits, the writer frees the ring once it has drained
+    it, so host worker threads that come and go do not use the rings up
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef FA_TRACE
+ #define FA_TRACE 0
+#endif
+
+#if FA_TRACE
+
+namespace TraceLog
+{
+const int MAXTHREADS = 8;          // number of threads that can be traced at once
+const uint32_t RINGSIZE = 1 << 14; // events per thread ring, power of 2
+const int DRAININTERVAL_MS = 50;   // writer thread wakeup interval
+
+struct Event
+{
+    const char* name;   // must be a string literal, only the pointer is stored
+    juce::int64 ticks;
+    char phase;         // 'B'egin or 'E'nd
+};
+
+/// single-producer single-consumer ring, one per traced thread, preallocated
+class ThreadRing
+{
+public:
+    /// producer side (traced thread), never blocks or allocates, drops the event when full
+    void push(const char* name, char phase)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        if (w - readIndex.load(std::memory_order_acquire) >= RINGSIZE)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[w & (RINGSIZE-1)] = { name, juce::Time::getHighResolutionTicks(), phase };
+        writeIndex.store(w+1, std::memory_order_release);
+    }
+
+    /// consumer side (writer thread), hand every pending event to the callback
+    template <typename Callback>
+    void drain(Callback&& callback)
+    {
+        const uint32_t w = writeIndex.load(std::memory_order_acquire);
+        uint32_t r = readIndex.load(std::memory_order_relaxed);
+        for (;r!=w;r++)
+            callback(events[r & (RINGSIZE-1)]);
+        readIndex.store(r, std::memory_order_release);
+    }
+
+    /// free -> inUse by the claiming thread, inUse -> exited by its thread-exit guard,
+    /// exited -> free by the writer once it has drained what the thread left behind
+    enum State { free = 0, inUse, exited };
+    std::atomic<int> state { free };
+    std::atomic<uint32_t> dropped { 0 };
+    std::atomic<bool> isMessageThread { false };
+
+private:
+    std::array<Event, RINGSIZE> events;
+    std::atomic<uint32_t> writeIndex { 0 };
+    std::atomic<uint32_t> readIndex { 0 };
+};
+
+/// process-wide ring storage, shared by all plugin instances
+inline std::array<ThreadRing, MAXTHREADS>& rings()
+{
+    static std::array<ThreadRing, MAXTHREADS> r;
+    return r;
+}
+
+/// tracing is only recorded while a Session exists
+inline std::atomic<bool>& active()
+{
+    static std::atomic<bool> a { false };
+    return a;
+}
+
+/// bumped whenever the writer frees a ring, so threads that found none only look again when it is worth it
+inline std::atomic<uint32_t>& releaseCount()
+{
+    static std::atomic<uint32_t> c { 0 };
+    return c;
+}
+
+/// a thread's hold on its ring, handed back when the thread exits (host worker threads come and go)
+class RingClaim
+{
+public:
+    ~RingClaim()
+    {
+        if (ring != nullptr)
+            ring->state.store(ThreadRing::exited, std::memory_order_release);
+    }
+
+    ThreadRing* get()
+    {
+        if (ring != nullptr)
+            return ring;
+        const uint32_t released = releaseCount().load(std::memory_order_acquire);
+        if (tried && released == lastRelease)
+            return nullptr;
+        tried = true;
+        lastRelease = released;
+        for (auto& r : rings())
+        {
+            int expected = ThreadRing::free;
+            if (r.state.compare_exchange_strong(expected, ThreadRing::inUse, std::memory_order_acq_rel))
+            {
+                r.isMessageThread.store(juce::MessageManager::existsAndIsCurrentThread(), std::memory_order_release);
+                ring = &r;
+                return ring;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    ThreadRing* ring = nullptr;
+    bool tried = false;
+    uint32_t lastRelease = 0;
+};
+
+/// the calling thread's ring, claimed on its first event, nullptr while all rings are taken
+inline ThreadRing* ringForThisThread()
+{
+    thread_local RingClaim claim;
+    return claim.get();
+}
+
+inline void record(const char* name, char phase)
+{
+    if (!active().load(std::memory_order_relaxed)) return;
+    if (auto* ring = ringForThisThread())
+        ring->push(name, phase);
+}
+
+/// RAII begin/end pair, use through FA_TRACE_SCOPE
+class ScopedEvent
+{
+public:
+    explicit ScopedEvent(const char* eventName): name(eventName) { record(name, 'B'); }
+    ~ScopedEvent() { record(name, 'E'); }
+private:
+    const char* name;
+};
+
+/// background writer, owns the output file while any plugin instance holds it
+class Session : private juce::Thread
+{
+public:
+    Session(): juce::Thread("FreqAnalyzer trace writer")
+    {
+        traceFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getChildFile("FreqAnalyzerTrace_" + juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S") + ".json");
+        stream.reset(new juce::FileOutputStream(traceFile));
+        if (stream->failedToOpen())
+        {
+            DBG("trace file could not be opened: " + traceFile.getFullPathName());
+            stream.reset();
+            return;
+        }
+        stream->truncate();
+        *stream << "[\n";
+        DBG("tracing to " + traceFile.getFullPathName());
+
+        active().store(true);
+        startThread();
+    }
+
+    ~Session() override
+    {
+        active().store(false);
+        stopThread(1000);
+        if (stream != nullptr)
+        {
+            drainAll();
+            *stream << "\n]\n";
+            stream->flush();
+        }
+    }
+
+private:
+    juce::File traceFile;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    bool firstEvent = true;
+    uint32_t droppedReported[MAXTHREADS] = {};
+    bool named[MAXTHREADS] = {};
+    // a ring reused by another thread shows up as a new trace thread
+    int generation[MAXTHREADS] = {};
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(DRAININTERVAL_MS);
+            drainAll();
+        }
+    }
+
+    void drainAll()
+    {
+        const double usPerTick = 1.0e6/(double)juce::Time::getHighResolutionTicksPerSecond();
+
+        for (int slot=0;slot<MAXTHREADS;slot++)
+        {
+            auto& ring = rings()[slot];
+            const int state = ring.state.load(std::memory_order_acquire);
+            if (state == ThreadRing::free) continue;
+            const int tid = slot+generation[slot]*MAXTHREADS;
+
+            // name the thread the first time its ring shows up
+            if (!named[slot])
+            {
+                writeEntry("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + juce::String(tid)
+                           + ",\"args\":{\"name\":\"" + (ring.isMessageThread.load(std::memory_order_acquire) ? juce::String("message") : "thread " + juce::String(tid)) + "\"}}");
+                named[slot] = true;
+            }
+
+            ring.drain([&] (const Event& e)
+            {
+                writeEntry("{\"name\":\"" + juce::String(e.name) + "\",\"ph\":\"" + juce::String::charToString(e.phase)
+                           + "\",\"ts\":" + juce::String((double)e.ticks*usPerTick, 3)
+                           + ",\"pid\":1,\"tid\":" + juce::String(tid) + "}");
+            });
+
+            // report overflow as an instant event so gaps in the trace are explained
+            const uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+            if (dropped != droppedReported[slot])
+            {
+                writeEntry("{\"name\":\"dropped " + juce::String(dropped-droppedReported[slot]) + " events\",\"ph\":\"i\",\"s\":\"t\",\"ts\":"
+                           + juce::String((double)juce::Time::getHighResolutionTicks()*usPerTick, 3)
+                           + ",\"pid\":1,\"tid\":" + juce::String(tid) + "}");
+                droppedReported[slot] = dropped;
+            }
+
+            // its thread has gone and everything it pushed is written, the ring can go to another thread
+            if (state == ThreadRing::exited)
+            {
+                named[slot] = false;
+                generation[slot]++;
+                ring.state.store(ThreadRing::free, std::memory_order_release);
+                releaseCount().fetch_add(1, std::memory_order_release);
+            }
+        }
+        stream->flush();
+    }
+
+    void writeEntry(const juce::String& json)
+    {
+        if (!firstEvent) *stream << ",\n";
+        firstEvent = false;
+        *stream << json;
+    }
+};
+
+}   // namespace TraceLog
+
+ #define FA_TRACE_SCOPE(eventName) TraceLog::ScopedEvent JUCE_JOIN_MACRO(faTraceScope_, __LINE__) (eventName)
+#else
+ #define FA_TRACE_SCOPE(eventName)
+#endif
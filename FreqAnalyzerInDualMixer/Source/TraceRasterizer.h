@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    TraceRasterizer.h
+    Created: 20 Oct 2026 5:06:38pm
+    Author:  Louis Deng
+
+    software rasterizer for the spectrum traces, writes straight into an
+    Image::BitmapData instead of going through the Graphics edge tables
+
+    every trace is reduced to one vertical span per pixel column (the range of
+    y its polyline covers inside that column), with fractional coverage at the
+    span ends for anti-aliasing and an optional fill from the span down to the
+    bottom. all traces are then composited together in a single pass over the
+    image rows
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class TraceRasterizer
+{
+public:
+    TraceRasterizer()
+    {
+    }
+    
+    ~TraceRasterizer()
+    {
+    }
+    
+    /// one polyline reduced to per-column spans, in image pixels
+    struct Trace
+    {
+        std::vector<float> top;
+        std::vector<float> bottom;
+        juce::PixelARGB colour;     // premultiplied (as Colour::getPixelARGB returns it), alpha included
+        juce::PixelARGB fillColour; // fill under the span, fully transparent for none
+        bool hasFill = false;
+        bool empty = true;
+        
+        /// clear the spans for an image of the given width
+        void begin(int width, juce::Colour traceColour, juce::Colour underFill = juce::Colours::transparentBlack)
+        {
+            top.assign(width, std::numeric_limits<float>::max());
+            bottom.assign(width, std::numeric_limits<float>::lowest());
+            colour = traceColour.getPixelARGB();
+            fillColour = underFill.getPixelARGB();
+            hasFill = underFill.getAlpha() != 0;
+            empty = true;
+        }
+        
+        /// widen the spans of every column the segment passes through
+        void addSegment(float x0, float y0, float x1, float y1)
+        {
+            if (x1 < x0)
+            {
+                std::swap(x0, x1);
+                std::swap(y0, y1);
+            }
+            const int width = (int)top.size();
+            const int first = juce::jmax(0, (int)std::floor(x0));
+            const int last = juce::jmin(width-1, (int)std::floor(x1));
+            const float slope = x1 > x0 ? (y1-y0)/(x1-x0) : 0.0f;
+            for (int c=first;c<=last;c++)
+            {
+                // part of the segment inside this column
+                const float ya = y0+slope*(juce::jmax(x0, (float)c)-x0);
+                const float yb = y0+slope*(juce::jmin(x1, (float)(c+1))-x0);
+                top[c] = juce::jmin(top[c], ya, yb);
+                bottom[c] = juce::jmax(bottom[c], ya, yb);
+            }
+            empty = false;
+        }
+    };
+    
+    /// message thread: composite traces over a cleared ARGB image, later traces on top
+    void render(juce::Image& image, const Trace* const* traces, int numTraces)
+    {
+        const int width = image.getWidth();
+        const int height = image.getHeight();
+        image.clear(image.getBounds());
+        
+        // spans are at least one pixel tall, centred on the line, so flat runs still show
+        spans.resize((size_t)numTraces*width);
+        float firstRow = (float)height;
+        for (int t=0;t<numTraces;t++)
+        {
+            const Trace& trace = *traces[t];
+            for (int x=0;x<width;x++)
+            {
+                Span span { trace.top[x], trace.bottom[x] };
+                if (span.top > span.bottom || trace.empty)
+                    span = { (float)height, (float)height };
+                else if (span.bottom-span.top < 1.0f)
+                {
+                    const float centre = 0.5f*(span.top+span.bottom);
+                    span = { centre-0.5f, centre+0.5f };
+                }
+                spans[(size_t)t*width+x] = span;
+                firstRow = juce::jmin(firstRow, span.top);
+            }
+        }
+        
+        juce::Image::BitmapData pixels(image, juce::Image::BitmapData::readWrite);
+        for (int y=juce::jmax(0, (int)firstRow);y<height;y++)
+        {
+            auto* line = reinterpret_cast<juce::PixelARGB*>(pixels.getLinePointer(y));
+            const float rowTop = (float)y;
+            const float rowBottom = rowTop+1.0f;
+            for (int t=0;t<numTraces;t++)
+            {
+                const Trace& trace = *traces[t];
+                const Span* traceSpans = spans.data()+(size_t)t*width;
+                for (int x=0;x<width;x++)
+                {
+                    const Span span = traceSpans[x];
+                    if (rowBottom <= span.top)
+                        continue;
+                    if (rowTop >= span.bottom)
+                    {
+                        // below the line: fill-under span
+                        if (trace.hasFill && span.bottom < (float)height)
+                            line[x].blend(trace.fillColour);
+                        continue;
+                    }
+                    // row crosses the span, coverage is the overlap
+                    const float coverage = juce::jmin(rowBottom, span.bottom)-juce::jmax(rowTop, span.top);
+                    juce::PixelARGB src = trace.colour;
+                    src.multiplyAlpha(coverage);
+                    line[x].blend(src);
+                }
+            }
+        }
+    }
+
+private:
+    struct Span { float top, bottom; };
+    /// kept between frames so rendering does not allocate once warmed up
+    std::vector<Span> spans;
+    
+    JUCE_DECLARE_NON_COPYABLE(TraceRasterizer)
+};
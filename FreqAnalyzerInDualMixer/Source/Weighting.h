@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    Weighting.h
+    Created: 23 Oct 2026 6:12:20pm
+    Author:  Louis Deng
+
+    frequency weighting and tilt of the displayed spectrum: A and C (IEC 61672),
+    ITU-R BS.468, and a dB/octave slope pivoting at 1 kHz on top of any of them
+
+    the curve is evaluated once per bin into a table of dB offsets, rebuilt only
+    when the fft size, the sample rate, the axis or the curve changes. the table
+    goes into the magnitude to dB conversion (SpectrumUtil::amp2db), so weighting
+    costs the display one add per bin
+
+  ==============================================================================
+*/
+
+#pragma once
+
+class WeightingTable
+{
+public:
+    enum Curve
+    {
+        flat = 0,
+        aWeighting,
+        cWeighting,
+        itu468
+    };
+
+    WeightingTable()
+    {
+    }
+
+    ~WeightingTable()
+    {
+    }
+
+    /// gain of the curve plus the tilt in signal dB at f Hz
+    static double getGainDB(Curve curve, float tiltDbPerOctave, double f)
+    {
+        // the DC bin gets the 1 Hz value instead of -inf
+        f = juce::jmax(f, MINHZ);
+        double gain = tiltDbPerOctave*std::log2(f/1000.0);
+        const double f2 = f*f;
+        switch (curve)
+        {
+            case aWeighting:
+            {
+                const double r = 12194.0*12194.0*f2*f2
+                    / ((f2+20.6*20.6)*std::sqrt((f2+107.7*107.7)*(f2+737.9*737.9))*(f2+12194.0*12194.0));
+                gain += 20.0*std::log10(r)+2.0;
+                break;
+            }
+            case cWeighting:
+            {
+                const double r = 12194.0*12194.0*f2/((f2+20.6*20.6)*(f2+12194.0*12194.0));
+                gain += 20.0*std::log10(r)+0.06;
+                break;
+            }
+            case itu468:
+            {
+                const double h1 = -4.737338981378384e-24*f2*f2*f2 + 2.043828333606125e-15*f2*f2 - 1.363894795463638e-7*f2 + 1.0;
+                const double h2 = 1.306612257412824e-19*f2*f2*f - 2.118150887518656e-11*f2*f + 5.559488023498642e-4*f;
+                const double r = 1.246332637532143e-4*f/std::sqrt(h1*h1+h2*h2);
+                gain += 20.0*std::log10(r)+18.2;
+                break;
+            }
+            case flat:
+            default:
+                break;
+        }
+        return gain;
+    }
+
+    /// offset to add to a level on the display dB scale at f Hz
+    /// amp2db takes 20 log10 of the squared magnitude, so a signal gain shows twice over
+    static float getOffset(Curve curve, float tiltDbPerOctave, double f)
+    {
+        return (float)(DISPLAYSCALE*getGainDB(curve, tiltDbPerOctave, f));
+    }
+
+    /// bins at firstBinHz + bin*binSpacingHz, returns true if the table was rebuilt (the offsets pointer may have moved)
+    bool update(Curve newCurve, float newTiltDbPerOctave, double newFirstBinHz, double newBinSpacingHz, int newNumBins)
+    {
+        if (newCurve == curve && newTiltDbPerOctave == tiltDbPerOctave && newFirstBinHz == firstBinHz
+            && newBinSpacingHz == binSpacingHz && newNumBins == (int)offsets.size())
+            return false;
+
+        curve = newCurve;
+        tiltDbPerOctave = newTiltDbPerOctave;
+        firstBinHz = newFirstBinHz;
+        binSpacingHz = newBinSpacingHz;
+        offsets.resize((size_t)newNumBins);
+        for (int bin=0;bin<newNumBins;bin++)
+            offsets[bin] = getOffset(curve, tiltDbPerOctave, firstBinHz+bin*binSpacingHz);
+        return true;
+    }
+
+    /// one dB offset per bin, nullptr when flat so the conversion can skip the adds
+    const float* getOffsets() const { return isFlat() || offsets.empty() ? nullptr : offsets.data(); }
+    int getNumBins() const { return (int)offsets.size(); }
+    bool isFlat() const { return curve == flat && tiltDbPerOctave == 0.0f; }
+
+    Curve getCurve() const { return curve; }
+    float getTilt() const { return tiltDbPerOctave; }
+
+    /// bytes of the table, for memory reports
+    size_t getMemoryBytes() const { return offsets.capacity()*sizeof(float); }
+
+private:
+    static constexpr double MINHZ = 1.0;
+    static constexpr double DISPLAYSCALE = 2.0;
+
+    Curve curve = flat;
+    float tiltDbPerOctave = 0.0f;
+    double firstBinHz = 0.0;
+    double binSpacingHz = 0.0;
+    std::vector<float> offsets;
+};
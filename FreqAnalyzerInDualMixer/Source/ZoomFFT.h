@@ -0,0 +1,362 @@
+/*
+  ==============================================================================
+
+    ZoomFFT.h
+    Created: 21 Oct 2026 2:31:09pm
+    Author:  Louis Deng
+
+    zoom analysis of a narrow band (e.g. 40-80 Hz) at sub-Hz resolution
+
+    each stream is shifted down so the band centre sits at 0 Hz (complex
+    heterodyne), low-passed and decimated to a rate just above twice the band
+    width, then analyzed with a small complex FFT. the result is resampled to
+    the display's bin count over the band, on a linear axis
+
+    all of it runs on a background thread, the audio thread only pushes
+    samples into a lock-free fifo per stream. the fifo rings and the drain's
+    scratch are one AnalyzerArena block per zoom session; the filter, baseband
+    and fft buffers of a stream are a block of their own, sized by the band
+    when the session starts and touched by the zoom thread only
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "SpectrumUtil.h"
+#include "AnalyzerArena.h"
+
+/// one signal stream, used on the zoom thread only
+class ZoomStream
+{
+public:
+    /// complex fft size, 512 points and 87.5% overlap
+    static constexpr int ZOOMORDER = 9;
+    static constexpr int ZOOMSIZE = 1 << ZOOMORDER;
+    static constexpr int ZOOMHOP = ZOOMSIZE >> 3;
+
+    ZoomStream(): fft(ZOOMORDER)
+    {
+    }
+
+    ~ZoomStream()
+    {
+    }
+
+    /// numBins display bins spread linearly over fLow..fHigh, levels sized levelsSize (>= numBins, rest zero)
+    void configure(double sampleRate, float fLow, float fHigh, int numBins, int levelsSize)
+    {
+        sr = sampleRate;
+        low = fLow;
+        span = fHigh-fLow;
+        centre = 0.5*(fLow+fHigh);
+
+        // complex baseband only needs more than the band width, keep 2x for the low-pass transition
+        decimation = juce::jmax(1, (int)(sr/(2.0*span)));
+        decimatedRate = sr/decimation;
+
+        // zeroed by the allocation: an empty input history and baseband
+        const int numTaps = juce::jmin(MAXTAPS, 12*decimation+1);
+        auto arena = std::make_unique<AnalyzerArena>();
+        const size_t tapsAt = arena->reserve<float>("zoom taps", (size_t)numTaps);
+        const size_t historyAt = arena->reserve<std::complex<float>>("zoom history", (size_t)numTaps*2);
+        const size_t basebandAt = arena->reserve<std::complex<float>>("zoom baseband", ZOOMSIZE);
+        const size_t windowAt = arena->reserve<float>("zoom window", ZOOMSIZE);
+        const size_t frameAt = arena->reserve<std::complex<float>>("zoom frame", ZOOMSIZE);
+        const size_t spectrumAt = arena->reserve<std::complex<float>>("zoom spectrum", ZOOMSIZE);
+        const size_t levelsAt = arena->reserve<float>("zoom levels", (size_t)levelsSize);
+        arena->allocate();
+        taps = arena->place<float>(tapsAt, (size_t)numTaps);
+        history = arena->place<std::complex<float>>(historyAt, (size_t)numTaps*2);
+        baseband = arena->place<std::complex<float>>(basebandAt, ZOOMSIZE);
+        window = arena->place<float>(windowAt, ZOOMSIZE);
+        frame = arena->place<std::complex<float>>(frameAt, ZOOMSIZE);
+        spectrum = arena->place<std::complex<float>>(spectrumAt, ZOOMSIZE);
+        levels = arena->place<float>(levelsAt, (size_t)levelsSize);
+        buffers = std::move(arena);
+
+        // windowed-sinc low-pass cutting at half the decimated rate, Blackman window, unity DC gain
+        const double cutoff = 0.5*decimatedRate/sr;
+        double sum = 0.0;
+        for (int i=0;i<numTaps;i++)
+        {
+            const double m = i-0.5*(numTaps-1);
+            const double sinc = m == 0.0 ? 2.0*cutoff : std::sin(juce::MathConstants<double>::twoPi*cutoff*m)/(juce::MathConstants<double>::pi*m);
+            const double phase = juce::MathConstants<double>::twoPi*i/(numTaps-1);
+            const double blackman = 0.42-0.5*std::cos(phase)+0.08*std::cos(2.0*phase);
+            taps[i] = (float)(sinc*blackman);
+            sum += taps[i];
+        }
+        for (auto& t : taps)
+            t = (float)(t/sum);
+
+        // input history written twice so every dot product reads one contiguous run
+        historyPos = 0;
+        decimationCounter = 0;
+
+        rotator = 1.0;
+        rotatorStep = std::polar(1.0, -juce::MathConstants<double>::twoPi*centre/sr);
+        rotatorCounter = 0;
+
+        basebandPos = 0;
+        hopCounter = 0;
+        filled = 0;
+        numFrames = 0;
+
+        for (int i=0;i<ZOOMSIZE;i++)
+            window[i] = (float)(1.0-std::cos(juce::MathConstants<double>::twoPi*i/ZOOMSIZE));
+        displayBins = numBins;
+    }
+
+    /// feed samples, returns true when at least one new frame was made
+    bool process(const float* input, int numSamples)
+    {
+        bool newFrame = false;
+        const int numTaps = (int)taps.size();
+        for (int i=0;i<numSamples;i++)
+        {
+            // heterodyne, the rotator is renormalized now and then against rounding drift
+            const std::complex<float> shifted = (float)input[i]*std::complex<float>(rotator);
+            rotator *= rotatorStep;
+            if (++rotatorCounter == 4096)
+            {
+                rotator /= std::abs(rotator);
+                rotatorCounter = 0;
+            }
+
+            history[historyPos] = shifted;
+            history[historyPos+numTaps] = shifted;
+            historyPos = historyPos+1 == numTaps ? 0 : historyPos+1;
+
+            // filter output only every decimation-th sample
+            if (++decimationCounter < decimation)
+                continue;
+            decimationCounter = 0;
+
+            const std::complex<float>* h = history.data()+historyPos;  // oldest first
+            float re = 0.0f, im = 0.0f;
+            for (int k=0;k<numTaps;k++)
+            {
+                re += taps[k]*h[k].real();
+                im += taps[k]*h[k].imag();
+            }
+
+            baseband[basebandPos] = { re, im };
+            basebandPos = (basebandPos+1) & (ZOOMSIZE-1);
+            filled = juce::jmin(filled+1, ZOOMSIZE);
+            if (++hopCounter >= ZOOMHOP && filled == ZOOMSIZE)
+            {
+                hopCounter = 0;
+                makeFrame();
+                newFrame = true;
+            }
+        }
+        return newFrame;
+    }
+
+    /// magnitudes of the latest frame per display bin, on the same scale as the live fft units
+    const ArenaArray<float>& getLevels() const { return levels; }
+
+    /// seconds of signal in one frame
+    double getFrameSeconds() const { return ZOOMSIZE/decimatedRate; }
+
+    /// frames made since configure(), the same for every stream fed the same number of samples
+    uint32_t getNumFrames() const { return numFrames; }
+
+    /// bytes of the filter, baseband and fft buffers, 0 before the first configure
+    size_t getMemoryBytes() const { return buffers == nullptr ? 0 : buffers->getTotalBytes(); }
+
+private:
+    static constexpr int MAXTAPS = 1 << 16;
+
+    juce::dsp::FFT fft;
+    double sr = 48000.0;
+    double low = 0.0;
+    double span = 1.0;
+    double centre = 0.0;
+    int decimation = 1;
+    double decimatedRate = 48000.0;
+
+    std::unique_ptr<AnalyzerArena> buffers;
+    ArenaArray<float> taps;
+    ArenaArray<std::complex<float>> history;
+    int historyPos = 0;
+    int decimationCounter = 0;
+
+    std::complex<double> rotator = 1.0;
+    std::complex<double> rotatorStep = 1.0;
+    int rotatorCounter = 0;
+
+    ArenaArray<std::complex<float>> baseband;
+    int basebandPos = 0;
+    int hopCounter = 0;
+    int filled = 0;
+    uint32_t numFrames = 0;
+
+    ArenaArray<float> window;
+    ArenaArray<std::complex<float>> frame;
+    ArenaArray<std::complex<float>> spectrum;
+    ArenaArray<float> levels;
+    int displayBins = 0;
+
+    void makeFrame()
+    {
+        for (int i=0;i<ZOOMSIZE;i++)
+            frame[i] = baseband[(basebandPos+i) & (ZOOMSIZE-1)]*window[i];
+        fft.perform(frame.data(), spectrum.data(), false);
+
+        // a real sine of amplitude A shows as A/2 after the shift, the live units read A*N/4 for
+        // their N point frame, so halve to keep both on the display scale at equal fft sizes
+        const float scale = 0.5f*(float)(2*displayBins)/(float)ZOOMSIZE;
+        for (int j=0;j<displayBins;j++)
+        {
+            // display bin j -> frequency -> fractional fft bin around the centre
+            const double f = low+span*(j+0.5)/displayBins;
+            const double k = (f-centre)/decimatedRate*ZOOMSIZE;
+            const int k0 = (int)std::floor(k);
+            const float frac = (float)(k-k0);
+            const float m0 = std::abs(spectrum[k0 & (ZOOMSIZE-1)]);
+            const float m1 = std::abs(spectrum[(k0+1) & (ZOOMSIZE-1)]);
+            levels[j] = (m0+(m1-m0)*frac)*scale;
+        }
+        numFrames++;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(ZoomStream)
+};
+
+/// background thread running the zoom streams of dry/wet x L/R
+class ZoomEngine : private juce::Thread
+{
+public:
+    /// called on the zoom thread with the dry and wet levels of a channel and the number of their frame
+    /// since the engine started, which the left and right channel share for the same stretch of signal
+    using FrameCallback = std::function<void(uint32_t leftright, uint32_t frameNumber, const float* dry, const float* wet)>;
+
+    ZoomEngine(double sampleRate, float fLow, float fHigh, int numBins, int levelsSize, FrameCallback callback)
+        : juce::Thread("FreqAnalyzer zoom"), onFrame(std::move(callback))
+    {
+        static const char* const names[4] = { "zoom fifo left dry", "zoom fifo left wet", "zoom fifo right dry", "zoom fifo right wet" };
+        size_t samplesAt[4];
+        for (int s=0;s<4;s++)
+            samplesAt[s] = arena.reserve<float>(names[s], FIFOSIZE);
+        const size_t scratchAt = arena.reserve<float>("zoom scratch", CHUNKSIZE);
+        arena.allocate();
+        for (int s=0;s<4;s++)
+        {
+            auto& stream = streams[s];
+            stream.fifo.reset(new juce::AbstractFifo(FIFOSIZE));
+            stream.samples = arena.place<float>(samplesAt[s], FIFOSIZE);
+            stream.zoom.configure(sampleRate, fLow, fHigh, numBins, levelsSize);
+        }
+        scratch = arena.place<float>(scratchAt, CHUNKSIZE);
+        startThread();
+    }
+
+    ~ZoomEngine() override
+    {
+        stopThread(2000);
+    }
+
+    /// audio thread: queue samples of one stream, never blocks, drops them when the zoom thread falls behind
+    /// a channel's wet block follows its dry block of the same length, and the two are kept or dropped
+    /// together: drainChannel() pairs dry and wet samples by position, one dropped alone would shift them for good
+    void push(uint32_t leftright, uint32_t drywet, const float* input, int numSamples)
+    {
+        auto& stream = streams[leftright*2+drywet];
+        if (drywet == 0)
+        {
+            // only this thread writes, so room for the wet block now is room for it when it comes
+            const bool fits = stream.fifo->getFreeSpace() >= numSamples && streams[leftright*2+1].fifo->getFreeSpace() >= numSamples;
+            dropWet[leftright] = !fits;
+            if (!fits)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        else if (dropWet[leftright])
+        {
+            dropWet[leftright] = false;
+            return;
+        }
+        int start1, size1, start2, size2;
+        stream.fifo->prepareToWrite(numSamples, start1, size1, start2, size2);
+        jassert(size1+size2 == numSamples);
+        std::copy(input, input+size1, stream.samples.begin()+start1);
+        std::copy(input+size1, input+size1+size2, stream.samples.begin()+start2);
+        stream.fifo->finishedWrite(size1+size2);
+    }
+
+    juce::uint32 getDroppedBlocks() const { return dropped.load(); }
+
+    /// bytes of the fifo rings and of every stream's buffers
+    size_t getMemoryBytes() const
+    {
+        size_t bytes = arena.getTotalBytes();
+        for (const auto& stream : streams)
+            bytes += stream.zoom.getMemoryBytes();
+        return bytes;
+    }
+
+    /// message thread: hold the zoom thread between two drains until resume(), while what its frames reach changes
+    void pause() { drainLock.enter(); }
+    void resume() { drainLock.exit(); }
+
+private:
+    static constexpr int FIFOSIZE = 1 << 16;
+    static constexpr int CHUNKSIZE = 2048;
+    static constexpr int DRAININTERVAL_MS = 20;
+
+    struct Stream
+    {
+        std::unique_ptr<juce::AbstractFifo> fifo;
+        ArenaArray<float> samples;
+        ZoomStream zoom;
+    };
+    AnalyzerArena arena;
+    Stream streams[4];      // left dry, left wet, right dry, right wet
+    ArenaArray<float> scratch;
+    FrameCallback onFrame;
+    std::atomic<juce::uint32> dropped { 0 };
+    bool dropWet[2] = { false, false };     // audio thread: the dry block before was dropped
+    juce::CriticalSection drainLock;        // held by a drain, or by the message thread pausing it
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(DRAININTERVAL_MS);
+            const juce::ScopedLock sl(drainLock);
+            for (uint32_t leftright=0;leftright<2;leftright++)
+                drainChannel(leftright);
+        }
+    }
+
+    /// dry and wet advance together, so their frames complete on the same call
+    void drainChannel(uint32_t leftright)
+    {
+        auto& dry = streams[leftright*2];
+        auto& wet = streams[leftright*2+1];
+        int available = juce::jmin(dry.fifo->getNumReady(), wet.fifo->getNumReady());
+        bool newFrame = false;
+        while (available > 0)
+        {
+            const int numChunk = juce::jmin(available, CHUNKSIZE);
+            for (auto* stream : { &dry, &wet })
+            {
+                int start1, size1, start2, size2;
+                stream->fifo->prepareToRead(numChunk, start1, size1, start2, size2);
+                std::copy(stream->samples.begin()+start1, stream->samples.begin()+start1+size1, scratch.begin());
+                std::copy(stream->samples.begin()+start2, stream->samples.begin()+start2+size2, scratch.begin()+size1);
+                stream->fifo->finishedRead(size1+size2);
+                if (stream->zoom.process(scratch.data(), numChunk))
+                    newFrame = true;
+            }
+            available -= numChunk;
+        }
+        if (newFrame)
+            onFrame(leftright, dry.zoom.getNumFrames()-1, dry.zoom.getLevels().data(), wet.zoom.getLevels().data());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE(ZoomEngine)
+};
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    AnalyzerDeterminismTests.cpp
+    Created: 25 Oct 2026 6:20:44pm
+    Author:  Louis Deng
+
+    the processor's published frames and mixed output do not depend on the
+    host block size, the analyzer's frames not on when the engine started,
+    and known tones are at their level
+
+    the mix change is read in a different block at each size but within the
+    same 32 sample cell of the stream, so every render ramps from the same
+    sample
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "AnalyzerTestUtil.h"
+
+class AnalyzerDeterminismTests : public juce::UnitTest
+{
+public:
+    AnalyzerDeterminismTests(): juce::UnitTest("Analyzer determinism and accuracy", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        using namespace AnalyzerTestUtil;
+        const auto left = makeTones(NUMSAMPLES, SAMPLERATE, { { 997.0, 0.5 }, { 6301.0, 0.05 } });
+        const auto right = makeTones(NUMSAMPLES, SAMPLERATE, { { 221.0, 0.25 } });
+
+        beginTest("processor frames and output are bit-identical at any block size");
+        {
+            const auto reference = render(left, right, 4096);
+            expectGreaterThan((int)reference.frames.size(), 50);
+            for (int blockSize : { 1, 32, 441 })
+            {
+                const auto other = render(left, right, blockSize);
+                expect(sameFrames(reference.frames, other.frames, false), "frames differ at block size " + juce::String(blockSize));
+                for (int channel = 0; channel < 2; channel++)
+                    expect(reference.output[channel] == other.output[channel], "output differs at block size " + juce::String(blockSize));
+            }
+            // the ramp did change the output, so the comparison covers it
+            expect(reference.output[0] != left);
+        }
+        
+        beginTest("analyzer frames are bit-identical at any block size");
+        {
+            const auto reference = collect(left, right, 4096, 0);
+            for (int blockSize : { 1, 512, 1000 })
+                expect(sameFrames(reference, collect(left, right, blockSize, 0), false),
+                       "frames differ at block size " + juce::String(blockSize));
+        }
+
+        beginTest("frames are bit-identical whenever the engine starts");
+        {
+            const auto reference = collect(left, right, 512, 0);
+            // a late start publishes the same hops, and from the first whole one on the same frames
+            const auto late = collect(left, right, 512, 12345);
+            expectGreaterThan((int)late.size(), 30);
+            expect(sameFrames(reference, late, true), "a late start moved the hops");
+        }
+
+        beginTest("known tones at their level");
+        {
+            // bin-centred for the default 2048 point fft, whole cycles in its 1024 sample window
+            const uint32_t fftSize = 1u << FFTORDER_T;
+            const double binHz = SAMPLERATE/fftSize;
+            const int toneBin = 96;
+            const auto tone = makeTones(NUMSAMPLES, SAMPLERATE, { { toneBin*binHz, 0.5 } });
+            const auto silence = std::vector<float>((size_t)NUMSAMPLES, 0.0f);
+            const auto frames = collect(tone, silence, 512, 0);
+            expect(!frames.empty());
+
+            const auto& last = frames[frames.size() - (frames.back().channel == 0 ? 1 : 2)];
+            expectEquals(last.fftSize, fftSize);
+            for (uint32_t drywet = 0; drywet < 2; drywet++)
+            {
+                const auto& magnitudes = last.magnitudes[drywet];
+                expectWithinAbsoluteError(magnitudeToDBFS(magnitudes[(size_t)toneBin], fftSize), 20.0*std::log10(0.5), 0.05);
+                // Hann sidelobes are gone a few bins out
+                expectLessThan(magnitudeToDBFS(magnitudes[(size_t)toneBin+8], fftSize), -60.0);
+            }
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int NUMSAMPLES = 48000;
+    /// the mix is changed before the first block starting here, 441*65, in the grid cell ending at 4096*7
+    static constexpr int MIXCHANGE = 28665;
+    
+    struct Render
+    {
+        std::vector<AnalyzerTestUtil::CollectedFrame> frames;
+        std::vector<float> output[2];
+    };
+    
+    /// an offline render through the processor in blocks of blockSize, analyzing as with history kept,
+    /// the dry input as the wet too, fully wet until the mix drops to a quarter at MIXCHANGE
+    Render render(const std::vector<float>& left, const std::vector<float>& right, int blockSize)
+    {
+        FreqAnalyzerInDualMixerAudioProcessor processor;
+        processor.setNonRealtime(true);
+        processor.setKeepHistory(true);
+        processor.prepareToPlay(SAMPLERATE, blockSize);
+        auto& engine = processor.getAnalysisEngine();
+        AnalyzerTestUtil::FrameCollector collector;
+        processor.detachAnalyzer();
+        engine.addConsumer(&collector);
+        processor.attachAnalyzer();
+        
+        auto* mix = processor.getParameters()[0];
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        Render result;
+        for (int block = 0; block < NUMSAMPLES; block += blockSize)
+        {
+            const int numSamples = juce::jmin(blockSize, NUMSAMPLES-block);
+            if (block >= MIXCHANGE && block-blockSize < MIXCHANGE)
+                mix->setValueNotifyingHost(0.25f);
+            buffer.setSize(2, numSamples, false, false, true);
+            buffer.copyFrom(0, 0, left.data()+block, numSamples);
+            buffer.copyFrom(1, 0, right.data()+block, numSamples);
+            processor.processBlock(buffer, midi);
+            for (int channel = 0; channel < 2; channel++)
+                result.output[channel].insert(result.output[channel].end(), buffer.getReadPointer(channel), buffer.getReadPointer(channel)+numSamples);
+        }
+        
+        processor.detachAnalyzer();
+        engine.removeConsumer(&collector);
+        processor.attachAnalyzer();
+        result.frames = std::move(collector.frames);
+        return result;
+    }
+
+    /// every frame of other is in reference with the same magnitudes, and (unless partial) the other way round
+    static bool sameFrames(const std::vector<AnalyzerTestUtil::CollectedFrame>& reference,
+                           const std::vector<AnalyzerTestUtil::CollectedFrame>& other, bool partial)
+    {
+        if (!partial && reference.size() != other.size())
+            return false;
+        for (const auto& frame : other)
+        {
+            auto match = std::find_if(reference.begin(), reference.end(), [&] (const AnalyzerTestUtil::CollectedFrame& f)
+                                      { return f.frameIndex == frame.frameIndex && f.channel == frame.channel; });
+            if (match == reference.end())
+                return false;
+            // the first hop of each channel after a late start still holds the zeros before it
+            if (partial && &frame - other.data() < 4)
+                continue;
+            for (int drywet = 0; drywet < 2; drywet++)
+                if (match->magnitudes[drywet] != frame.magnitudes[drywet])
+                    return false;
+        }
+        return !other.empty();
+    }
+};
+
+static AnalyzerDeterminismTests analyzerDeterminismTests;
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    AnalyzerHandoffTests.cpp
+    Created: 25 Oct 2026 9:31:05am
+    Author:  Louis Deng
+
+    editor open/close stress on the attach/detach handoff
+
+    an audio thread keeps analysing through a ReadScope, the way processBlock
+    does, while this (the message) thread opens and closes views on the engine
+    and switches its resolution, overlap, load and zoom, the way the editor
+    does.
+    run it under ThreadSanitizer as well as plain, the races it is after are
+    the ones that do not crash every time
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <thread>
+#include "AnalyzerHandoff.h"
+#include "FreqAnalyzer.h"
+
+class AnalyzerHandoffTests : public juce::UnitTest
+{
+public:
+    AnalyzerHandoffTests(): juce::UnitTest("Analyzer handoff", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("views opened and closed while the audio thread analyses");
+        {
+            SpectrumFramePool pool;
+            AnalysisEngine engine { pool };
+            AnalyzerHandoff handoff;
+            handoff.attach(&engine);
+
+            AudioThread audio(handoff);
+            auto random = getRandom();
+            std::unique_ptr<FreqAnalyzer> view;
+
+            for (int cycle = 0; cycle < NUMCYCLES; cycle++)
+            {
+                // editor constructor, now and then in zoom mode, where the zoom thread publishes on its own
+                handoff.detach();
+                engine.clearHistory();
+                if (random.nextInt(4) == 0)
+                    engine.setZoom(engine.isZoomed() ? 0.0f : 40.0f, engine.isZoomed() ? 0.0f : 80.0f, 48000.0);
+                view.reset(new FreqAnalyzer(engine));
+                handoff.attach(&engine);
+
+                // settings changed while it is open, new buffers built before detaching as applyQualityTier does
+                if (random.nextInt(3) == 0)
+                {
+                    const uint32_t order = FFTORDER_MIN + (uint32_t)random.nextInt((int)(FFTORDER_MAX-FFTORDER_MIN+1));
+                    const uint32_t overlapShift = (uint32_t)random.nextInt((int)OVERLAPSHIFT_MAX+1);
+                    auto storage = std::make_unique<AnalysisStorage>(order, overlapShift);
+                    handoff.detach();
+                    storage = view->setReducedLoad(1 + random.nextInt(2), random.nextBool(), std::move(storage));
+                    handoff.attach(&engine);
+                    storage.reset();
+                    expectEquals(view->getOrder(), order);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(random.nextInt(2000)));
+
+                // editor destructor
+                handoff.detach();
+                view.reset();
+                handoff.attach(&engine);
+                std::this_thread::sleep_for(std::chrono::microseconds(random.nextInt(500)));
+            }
+
+            audio.stop();
+            handoff.detach();
+            expect(audio.blocksAnalysed.load() > 0, "the audio thread never had the engine");
+            expect(audio.misaligned.load() == 0, "injected into an engine rebuilt but not aligned");
+
+            // nothing may still hold a frame once the views, and the history, are gone,
+            // and the sets of earlier resolutions are freed
+            engine.setZoom(0.0f, 0.0f, 48000.0);
+            engine.clearHistory();
+            expectEquals(countFreeFrames(pool), (int)pool.getNumFrames());
+            expectEquals(pool.getMaxBins(), 1u << (engine.getOrder()-1));
+            pool.releaseRetired();
+            const SpectrumFrameSet currentSize(pool.getNumFrames(), pool.getMaxBins());
+            expectEquals((juce::int64)pool.getMemoryBytes(), (juce::int64)currentSize.getMemoryBytes());
+        }
+
+        beginTest("detach waits for a scope the audio thread is in");
+        {
+            SpectrumFramePool pool;
+            AnalysisEngine engine { pool };
+            AnalyzerHandoff handoff;
+            handoff.attach(&engine);
+
+            std::atomic<bool> inScope { false }, leaving { false };
+            std::thread reader([&]
+            {
+                const AnalyzerHandoff::ReadScope scope(handoff);
+                inScope = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                leaving = true;
+            });
+            while (!inScope.load())
+                std::this_thread::yield();
+            handoff.detach();
+            expect(leaving.load(), "detach returned while the engine was still in use");
+            reader.join();
+        }
+    }
+
+private:
+    static constexpr int NUMCYCLES = 400;
+    static constexpr int BLOCKSIZE = 480;   // not a divisor of any hop, chunks split blocks
+
+    /// processBlock's analyzer path: scope, align, chunk on hops, inject, transform
+    struct AudioThread
+    {
+        AudioThread(AnalyzerHandoff& h): handoff(h), thread([this] { run(); })
+        {
+        }
+        ~AudioThread()
+        {
+            stop();
+        }
+
+        void stop()
+        {
+            running = false;
+            if (thread.joinable())
+                thread.join();
+        }
+
+        void run()
+        {
+            std::vector<float> left(BLOCKSIZE), right(BLOCKSIZE);
+            juce::int64 streamPosition = 0;
+            bool engineRunning = false;
+            double phase = 0.0;
+            while (running.load())
+            {
+                for (int i = 0; i < BLOCKSIZE; i++)
+                {
+                    left[(size_t)i] = (float)std::sin(phase);
+                    right[(size_t)i] = 0.5f*left[(size_t)i];
+                    phase += 0.0731;
+                }
+
+                const AnalyzerHandoff::ReadScope scope(handoff);
+                AnalysisEngine* analyzer = scope.get();
+                if (analyzer != nullptr && (analyzer->needsAlignment() || !engineRunning))
+                    analyzer->alignTo(streamPosition);
+                engineRunning = analyzer != nullptr;
+
+                for (int start = 0; analyzer != nullptr && start < BLOCKSIZE;)
+                {
+                    if (analyzer->needsAlignment())
+                        misaligned++;
+                    const int numChunk = juce::jmin(BLOCKSIZE-start, analyzer->samplesToNextHop());
+                    for (uint32_t drywet = 0; drywet < 2; drywet++)
+                    {
+                        analyzer->injectBlockToTo(left.data()+start, numChunk, 0, drywet);
+                        analyzer->injectBlockToTo(right.data()+start, numChunk, 1, drywet);
+                    }
+                    analyzer->injectStereo(left.data()+start, right.data()+start, numChunk);
+                    analyzer->transformPending();
+                    start += numChunk;
+                }
+                if (analyzer != nullptr)
+                    blocksAnalysed++;
+                streamPosition += BLOCKSIZE;
+            }
+        }
+
+        AnalyzerHandoff& handoff;
+        std::atomic<bool> running { true };
+        std::atomic<int> blocksAnalysed { 0 }, misaligned { 0 };
+        std::thread thread;
+    };
+
+    /// takes every frame the pool will give, and gives them back
+    static int countFreeFrames(SpectrumFramePool& pool)
+    {
+        std::vector<SpectrumFrameRef> frames;
+        for (;;)
+        {
+            auto frame = pool.acquire();
+            if (!frame)
+                return (int)frames.size();
+            frames.push_back(std::move(frame));
+        }
+    }
+};
+
+static AnalyzerHandoffTests analyzerHandoffTests;
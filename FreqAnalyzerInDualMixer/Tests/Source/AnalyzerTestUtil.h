@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    AnalyzerTestUtil.h
+    Created: 25 Oct 2026 6:02:19pm
+    Author:  Louis Deng
+
+    signals and frame collection shared by the analyzer tests
+
+  ==============================================================================
+*/
+
+#pragma once
+#include "FreqAnalyzer.h"
+
+namespace AnalyzerTestUtil
+{
+
+/// copy of a published frame, kept after the pooled one went back
+struct CollectedFrame
+{
+    uint32_t frameIndex = 0;
+    uint32_t channel = 0;
+    uint32_t fftSize = 0;
+    std::vector<float> magnitudes[2];   // dry, wet
+};
+
+/// every frame the engine publishes, in order
+class FrameCollector : public SpectrumFrameConsumer
+{
+public:
+    FrameCollector()
+    {
+    }
+
+    void offer(const SpectrumFrameRef& frame) override
+    {
+        CollectedFrame copy;
+        copy.frameIndex = frame->frameIndex;
+        copy.channel = frame->channel;
+        copy.fftSize = frame->fftSize;
+        for (uint32_t drywet = 0; drywet < 2; drywet++)
+            copy.magnitudes[drywet].assign(frame->getMagnitudes(drywet), frame->getMagnitudes(drywet)+frame->numBins);
+        frames.push_back(std::move(copy));
+    }
+
+    std::vector<CollectedFrame> frames;
+};
+
+/// sum of sines, amplitudes linear, frequencies Hz
+inline std::vector<float> makeTones(int numSamples, double sampleRate, std::initializer_list<std::pair<double, double>> tones)
+{
+    std::vector<float> signal((size_t)numSamples, 0.0f);
+    for (const auto& tone : tones)
+        for (int i = 0; i < numSamples; i++)
+            signal[(size_t)i] += (float)(tone.second*std::sin(juce::MathConstants<double>::twoPi*tone.first*i/sampleRate));
+    return signal;
+}
+
+/// processSamples' analyzer path without the mixer: blocks of blockSize from startPosition on,
+/// aligned on the first block, chunked on hops, the same signal as dry and wet
+inline void analyze(AnalysisEngine& engine, const std::vector<float>& left, const std::vector<float>& right,
+                    int blockSize, juce::int64 startPosition = 0)
+{
+    engine.alignTo(startPosition);
+    const int numSamples = (int)left.size();
+    for (int block = (int)startPosition; block < numSamples; block += blockSize)
+    {
+        const int blockEnd = juce::jmin(numSamples, block+blockSize);
+        for (int start = block; start < blockEnd;)
+        {
+            const int numChunk = juce::jmin(blockEnd-start, engine.samplesToNextHop());
+            for (uint32_t drywet = 0; drywet < 2; drywet++)
+            {
+                engine.injectBlockToTo(left.data()+start, numChunk, 0, drywet);
+                engine.injectBlockToTo(right.data()+start, numChunk, 1, drywet);
+            }
+            engine.transformPending();
+            start += numChunk;
+        }
+    }
+}
+
+/// every frame a fresh engine publishes for left and right, analyzed as analyze() does
+inline std::vector<CollectedFrame> collect(const std::vector<float>& left, const std::vector<float>& right,
+                                           int blockSize, juce::int64 startPosition = 0)
+{
+    SpectrumFramePool pool;
+    AnalysisEngine engine { pool };
+    FrameCollector collector;
+    engine.addConsumer(&collector);
+    analyze(engine, left, right, blockSize, startPosition);
+    engine.removeConsumer(&collector);
+    // the history's frames go back to the pool before it goes
+    engine.clearHistory();
+    return std::move(collector.frames);
+}
+
+/// level of an fft magnitude in dBFS: a full scale sine peaks at fftSize/4 (half length Hann window, x2)
+inline double magnitudeToDBFS(float magnitude, uint32_t fftSize)
+{
+    return 20.0*std::log10(juce::jmax(1.0e-12, (double)magnitude)) - 20.0*std::log10(fftSize/4.0);
+}
+
+}
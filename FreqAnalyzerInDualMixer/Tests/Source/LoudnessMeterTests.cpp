@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    LoudnessMeterTests.cpp
+    Created: 26 Oct 2026 4:31:45pm
+    Author:  Louis Deng
+
+    BS.1770 loudness of a stereo sine at the common sample rates, and the
+    true-peak of a sine whose samples miss its peaks. the mixer meters the
+    plugin's input and output
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DWmixer.h"
+#include "AnalyzerTestUtil.h"
+
+class LoudnessMeterTests : public juce::UnitTest
+{
+public:
+    LoudnessMeterTests(): juce::UnitTest("Loudness and true-peak", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("a -20 dBFS 997 Hz stereo sine reads -20 LUFS");
+        for (double sampleRate : { 44100.0, 48000.0, 192000.0 })
+        {
+            // K-weighting is +0.69 dB at 997 Hz and cancels the -0.691 of the loudness formula
+            const auto tone = AnalyzerTestUtil::makeTones((int)(SECONDS*sampleRate), sampleRate, { { 997.0, 0.1 } });
+            LoudnessMeter meter;
+            meter.prepare(sampleRate, 2, BLOCKSIZE);
+            process(meter, tone, tone);
+
+            const juce::String rate = " at " + juce::String((int)sampleRate) + " Hz";
+            expectWithinAbsoluteError(meter.getMomentary(), -20.0f, 0.05f, "momentary" + rate);
+            expectWithinAbsoluteError(meter.getShortTerm(), -20.0f, 0.05f, "short-term" + rate);
+            expectWithinAbsoluteError(meter.getIntegrated(), -20.0f, 0.1f, "integrated" + rate);
+            expectWithinAbsoluteError(meter.getTruePeak(), -20.0f, 0.1f, "true-peak" + rate);
+        }
+
+        beginTest("true-peak of a 45 degree fs/4 sine");
+        {
+            // samples at +-0.707, a sample peak 3 dB under the 0 dBTP of the sine between them
+            const double sampleRate = 48000.0;
+            std::vector<float> tone((size_t)(SECONDS*sampleRate));
+            for (size_t i = 0; i < tone.size(); i++)
+                tone[i] = (float)std::sin(juce::MathConstants<double>::halfPi*(double)i + juce::MathConstants<double>::pi/4.0);
+            LoudnessMeter meter;
+            meter.prepare(sampleRate, 2, BLOCKSIZE);
+            process(meter, tone, tone);
+            expectWithinAbsoluteError(meter.getTruePeak(), 0.0f, 0.1f);
+        }
+
+        beginTest("a block longer than the short-term window");
+        {
+            // one advance() for the whole signal, the sub-blocks are all kept until then
+            const double sampleRate = 48000.0;
+            const auto tone = AnalyzerTestUtil::makeTones((int)(SECONDS*sampleRate), sampleRate, { { 997.0, 0.1 } });
+            LoudnessMeter meter;
+            meter.prepare(sampleRate, 2, (int)tone.size());
+            meter.processChannel(0, tone.data(), (int)tone.size());
+            meter.processChannel(1, tone.data(), (int)tone.size());
+            meter.advance();
+            expectWithinAbsoluteError(meter.getShortTerm(), -20.0f, 0.05f);
+            expectWithinAbsoluteError(meter.getIntegrated(), -20.0f, 0.1f);
+        }
+
+        beginTest("the mixer meters its input and its output");
+        {
+            // dry and wet both the -20 dBFS tone, mixed half and half: the output is the same tone again
+            const double sampleRate = 48000.0;
+            const auto tone = AnalyzerTestUtil::makeTones((int)(SECONDS*sampleRate), sampleRate, { { 997.0, 0.1 } });
+            DWmixer<float> mixers[2];
+            LoudnessMeter meters[2];
+            for (uint32_t channel = 0; channel < 2; channel++)
+            {
+                mixers[channel].prepare(sampleRate, 0.5f);
+                mixers[channel].setid(channel);
+            }
+            for (auto& meter : meters)
+                meter.prepare(sampleRate, 2, BLOCKSIZE);
+            std::vector<float> wet((size_t)BLOCKSIZE);
+            for (int start = 0; start + BLOCKSIZE <= (int)tone.size(); start += BLOCKSIZE)
+            {
+                for (auto& mixer : mixers)
+                {
+                    std::copy(tone.begin()+start, tone.begin()+start+BLOCKSIZE, wet.begin());
+                    mixer.processBuffer(tone.data()+start, wet.data(), BLOCKSIZE, nullptr, meters);
+                }
+                for (auto& meter : meters)
+                    meter.advance();
+            }
+            expectWithinAbsoluteError(meters[0].getShortTerm(), -20.0f, 0.05f, "input");
+            expectWithinAbsoluteError(meters[1].getShortTerm(), -20.0f, 0.05f, "output");
+        }
+
+        beginTest("silence reads the minimum");
+        {
+            const std::vector<float> silence((size_t)(SECONDS*48000.0), 0.0f);
+            LoudnessMeter meter;
+            meter.prepare(48000.0, 2, BLOCKSIZE);
+            process(meter, silence, silence);
+            expectEquals(meter.getMomentary(), LoudnessMeter::MINLUFS);
+            expectEquals(meter.getIntegrated(), LoudnessMeter::MINLUFS);
+            expectEquals(meter.getTruePeak(), LoudnessMeter::MINLUFS);
+        }
+    }
+
+private:
+    static constexpr double SECONDS = 5.0;
+    static constexpr int BLOCKSIZE = 512;
+
+    /// the processor's order: every channel of a block, then advance()
+    static void process(LoudnessMeter& meter, const std::vector<float>& left, const std::vector<float>& right)
+    {
+        const int numSamples = (int)left.size();
+        for (int start = 0; start < numSamples; start += BLOCKSIZE)
+        {
+            const int numBlock = juce::jmin(BLOCKSIZE, numSamples-start);
+            meter.processChannel(0, left.data()+start, numBlock);
+            meter.processChannel(1, right.data()+start, numBlock);
+            meter.advance();
+        }
+    }
+};
+
+static LoudnessMeterTests loudnessMeterTests;
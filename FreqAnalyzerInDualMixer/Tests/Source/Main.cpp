@@ -0,0 +1,29 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 25 Oct 2026 9:12:40am
+    Author:  Louis Deng
+
+    runs the FreqAnalyzer unit tests, exit code 1 if any of them failed
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+int main (int argc, char* argv[])
+{
+    juce::ignoreUnused(argc, argv);
+    // views are Components, they need the message manager even without a window
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("FreqAnalyzer");
+    
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); i++)
+        failures += runner.getResult(i)->failures;
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    OctaveBankTests.cpp
+    Created: 28 Oct 2026 10:41:27am
+    Author:  Louis Deng
+
+    the RTA bands read a sine at their centre at its rms, and at their edges
+    3 dB down, within 0.1 dB down to the 20 Hz bands
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OctaveBank.h"
+#include "AnalyzerTestUtil.h"
+
+class OctaveBankTests : public juce::UnitTest
+{
+public:
+    OctaveBankTests(): juce::UnitTest("Octave bank bands", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        for (int bandsPerOctave : { 3, 6 })
+        {
+            beginTest("1/" + juce::String(bandsPerOctave) + " octave centres at 0 dB, edges at -3 dB");
+            OctaveBank bank(bandsPerOctave, SAMPLERATE);
+            expectGreaterThan(bank.getNumBands(), 9*bandsPerOctave);
+            expectGreaterOrEqual(bank.getCentreFrequency(0), 19.5f);
+            
+            // every third band from the lowest, whose poles are the hardest to place, each tone on its own
+            for (int band = 0; band < bank.getNumBands(); band += 3)
+            {
+                const juce::String name = juce::String(bank.getCentreFrequency(band)) + " Hz";
+                expectWithinAbsoluteError(levelAt(bank, band, bank.getCentreFrequency(band)), 0.0, 0.1, name + " centre");
+                expectWithinAbsoluteError(levelAt(bank, band, bank.getLowerEdge(band)), -3.0, 0.1, name + " lower edge");
+                expectWithinAbsoluteError(levelAt(bank, band, bank.getUpperEdge(band)), -3.0, 0.1, name + " upper edge");
+            }
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int NUMSAMPLES = 96000;
+    static constexpr int BLOCKSIZE = 512;
+    
+    /// level of a band (dB re the sine's rms) for a full scale sine at frequency, once settled
+    double levelAt(OctaveBank& bank, int band, double frequency)
+    {
+        // the mean square of low tones ripples from block to block, averaged over the second half
+        bank.reset();
+        const auto tone = AnalyzerTestUtil::makeTones(NUMSAMPLES, SAMPLERATE, { { frequency, 1.0 } });
+        double sum = 0.0;
+        int numBlocks = 0;
+        for (int start = 0; start < NUMSAMPLES; start += BLOCKSIZE)
+        {
+            bank.processBlock(tone.data()+start, juce::jmin(BLOCKSIZE, NUMSAMPLES-start));
+            if (start >= NUMSAMPLES/2)
+            {
+                const double rms = bank.getRMS(band);
+                sum += rms*rms;
+                numBlocks++;
+            }
+        }
+        return 10.0*std::log10(juce::jmax(1.0e-20, 2.0*sum/numBlocks));
+    }
+};
+
+static OctaveBankTests octaveBankTests;
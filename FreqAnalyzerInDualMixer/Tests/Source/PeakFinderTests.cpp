@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    PeakFinderTests.cpp
+    Created: 26 Oct 2026 4:58:13pm
+    Author:  Louis Deng
+
+    peaks of a real analyzer frame land on the tones between bins, strongest
+    first
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AnalyzerTestUtil.h"
+
+class PeakFinderTests : public juce::UnitTest
+{
+public:
+    PeakFinderTests(): juce::UnitTest("Peak finder", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        using namespace AnalyzerTestUtil;
+
+        beginTest("three tones between bins within 0.02 bins");
+        {
+            // framed like the display: the engine's half length Hann window zero padded to fftSize
+            const uint32_t fftSize = 1u << FFTORDER_T;
+            const double binHz = SAMPLERATE/fftSize;
+            const double bins[] = { 100.3, 250.75, 611.5 };
+            const auto tones = makeTones(NUMSAMPLES, SAMPLERATE, { { bins[0]*binHz, 0.5 }, { bins[1]*binHz, 0.2 }, { bins[2]*binHz, 0.05 } });
+            const auto frame = lastLeftFrame(tones);
+            expectEquals(frame.fftSize, fftSize);
+
+            // the display's dB, the interpolation works on any log scale
+            auto dB = frame.magnitudes[0];
+            SpectrumUtil::amp2db(dB);
+            PeakFinder finder;
+            finder.setNumPeaks(3);
+            finder.setThreshold(-100.0f);
+            expectEquals(finder.find(dB.data(), (int)dB.size()), 3);
+            for (int i = 0; i < 3; i++)
+                expectWithinAbsoluteError(finder.getPeak(i).bin, (float)bins[i], 0.02f, "peak " + juce::String(i));
+            expectGreaterThan(finder.getPeak(0).level, finder.getPeak(1).level);
+            expectGreaterThan(finder.getPeak(1).level, finder.getPeak(2).level);
+
+            // labelled in dBFS: the tone amplitudes back within a fraction of a dB
+            const double amplitudes[] = { 0.5, 0.2, 0.05 };
+            for (int i = 0; i < 3; i++)
+                expectWithinAbsoluteError(SpectrumUtil::display2dbfs(finder.getPeak(i).level, (int)fftSize),
+                                          (float)juce::Decibels::gainToDecibels(amplitudes[i]), 0.2f, "level " + juce::String(i));
+        }
+
+        beginTest("only the strongest are kept, none under the threshold");
+        {
+            PeakFinder finder;
+            finder.setNumPeaks(2);
+            finder.setThreshold(-50.0f);
+            std::vector<float> dB(64, -90.0f);
+            for (const auto& peak : { std::pair<int, float> { 10, -60.0f }, { 20, -30.0f }, { 30, -10.0f }, { 40, -20.0f } })
+                dB[(size_t)peak.first] = peak.second;
+            expectEquals(finder.find(dB.data(), (int)dB.size()), 2);
+            expectEquals(finder.getPeak(0).bin, 30.0f);
+            expectEquals(finder.getPeak(1).bin, 40.0f);
+
+            finder.setThreshold(0.0f);
+            expectEquals(finder.find(dB.data(), (int)dB.size()), 0);
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int NUMSAMPLES = 16384;
+
+    AnalyzerTestUtil::CollectedFrame lastLeftFrame(const std::vector<float>& left)
+    {
+        const auto frames = AnalyzerTestUtil::collect(left, std::vector<float>(left.size(), 0.0f), 512);
+        for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+            if (frame->channel == 0)
+                return *frame;
+        return {};
+    }
+};
+
+static PeakFinderTests peakFinderTests;
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    PercentileSpectrumTests.cpp
+    Created: 28 Oct 2026 2:16:50pm
+    Author:  Louis Deng
+
+    the percentile sketch gives the known percentiles of constant and stepped
+    levels, and forgets frames as they roll out of its window
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PercentileSpectrum.h"
+
+class PercentileSpectrumTests : public juce::UnitTest
+{
+public:
+    PercentileSpectrumTests(): juce::UnitTest("Percentile spectrum", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("no percentiles before the first frame");
+        {
+            PercentileSketch sketch;
+            sketch.configure(2, WINDOW_S);
+            std::vector<float> out[1];
+            expect(!sketch.getPercentiles(FRACTIONS, 1, out));
+        }
+
+        beginTest("constant and stepped levels");
+        {
+            // band 0 sits at LOW for a quarter of the frames and at HIGH for the rest, band 1 stays at HIGH
+            PercentileSketch sketch;
+            sketch.configure(2, WINDOW_S);
+            for (int frame = 0; frame < 100; frame++)
+            {
+                const float levels[2] = { frame % 4 == 0 ? LOW : HIGH, HIGH };
+                sketch.addFrame(levels, frame*INTERVAL_MS);
+            }
+            std::vector<float> out[NUMFRACTIONS];
+            expect(sketch.getPercentiles(FRACTIONS, NUMFRACTIONS, out));
+
+            // levels spread evenly over their 1 dB bucket, so each fraction lands at a known place inside it
+            const float lowBucket = std::floor(LOW), highBucket = std::floor(HIGH);
+            expectWithinAbsoluteError(out[0][0], lowBucket+0.4f, 0.01f, "10th percentile in the low quarter");
+            expectWithinAbsoluteError(out[1][0], highBucket+1.0f/3.0f, 0.01f, "median in the high three quarters");
+            expectWithinAbsoluteError(out[2][0], highBucket+13.0f/15.0f, 0.01f, "90th percentile");
+            for (int p = 0; p < NUMFRACTIONS; p++)
+                expectWithinAbsoluteError(out[p][1], highBucket+FRACTIONS[p], 0.01f, "constant band, fraction " + juce::String(FRACTIONS[p]));
+        }
+
+        beginTest("levels beyond the buckets are clamped");
+        {
+            PercentileSketch sketch;
+            sketch.configure(1, WINDOW_S);
+            const float loud = 300.0f;
+            sketch.addFrame(&loud, 0.0);
+            std::vector<float> out[NUMFRACTIONS];
+            expect(sketch.getPercentiles(FRACTIONS, NUMFRACTIONS, out));
+            expectLessOrEqual(out[2][0], PercentileSketch::TOPDB);
+            expectGreaterThan(out[0][0], PercentileSketch::TOPDB-1.0f);
+        }
+
+        beginTest("the window rolls over");
+        {
+            // LOW for one window, then HIGH: half way through the next window both are in, after it only HIGH
+            PercentileSketch sketch;
+            sketch.configure(1, WINDOW_S);
+            std::vector<float> out[NUMFRACTIONS];
+            const int framesPerWindow = (int)(WINDOW_S*1000.0/INTERVAL_MS);
+            int frame = 0;
+            for (; frame < framesPerWindow; frame++)
+                sketch.addFrame(&LOW, frame*INTERVAL_MS);
+            for (; frame < framesPerWindow*3/2; frame++)
+                sketch.addFrame(&HIGH, frame*INTERVAL_MS);
+            expect(sketch.getPercentiles(FRACTIONS, NUMFRACTIONS, out));
+            expectWithinAbsoluteError(out[0][0], LOW, 0.5f, "old frames still in the window");
+            expectWithinAbsoluteError(out[2][0], HIGH, 0.5f, "new frames in the window");
+
+            for (; frame < framesPerWindow*5/2; frame++)
+                sketch.addFrame(&HIGH, frame*INTERVAL_MS);
+            expect(sketch.getPercentiles(FRACTIONS, NUMFRACTIONS, out));
+            for (int p = 0; p < NUMFRACTIONS; p++)
+                expectWithinAbsoluteError(out[p][0], HIGH, 0.5f, "old frames gone, fraction " + juce::String(FRACTIONS[p]));
+
+            // after a pause longer than the window only the frame after it counts
+            const float quiet = -80.5f;
+            sketch.addFrame(&quiet, frame*INTERVAL_MS+100.0*WINDOW_S*1000.0);
+            expect(sketch.getPercentiles(FRACTIONS, NUMFRACTIONS, out));
+            for (int p = 0; p < NUMFRACTIONS; p++)
+                expectWithinAbsoluteError(out[p][0], quiet, 0.5f, "after a pause, fraction " + juce::String(FRACTIONS[p]));
+        }
+    }
+
+private:
+    static constexpr double WINDOW_S = 8.0;
+    static constexpr double INTERVAL_MS = 50.0;
+    static constexpr int NUMFRACTIONS = 3;
+    static constexpr float FRACTIONS[NUMFRACTIONS] = { 0.1f, 0.5f, 0.9f };
+    static constexpr float LOW = -60.5f;
+    static constexpr float HIGH = -20.5f;
+};
+
+static PercentileSpectrumTests percentileSpectrumTests;
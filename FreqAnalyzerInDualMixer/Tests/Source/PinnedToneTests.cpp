@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    PinnedToneTests.cpp
+    Created: 26 Oct 2026 4:12:08pm
+    Author:  Louis Deng
+
+    the sliding DFT bank reads pinned sines at their peak amplitude, also
+    after the engine is moved to another sample rate
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PinnedTones.h"
+#include "AnalyzerTestUtil.h"
+
+class PinnedToneTests : public juce::UnitTest
+{
+public:
+    PinnedToneTests(): juce::UnitTest("Pinned tone levels", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("known tones at their amplitude");
+        {
+            // the analyzer's 50 ms window, both tones in one signal
+            PinnedToneBank bank;
+            bank.configure({ 1000.0f, 50.0f }, SAMPLERATE, 0.05);
+            expectEquals(bank.getNumPinned(), 2);
+
+            const auto signal = AnalyzerTestUtil::makeTones(NUMSAMPLES, SAMPLERATE, { { 1000.0, 0.5 }, { 50.0, 0.1 } });
+            for (int start = 0; start < NUMSAMPLES; start += BLOCKSIZE)
+                bank.processBlock(signal.data()+start, juce::jmin(BLOCKSIZE, NUMSAMPLES-start));
+
+            expectWithinAbsoluteError(bank.getAmplitude(0), 0.5f, 0.005f);
+            expectWithinAbsoluteError(bank.getAmplitude(1), 0.1f, 0.001f);
+        }
+
+        beginTest("the engine's banks follow a new sample rate");
+        {
+            SpectrumFramePool pool;
+            AnalysisEngine engine { pool };
+            engine.setPinned({ 1000.0f, 30000.0f }, SAMPLERATE);
+            expectEquals((int)engine.getPinnedFrequencies().size(), 1);
+            
+            // prepared at twice the rate: the tone is tracked at its frequency, and the one out of reach before is back
+            engine.setSampleRate(2.0*SAMPLERATE);
+            expectEquals(engine.getPinnedSampleRate(), 2.0*SAMPLERATE);
+            expectEquals((int)engine.getPinnedFrequencies().size(), 2);
+            const auto signal = AnalyzerTestUtil::makeTones(2*NUMSAMPLES, 2.0*SAMPLERATE, { { 1000.0, 0.5 } });
+            for (int start = 0; start < 2*NUMSAMPLES; start += BLOCKSIZE)
+                engine.injectBlockToTo(signal.data()+start, juce::jmin(BLOCKSIZE, 2*NUMSAMPLES-start), 0, 0);
+            expectWithinAbsoluteError(engine.getPinnedAmplitude(0, 0, 0), 0.5f, 0.005f);
+        }
+
+        beginTest("frequencies out of range are ignored");
+        {
+            PinnedToneBank bank;
+            bank.configure({ -10.0f, 0.0f, 1000.0f, 24000.0f }, SAMPLERATE, 0.05);
+            expectEquals(bank.getNumPinned(), 1);
+            expectEquals(bank.getFrequency(0), 1000.0f);
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int NUMSAMPLES = 48000;
+    static constexpr int BLOCKSIZE = 512;
+};
+
+static PinnedToneTests pinnedToneTests;
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    SpectrumFramesTests.cpp
+    Created: 28 Oct 2026 4:05:12pm
+    Author:  Louis Deng
+
+    frame pool and queue under load: a producer thread acquires, fills and
+    queues frames while this thread takes them off the queue and holds on to
+    some for a while, releases happen on both threads. no frame is handed out
+    twice, none is lost, and a retired set lives exactly as long as its frames
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <thread>
+#include "SpectrumFrames.h"
+
+class SpectrumFramesTests : public juce::UnitTest
+{
+public:
+    SpectrumFramesTests(): juce::UnitTest("Spectrum frame pool and queue", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("frames through the queue across threads");
+        SpectrumFramePool pool(NUMFRAMES, NUMBINS);
+        SpectrumFrameQueue queue(QUEUESIZE);
+        uint32_t nextIndex = 1;
+
+        for (int round = 0; round < NUMROUNDS; round++)
+        {
+            std::atomic<bool> done { false };
+            std::thread producer([&pool, &queue, &done, first = nextIndex]
+            {
+                // the producer holds the last frame it queued, as the history does
+                SpectrumFrameRef last;
+                // waits for a free frame and for room in the queue, so every frame goes through
+                for (uint32_t index = first; index < first+FRAMESPERROUND;)
+                {
+                    SpectrumFrameRef frame = pool.acquire();
+                    if (!frame)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    fill(*frame.getForWriting(), index++);
+                    while (!queue.push(frame))
+                        std::this_thread::yield();
+                    last = frame;
+                }
+                last.reset();
+                done.store(true, std::memory_order_release);
+            });
+
+            // the consumer keeps the KEPT frames it took last, each is checked again when it lets go
+            SpectrumFrameRef kept[KEPT];
+            int numPopped = 0, numCorrupt = 0;
+            uint32_t lastIndex = 0;
+            bool ordered = true;
+            for (;;)
+            {
+                const bool finished = done.load(std::memory_order_acquire);
+                SpectrumFrameRef frame;
+                if (!queue.pop(frame))
+                {
+                    if (finished)
+                        break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (!isIntact(*frame))
+                    numCorrupt++;
+                ordered = ordered && frame->frameIndex > lastIndex;
+                lastIndex = frame->frameIndex;
+                auto& slot = kept[numPopped++ % KEPT];
+                if (slot && !isIntact(*slot))
+                    numCorrupt++;
+                slot = std::move(frame);
+            }
+            producer.join();
+            nextIndex += FRAMESPERROUND;
+
+            expectEquals(numPopped, (int)FRAMESPERROUND);
+            expectEquals(numCorrupt, 0, "a frame was refilled while it was still referenced");
+            expect(ordered, "frames came off the queue out of order");
+
+            // a new set while the consumer still holds frames of the old one: it stays until they are back
+            const size_t setBytes = SpectrumFrameSet(NUMFRAMES, NUMBINS).getMemoryBytes();
+            pool.setFrames(std::make_unique<SpectrumFrameSet>(NUMFRAMES, NUMBINS));
+            pool.releaseRetired();
+            expectEquals((int)pool.getMemoryBytes(), (int)(2*setBytes), "a retired set was freed under its frames");
+            for (auto& frame : kept)
+            {
+                if (frame && !isIntact(*frame))
+                    numCorrupt++;
+                frame.reset();
+            }
+            expectEquals(numCorrupt, 0);
+            pool.releaseRetired();
+            expectEquals((int)pool.getMemoryBytes(), (int)setBytes, "a retired set outlived its frames");
+        }
+
+        beginTest("every frame is back at the end");
+        {
+            std::vector<SpectrumFrameRef> all;
+            for (uint32_t i = 0; i < NUMFRAMES; i++)
+                all.push_back(pool.acquire());
+            for (const auto& frame : all)
+                expect((bool)frame, "a frame was never returned");
+            const auto exhausted = pool.getExhaustedCount();
+            expect(!pool.acquire(), "more frames than the set holds");
+            expectEquals((int)pool.getExhaustedCount(), (int)exhausted+1);
+        }
+    }
+
+private:
+    static constexpr uint32_t NUMFRAMES = 16;
+    static constexpr uint32_t NUMBINS = 64;
+    static constexpr uint32_t QUEUESIZE = 8;
+    static constexpr uint32_t FRAMESPERROUND = 20000;
+    static constexpr int NUMROUNDS = 4;
+    static constexpr int KEPT = 4;
+
+    /// stamp a frame with its index throughout, so a frame refilled under a reader shows
+    static void fill(SpectrumFrame& frame, uint32_t index)
+    {
+        frame.frameIndex = index;
+        frame.numBins = NUMBINS;
+        for (uint32_t drywet = 0; drywet < 2; drywet++)
+            std::fill(frame.getWritePointer(drywet), frame.getWritePointer(drywet)+NUMBINS, (float)index);
+    }
+
+    static bool isIntact(const SpectrumFrame& frame)
+    {
+        for (uint32_t drywet = 0; drywet < 2; drywet++)
+            for (uint32_t bin = 0; bin < NUMBINS; bin++)
+                if (frame.getMagnitudes(drywet)[bin] != (float)frame.frameIndex)
+                    return false;
+        return true;
+    }
+};
+
+static SpectrumFramesTests spectrumFramesTests;
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SweepMeasurementTests.cpp
+    Created: 26 Oct 2026 5:20:37pm
+    Author:  Louis Deng
+
+    a sweep through a delayed polynomial nonlinearity: the latency is the
+    delay, and the linear, 2nd and 3rd harmonic levels are the ones the
+    polynomial makes of a sine at the sweep level
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SweepMeasurement.h"
+
+class SweepMeasurementTests : public juce::UnitTest
+{
+public:
+    SweepMeasurementTests(): juce::UnitTest("Sweep measurement", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("latency and harmonics of a delayed polynomial");
+        SweepMeasurement sweep;
+        sweep.start(SAMPLERATE, DURATION_S, SweepMeasurement::DEFAULTLEVEL_DB);
+        expect(sweep.getState() == SweepMeasurement::running);
+
+        // the processor's order per block: the sweep replaces the input, the wet path runs, both are recorded
+        std::vector<float> dry((size_t)BLOCKSIZE), wet((size_t)BLOCKSIZE);
+        std::vector<float> delayLine((size_t)DELAY, 0.0f);
+        size_t delayPos = 0;
+        while (sweep.getState() == SweepMeasurement::running)
+        {
+            float* channels[] = { dry.data() };
+            sweep.generate(channels, 1, BLOCKSIZE);
+            for (int i = 0; i < BLOCKSIZE; i++)
+            {
+                const float x = delayLine[delayPos];
+                delayLine[delayPos] = dry[(size_t)i];
+                delayPos = (delayPos+1) % delayLine.size();
+                wet[(size_t)i] = x + A2*x*x + A3*x*x*x;
+            }
+            sweep.record(dry.data(), wet.data(), BLOCKSIZE);
+        }
+
+        // the analysis thread deconvolves both recordings
+        for (int waited = 0; sweep.getState() == SweepMeasurement::analysing && waited < 120000; waited += 10)
+            juce::Thread::sleep(10);
+        expect(sweep.getState() == SweepMeasurement::done);
+
+        uint32_t version = 0;
+        SweepMeasurement::Results results;
+        expect(sweep.getResultsIfNew(version, results));
+        expectEquals(results.latency, DELAY);
+
+        // a sine of amplitude a through x + a2 x^2 + a3 x^3: fundamental a (1 + 3/4 a3 a^2),
+        // 2nd harmonic a2 a^2/2 and 3rd a3 a^3/4, levels against a
+        const double a = juce::Decibels::decibelsToGain((double)SweepMeasurement::DEFAULTLEVEL_DB);
+        const double expected[] = { 20.0*std::log10(1.0 + 0.75*A3*a*a), 20.0*std::log10(0.5*A2*a), 20.0*std::log10(0.25*A3*a*a) };
+        int checked = 0;
+        for (size_t i = 0; i < results.frequencies.size(); i++)
+        {
+            // lower down the harmonic windows are too short for the band-edge ringing to die out
+            const float f = results.frequencies[i];
+            if (f < 300.0f || f > 5000.0f)
+                continue;
+            for (int order = 1; order <= 3; order++)
+                expectWithinAbsoluteError(results.responseDB[order-1][i], (float)expected[order-1], 0.1f,
+                                          "order " + juce::String(order) + " at " + juce::String(f) + " Hz");
+            checked++;
+        }
+        expectGreaterThan(checked, 50);
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr double DURATION_S = 5.0;     // the editor's default
+    static constexpr int BLOCKSIZE = 512;
+    static constexpr int DELAY = 37;
+    static constexpr float A2 = 0.1f;
+    static constexpr float A3 = 0.05f;
+};
+
+static SweepMeasurementTests sweepMeasurementTests;
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    ZoomTests.cpp
+    Created: 28 Oct 2026 2:17:53pm
+    Author:  Louis Deng
+
+    a 40-80 Hz zoom reads a 60 Hz tone at its level, less the interpolation
+    between fft bins, and resolves a weaker tone 0.7 Hz away. a view opening
+    on a zoomed engine starts from its history and the zoom runs on
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <thread>
+#include "AnalyzerTestUtil.h"
+
+class ZoomTests : public juce::UnitTest
+{
+public:
+    ZoomTests(): juce::UnitTest("Zoom analysis", "FreqAnalyzer")
+    {
+    }
+
+    void runTest() override
+    {
+        using namespace AnalyzerTestUtil;
+
+        beginTest("60 Hz in a 40-80 Hz zoom, and 60.7 Hz next to it");
+        {
+            // the default resolution's bins, 6.4 s per 512 point frame at the 80 Hz decimated rate
+            const int numBins = 1 << (FFTORDER_T-1);
+            ZoomStream zoom;
+            zoom.configure(SAMPLERATE, 40.0f, 80.0f, numBins, 2*numBins);
+            const auto tones = makeTones(NUMSAMPLES, SAMPLERATE, { { 60.0, 0.5 }, { 60.7, 0.05 } });
+            for (int start = 0; start < NUMSAMPLES; start += BLOCKSIZE)
+                zoom.process(tones.data()+start, juce::jmin(BLOCKSIZE, NUMSAMPLES-start));
+            expectGreaterThan((int)zoom.getNumFrames(), 1);
+
+            const auto& levels = zoom.getLevels();
+            auto binOf = [&] (double f) { return juce::jlimit(0, numBins-1, (int)((f-40.0)/40.0*numBins)); };
+            auto levelOf = [&] (int bin) { return magnitudeToDBFS(levels[(size_t)bin], 2u*numBins); };
+            auto peakNear = [&] (double f)
+            {
+                double peak = -200.0;
+                for (int bin = binOf(f)-2; bin <= binOf(f)+2; bin++)
+                    peak = juce::jmax(peak, levelOf(bin));
+                return peak;
+            };
+            // 60 Hz falls between two fft bins of the zoom, their linear interpolation loses 0.56 dB
+            expectWithinAbsoluteError(peakNear(60.0), 20.0*std::log10(0.5)-0.56, 0.1);
+            // the weaker tone stands on its own, with a deep gap between the two
+            expectWithinAbsoluteError(peakNear(60.7), 20.0*std::log10(0.05), 2.0);
+            expectLessThan(levelOf(binOf(60.35)), peakNear(60.7)-15.0);
+        }
+
+        beginTest("a view opens on the zoom's recent frames, the zoom runs on");
+        {
+            SpectrumFramePool pool;
+            AnalysisEngine engine { pool };
+            engine.setZoom(40.0f, 80.0f, SAMPLERATE);
+            const auto tone = makeTones(NUMSAMPLES, SAMPLERATE, { { 60.0, 0.5 } });
+            engine.alignTo(0);
+            feed(engine, tone);
+
+            // the history of a previous session, replayed as the editor does, the zoom paused meanwhile
+            FrameCollector replayed;
+            engine.replayHistory(replayed);
+            expect(!replayed.frames.empty(), "no zoom frames kept");
+
+            // a view joining does not restart the zoom, its frames carry on from the history
+            FrameCollector view;
+            engine.addConsumer(&view);
+            feed(engine, tone);
+            engine.removeConsumer(&view);
+            expect(!view.frames.empty(), "the zoom stopped when the view joined");
+            if (!replayed.frames.empty() && !view.frames.empty())
+                expectEquals(view.frames.front().frameIndex, replayed.frames.back().frameIndex+1);
+        }
+    }
+
+private:
+    static constexpr double SAMPLERATE = 48000.0;
+    static constexpr int NUMSAMPLES = 480000;
+    static constexpr int BLOCKSIZE = 512;
+
+    /// both channels' dry and wet, paced so the zoom thread keeps up with its fifos, then time for its last drain
+    static void feed(AnalysisEngine& engine, const std::vector<float>& signal)
+    {
+        for (int start = 0; start < (int)signal.size(); start += BLOCKSIZE)
+        {
+            const int numSamples = juce::jmin(BLOCKSIZE, (int)signal.size()-start);
+            for (uint32_t leftright = 0; leftright < 2; leftright++)
+                for (uint32_t drywet = 0; drywet < 2; drywet++)
+                    engine.injectBlockToTo(signal.data()+start, numSamples, leftright, drywet);
+            if ((start/BLOCKSIZE) % 32 == 31)
+                std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+};
+
+static ZoomTests zoomTests;